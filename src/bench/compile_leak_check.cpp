@@ -0,0 +1,112 @@
+// compiles the given programs over and over in one process and checks the resident set size stays flat, so nothing
+// one compilation allocates outlives it (batch workers and the compile server run thousands of them)
+//
+//   ./build/compile_leak_check [--rounds N] [--tolerance KiB] [--out-dir DIR] ../examples/*.cgl
+//
+// every round compiles each program once, all the way to class files (1000 rounds by default). the first tenth of
+// the rounds warms up the allocator and antlr's DFA cache, after that the RSS may grow by at most the tolerance
+#include "compiler/compile_driver.h"
+#include "compiler/input/mapped_file.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// the current RSS where /proc has it, the peak RSS otherwise, which a leak makes grow just the same
+long residentKiB() {
+#ifdef _WIN32
+  return 0;
+#else
+  std::ifstream statm("/proc/self/statm");
+  long sizePages = 0;
+  long residentPages = 0;
+  if (statm >> sizePages >> residentPages) {
+    return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+  }
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  int rounds = 1000;
+  long toleranceKiB = 2048;
+  CompileOptions options;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--rounds" && i + 1 < argc) {
+      rounds = std::stoi(argv[++i]);
+    } else if (arg == "--tolerance" && i + 1 < argc) {
+      toleranceKiB = std::stol(argv[++i]);
+    } else if (arg == "--out-dir" && i + 1 < argc) {
+      options.outputDir = argv[++i];
+    } else {
+      paths.push_back(arg);
+    }
+  }
+  if (paths.empty() || rounds < 1) {
+    std::cerr << "Usage: " << argv[0] << " [--rounds N] [--tolerance KiB] [--out-dir DIR] <input-file>..."
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<MappedFile>> files;
+  for (const auto& path : paths) {
+    files.push_back(std::make_unique<MappedFile>());
+    if (!files.back()->open(path)) {
+      std::cerr << "Failed to open input file: " << path << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << "Compiling " << files.size() << " programs " << rounds << " times" << std::endl;
+  int warmupRounds = std::max(1, rounds / 10);
+  long baselineKiB = 0;
+  long largestKiB = 0;
+  for (int round = 1; round <= rounds; round++) {
+    for (size_t i = 0; i < files.size(); i++) {
+      std::ostringstream out;
+      std::ostringstream err;
+      if (compileSource(files[i]->contents(), options, out, err).exitCode != 0) {
+        std::cerr << "Failed to compile " << paths[i] << "\n" << err.str();
+        return 1;
+      }
+    }
+    long rss = residentKiB();
+    if (round == warmupRounds) {
+      baselineKiB = rss;
+    }
+    if (round >= warmupRounds) {
+      largestKiB = std::max(largestKiB, rss);
+    }
+    if (round % warmupRounds == 0 || round == rounds) {
+      std::cout << "round " << round << ": " << rss << " KiB resident" << std::endl;
+    }
+  }
+
+  long growthKiB = largestKiB - baselineKiB;
+  std::cout << "Growth after warm up: " << growthKiB << " KiB (tolerance " << toleranceKiB << " KiB)" << std::endl;
+  if (growthKiB > toleranceKiB) {
+    std::cerr << "Resident memory keeps growing, something outlives its compilation" << std::endl;
+    return 1;
+  }
+  return 0;
+}
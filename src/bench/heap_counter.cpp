@@ -0,0 +1,68 @@
+#include "heap_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// every block starts with its size so delete knows how much went away
+constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+std::atomic<size_t> allocations{0};
+std::atomic<size_t> liveBytes{0};
+std::atomic<size_t> peakBytes{0};
+
+void* countedAllocate(size_t size) {
+  void* block = std::malloc(size + HEADER_SIZE);
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  *static_cast<size_t*>(block) = size;
+  allocations++;
+  size_t live = liveBytes += size;
+  size_t peak = peakBytes.load();
+  while (live > peak && !peakBytes.compare_exchange_weak(peak, live)) {
+  }
+  return static_cast<char*>(block) + HEADER_SIZE;
+}
+
+void countedFree(void* pointer) {
+  if (pointer == nullptr) {
+    return;
+  }
+  void* block = static_cast<char*>(pointer) - HEADER_SIZE;
+  liveBytes -= *static_cast<size_t*>(block);
+  std::free(block);
+}
+
+} // namespace
+
+void HeapCounter::reset() {
+  allocations = 0;
+  peakBytes = liveBytes.load();
+}
+
+HeapCounter::Snapshot HeapCounter::snapshot() {
+  Snapshot result;
+  result.allocations = allocations;
+  result.liveBytes = liveBytes;
+  result.peakBytes = peakBytes;
+  return result;
+}
+
+void* operator new(size_t size) { return countedAllocate(size); }
+void* operator new[](size_t size) { return countedAllocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return countedAllocate(size);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return operator new(size, std::nothrow); }
+void operator delete(void* pointer) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
@@ -0,0 +1,21 @@
+#ifndef HEAP_COUNTER_H
+#define HEAP_COUNTER_H
+
+#include <cstddef>
+
+// counts allocations made through global operator new in a benchmark binary
+// heap_counter.cpp replaces the global operator new/delete, so only link it into benchmarks
+namespace HeapCounter {
+
+struct Snapshot {
+  size_t allocations = 0;
+  size_t liveBytes = 0;
+  size_t peakBytes = 0;
+};
+
+void reset();
+Snapshot snapshot();
+
+} // namespace HeapCounter
+
+#endif // HEAP_COUNTER_H
@@ -0,0 +1,119 @@
+// runs semantic analysis on a large generated program and reports time, heap allocations and how many scopes,
+// symbols and types went into the analyzer's arena
+//
+//   ./build/semantic_bench [--functions N] [--rounds N]
+//
+// the program has N structs and N functions with nested loops and branches (2000 by default). every arena object
+// used to be a separate make_shared allocation with an atomic reference count, so the arena column is the number
+// of allocations that went away
+#include "compiler/input/arena_token_factory.h"
+#include "compiler/input/utf8_char_stream.h"
+#include "compiler/semantic_analyzer.h"
+#include "heap_counter.h"
+#include <antlr4-runtime.h>
+#include <cgullLexer.h>
+#include <cgullParser.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+std::string generateProgram(size_t functions) {
+  std::ostringstream program;
+  for (size_t i = 0; i < functions; i++) {
+    program << "struct S" << i << " {\n  int a;\n  float b;\n}\n\n";
+    program << "fn f" << i << "(int x, S" << i << " s) -> int {\n"
+            << "  int total = x;\n"
+            << "  for (int k = 0; k < 10; k++) {\n"
+            << "    if (k % 2 == 0) {\n"
+            << "      for (int m = 0; m < k; m++) {\n"
+            << "        total = total + s.a * m;\n"
+            << "      }\n"
+            << "    } else {\n"
+            << "      total = total - k;\n"
+            << "    }\n"
+            << "  }\n"
+            << "  return total;\n"
+            << "}\n\n";
+  }
+  program << "fn main() {\n  S0 s = S0(1, 2.0);\n  println(\"\" + f0(1, s));\n}\n";
+  return program.str();
+}
+
+struct Measurement {
+  double milliseconds = 0;
+  bool failed = false;
+  size_t arenaObjects = 0;
+  size_t arenaBytes = 0;
+  HeapCounter::Snapshot heap;
+};
+
+Measurement analyze(cgullParser::ProgramContext* tree, const std::shared_ptr<AtomTable>& atoms) {
+  Measurement measurement;
+  HeapCounter::reset();
+  auto start = std::chrono::steady_clock::now();
+  {
+    SemanticAnalyzer analyzer(atoms);
+    analyzer.analyze(tree);
+    measurement.heap = HeapCounter::snapshot();
+    measurement.failed = analyzer.getErrorReporter().hasErrors();
+    measurement.arenaObjects = analyzer.getObjects().getObjectCount();
+    measurement.arenaBytes = analyzer.getObjects().getBytesAllocated();
+  }
+  measurement.milliseconds =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  return measurement;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  size_t functions = 2000;
+  int rounds = 5;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--functions" && i + 1 < argc) {
+      functions = std::stoul(argv[++i]);
+    } else if (arg == "--rounds" && i + 1 < argc) {
+      rounds = std::stoi(argv[++i]);
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--functions N] [--rounds N]" << std::endl;
+      return 1;
+    }
+  }
+
+  std::string source = generateProgram(functions);
+  Arena tokenArena;
+  auto atoms = std::make_shared<AtomTable>();
+  ArenaTokenFactory tokenFactory(tokenArena, atoms.get());
+  Utf8CharStream input(source);
+  cgullLexer lexer(&input);
+  lexer.setTokenFactory(&tokenFactory);
+  antlr4::CommonTokenStream tokens(&lexer);
+  cgullParser parser(&tokens);
+  cgullParser::ProgramContext* tree = parser.program();
+  if (parser.getNumberOfSyntaxErrors() > 0) {
+    std::cerr << "The generated program has syntax errors" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Analyzing " << functions << " structs and functions (" << source.size() / 1024 << " KiB), best of "
+            << rounds << " rounds\n\n";
+  Measurement best;
+  for (int round = 0; round < rounds; round++) {
+    Measurement m = analyze(tree, atoms);
+    if (round == 0 || m.milliseconds < best.milliseconds) {
+      best = m;
+    }
+  }
+  std::cout << std::left << std::setw(28) << "time (ms)" << std::fixed << std::setprecision(2) << best.milliseconds
+            << "\n"
+            << std::setw(28) << "heap allocations" << best.heap.allocations << "\n"
+            << std::setw(28) << "peak heap (KiB)" << best.heap.peakBytes / 1024 << "\n"
+            << std::setw(28) << "arena objects" << best.arenaObjects << "\n"
+            << std::setw(28) << "arena size (KiB)" << best.arenaBytes / 1024 << "\n"
+            << std::setw(28) << "semantic errors" << (best.failed ? "yes" : "no") << std::endl;
+  return 0;
+}
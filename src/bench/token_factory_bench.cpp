@@ -0,0 +1,108 @@
+// lexes the same input with antlr's CommonTokenFactory and with ArenaTokenFactory and compares
+// time, heap allocations and peak heap usage
+//
+//   ./build/token_factory_bench [--repeat N] [--rounds N] ../examples/*.cgl
+//
+// the input files are concatenated and repeated N times (200 by default) to get a token heavy source,
+// it only has to lex, not parse
+#include "compiler/input/arena_token_factory.h"
+#include "compiler/input/utf8_char_stream.h"
+#include "heap_counter.h"
+#include <antlr4-runtime.h>
+#include <cgullLexer.h>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+struct Measurement {
+  double milliseconds = 0;
+  size_t tokens = 0;
+  HeapCounter::Snapshot heap;
+};
+
+Measurement lex(const std::string& source, bool useArena) {
+  Measurement measurement;
+  HeapCounter::reset();
+  auto start = std::chrono::steady_clock::now();
+  {
+    Arena arena;
+    ArenaTokenFactory factory(arena);
+    Utf8CharStream input(source);
+    cgullLexer lexer(&input);
+    lexer.removeErrorListeners();
+    if (useArena) {
+      lexer.setTokenFactory(&factory);
+    }
+    antlr4::CommonTokenStream tokens(&lexer);
+    tokens.fill();
+    measurement.tokens = tokens.size();
+    measurement.heap = HeapCounter::snapshot();
+  }
+  measurement.milliseconds =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  return measurement;
+}
+
+void printRow(const std::string& name, const Measurement& m) {
+  std::cout << std::left << std::setw(20) << name << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+            << m.milliseconds << std::setw(12) << m.tokens << std::setw(14) << m.heap.allocations << std::setw(16)
+            << m.heap.peakBytes / 1024 << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  size_t repeat = 200;
+  int rounds = 5;
+  std::string input;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--repeat" && i + 1 < argc) {
+      repeat = std::stoul(argv[++i]);
+    } else if (arg == "--rounds" && i + 1 < argc) {
+      rounds = std::stoi(argv[++i]);
+    } else {
+      std::ifstream file(arg, std::ios::binary);
+      if (!file.is_open()) {
+        std::cerr << "Failed to open input file: " << arg << std::endl;
+        return 1;
+      }
+      std::stringstream buffer;
+      buffer << file.rdbuf();
+      input += buffer.str() + "\n";
+    }
+  }
+  if (input.empty()) {
+    std::cerr << "Usage: " << argv[0] << " [--repeat N] [--rounds N] <input-file>..." << std::endl;
+    return 1;
+  }
+
+  std::string source;
+  source.reserve(input.size() * repeat);
+  for (size_t i = 0; i < repeat; i++) {
+    source += input;
+  }
+  std::cout << "Lexing " << source.size() / 1024 << " KiB, best of " << rounds << " rounds\n\n";
+  std::cout << std::left << std::setw(20) << "factory" << std::right << std::setw(12) << "time (ms)" << std::setw(12)
+            << "tokens" << std::setw(14) << "allocations" << std::setw(16) << "peak heap (KiB)" << std::endl;
+
+  // warm the lexer DFA so neither side pays for it
+  lex(source, false);
+
+  Measurement best[2];
+  for (int round = 0; round < rounds; round++) {
+    for (int useArena = 0; useArena < 2; useArena++) {
+      Measurement m = lex(source, useArena);
+      if (round == 0 || m.milliseconds < best[useArena].milliseconds) {
+        best[useArena] = m;
+      }
+    }
+  }
+  printRow("CommonTokenFactory", best[0]);
+  printRow("ArenaTokenFactory", best[1]);
+  return 0;
+}
@@ -0,0 +1,146 @@
+// classifies a mix of types and IR instructions the way the compiler used to (a chain of dynamic casts, and
+// dynamic_pointer_cast for instructions) and the way it does now (a switch on the kind tag and static downcasts)
+//
+//   ./build/type_dispatch_bench [--count N] [--rounds N]
+//
+// both sides compute the same thing, roughly what array instruction selection does with a type: N values each
+// (1000000 by default), best of the rounds
+#include "compiler/arena.h"
+#include "compiler/instructions/ir_instruction.h"
+#include "compiler/symbols/symbol.h"
+#include "compiler/symbols/type_table.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+int classifyWithDynamicCast(Type* type) {
+  auto arrayType = dynamic_cast<ArrayType*>(type);
+  auto pointerType = dynamic_cast<PointerType*>(type);
+  auto primitiveType = dynamic_cast<PrimitiveType*>(type);
+  auto userDefinedType = dynamic_cast<UserDefinedType*>(type);
+  if (arrayType || pointerType || userDefinedType) {
+    return 1;
+  } else if (primitiveType) {
+    return 2 + static_cast<int>(primitiveType->getPrimitiveKind());
+  }
+  return 0;
+}
+
+int classifyWithKind(Type* type) {
+  switch (type->getKind()) {
+  case Type::TypeKind::ARRAY:
+  case Type::TypeKind::POINTER:
+  case Type::TypeKind::USER_DEFINED:
+    return 1;
+  case Type::TypeKind::PRIMITIVE:
+    return 2 + static_cast<int>(static_cast<PrimitiveType*>(type)->getPrimitiveKind());
+  default:
+    return 0;
+  }
+}
+
+size_t instructionWithDynamicCast(const std::shared_ptr<IRInstruction>& instruction) {
+  if (auto callInstruction = std::dynamic_pointer_cast<IRCallInstruction>(instruction)) {
+    return callInstruction->function->name.size();
+  }
+  if (auto rawInstruction = std::dynamic_pointer_cast<IRRawInstruction>(instruction)) {
+    return rawInstruction->instruction.size();
+  }
+  return 0;
+}
+
+size_t instructionWithKind(const std::shared_ptr<IRInstruction>& instruction) {
+  switch (instruction->getKind()) {
+  case IRInstruction::InstructionKind::CALL:
+    return static_cast<IRCallInstruction*>(instruction.get())->function->name.size();
+  case IRInstruction::InstructionKind::RAW:
+    return static_cast<IRRawInstruction*>(instruction.get())->instruction.size();
+  }
+  return 0;
+}
+
+// best time of the rounds in nanoseconds per item, and a checksum so the work can't be optimized away
+template <typename Items, typename Classify>
+std::pair<double, size_t> measure(const Items& items, int rounds, Classify classify) {
+  double best = 0;
+  size_t checksum = 0;
+  for (int round = 0; round < rounds; round++) {
+    size_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& item : items) {
+      sum += classify(item);
+    }
+    double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (round == 0 || nanoseconds < best) {
+      best = nanoseconds;
+    }
+    checksum = sum;
+  }
+  return {best / static_cast<double>(items.size()), checksum};
+}
+
+void printRow(const std::string& name, const std::pair<double, size_t>& result) {
+  std::cout << std::left << std::setw(36) << name << std::right << std::setw(12) << std::fixed
+            << std::setprecision(2) << result.first << std::setw(20) << result.second << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  size_t count = 1000000;
+  int rounds = 5;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--count" && i + 1 < argc) {
+      count = std::stoul(argv[++i]);
+    } else if (arg == "--rounds" && i + 1 < argc) {
+      rounds = std::stoi(argv[++i]);
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--count N] [--rounds N]" << std::endl;
+      return 1;
+    }
+  }
+
+  ObjectArena objects;
+  TypeTable typeTable(objects);
+  auto scope = objects.create<Scope>(nullptr);
+  auto structSymbol = objects.create<TypeSymbol>("S", 0, 0, scope);
+  std::vector<Type*> pool;
+  for (auto kind : {PrimitiveType::PrimitiveKind::INT, PrimitiveType::PrimitiveKind::FLOAT,
+                    PrimitiveType::PrimitiveKind::BOOLEAN, PrimitiveType::PrimitiveKind::STRING}) {
+    pool.push_back(TypeTable::primitive(kind));
+    pool.push_back(typeTable.arrayOf(TypeTable::primitive(kind)));
+    pool.push_back(typeTable.pointerTo(TypeTable::primitive(kind)));
+  }
+  pool.push_back(typeTable.userDefined(structSymbol));
+  pool.push_back(typeTable.arrayOf(typeTable.userDefined(structSymbol)));
+
+  auto function = objects.create<FunctionSymbol>("f", 0, 0, scope);
+  std::vector<std::shared_ptr<IRInstruction>> instructionPool = {
+      std::make_shared<IRCallInstruction>(function), std::make_shared<IRRawInstruction>("iload 0"),
+      std::make_shared<IRRawInstruction>("iadd"), std::make_shared<IRRawInstruction>("ireturn")};
+
+  // the same pseudo random order on both sides
+  std::mt19937 random(42);
+  std::vector<Type*> types(count);
+  std::vector<std::shared_ptr<IRInstruction>> instructions(count);
+  for (size_t i = 0; i < count; i++) {
+    types[i] = pool[random() % pool.size()];
+    instructions[i] = instructionPool[random() % instructionPool.size()];
+  }
+
+  std::cout << "Classifying " << count << " types and instructions, best of " << rounds << " rounds\n\n";
+  std::cout << std::left << std::setw(36) << "dispatch" << std::right << std::setw(12) << "ns / item" << std::setw(20)
+            << "checksum" << std::endl;
+  printRow("type, dynamic_cast chain", measure(types, rounds, classifyWithDynamicCast));
+  printRow("type, kind switch", measure(types, rounds, classifyWithKind));
+  printRow("instruction, dynamic_pointer_cast", measure(instructions, rounds, instructionWithDynamicCast));
+  printRow("instruction, kind switch", measure(instructions, rounds, instructionWithKind));
+  return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef ANALYSIS_RESULT_H
+#define ANALYSIS_RESULT_H
+
+#include "node_roles.h"
+#include "node_table.h"
+#include "symbols/symbol.h"
+#include <cgullParser.h>
+#include <string>
+#include <unordered_map>
+
+// everything code generation needs from semantic analysis, filled in once by SemanticAnalyzer::analyze and only read
+// after that. the tables are moved in from the passes that built them and code generation holds the result by
+// reference, so there is only ever one copy of each
+//
+// the tables are indexed by the node ids given to programCtx and point into the analyzer's arena, so a result is
+// valid as long as the analyzer that produced it
+struct AnalysisResult {
+  cgullParser::ProgramContext* programCtx = nullptr;
+  // what each node is to its parent (loop condition, array element, assignment target, ...)
+  NodeTable<NodeRole> nodeRoles;
+  // the innermost scope of every node
+  NodeTable<Scope*> nodeScopes;
+  NodeTable<Type*> expressionTypes;
+  NodeSet expectingStringConversion;
+  // struct name to its constructor
+  std::unordered_map<std::string, FunctionSymbol*> constructorMap;
+  NodeTable<FunctionSymbol*> resolvedMethodSymbols;
+};
+
+#endif // ANALYSIS_RESULT_H
@@ -0,0 +1,98 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// bump allocator owned by one compilation, everything in it is freed at once when it's destroyed
+// objects are never destroyed by the arena, so anything created here either has a trivial destructor
+// or is destroyed by its owner (see ArenaToken) before the arena goes away
+// not thread safe, each compilation has its own
+class Arena {
+public:
+  explicit Arena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    bytesAllocated += size;
+    if (size + alignment > blockSize) {
+      // oversized requests get a block of their own, the current block keeps filling up
+      blocks.emplace_back(new char[size + alignment]);
+      return align(blocks.back().get(), alignment);
+    }
+    char* result = align(cursor, alignment);
+    if (cursor == nullptr || result + size > end) {
+      blocks.emplace_back(new char[blockSize]);
+      cursor = blocks.back().get();
+      end = cursor + blockSize;
+      result = align(cursor, alignment);
+    }
+    cursor = result + size;
+    return result;
+  }
+
+  template <typename T, typename... Args> T* create(Args&&... args) {
+    return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  size_t getBytesAllocated() const { return bytesAllocated; }
+  size_t getBlockCount() const { return blocks.size(); }
+
+private:
+  size_t blockSize;
+  std::vector<std::unique_ptr<char[]>> blocks;
+  char* cursor = nullptr;
+  char* end = nullptr;
+  size_t bytesAllocated = 0;
+
+  static char* align(char* pointer, size_t alignment) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+    return pointer + (alignment - address % alignment) % alignment;
+  }
+};
+
+// arena for objects that do need their destructor: they're destroyed in reverse creation order when the arena goes
+// away, and their memory is freed with it. one compilation's scopes, symbols and types live in one of these and are
+// passed around as plain pointers, there's no per object allocation or reference count
+class ObjectArena {
+public:
+  explicit ObjectArena(size_t blockSize = 64 * 1024) : arena(blockSize) {}
+  ObjectArena(const ObjectArena&) = delete;
+  ObjectArena& operator=(const ObjectArena&) = delete;
+
+  ~ObjectArena() {
+    for (auto it = destructors.rbegin(); it != destructors.rend(); ++it) {
+      it->destroy(it->object);
+    }
+  }
+
+  template <typename T, typename... Args> T* create(Args&&... args) {
+    T* object = arena.create<T>(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      destructors.push_back({object, [](void* pointer) { static_cast<T*>(pointer)->~T(); }});
+    }
+    objectCount++;
+    return object;
+  }
+
+  size_t getObjectCount() const { return objectCount; }
+  size_t getBytesAllocated() const { return arena.getBytesAllocated(); }
+
+private:
+  struct Destructor {
+    void* object;
+    void (*destroy)(void*);
+  };
+
+  Arena arena;
+  std::vector<Destructor> destructors;
+  size_t objectCount = 0;
+};
+
+#endif // ARENA_H
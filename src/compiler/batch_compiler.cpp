@@ -0,0 +1,163 @@
+#include "batch_compiler.h"
+#include "input/mapped_file.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+BatchCompiler::BatchCompiler(const CompileOptions& options, unsigned jobs) : options(options), jobs(jobs) {
+  if (this->jobs == 0) {
+    this->jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
+  // the workers already keep every core busy, so programs are parsed and checked serially unless asked otherwise
+  if (this->options.parseJobs == 0) {
+    this->options.parseJobs = 1;
+  }
+  if (this->options.checkJobs == 0) {
+    this->options.checkJobs = 1;
+  }
+}
+
+int BatchCompiler::run(const std::vector<std::string>& inputs, std::ostream& out, std::ostream& err) {
+  std::vector<Job> batch;
+  if (!collectJobs(inputs, batch, err)) {
+    return 1;
+  }
+  if (batch.empty()) {
+    err << "No input files given for batch compilation" << std::endl;
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  // futures are taken up front, workers only ever touch their own promise
+  std::vector<std::promise<JobResult>> promises(batch.size());
+  std::vector<std::future<JobResult>> futures;
+  for (auto& promise : promises) {
+    futures.push_back(promise.get_future());
+  }
+
+  // every program gets a fresh lexer/parser/analyzer on whichever worker picks it up,
+  // the only shared state is the antlr ATN/DFA cache which the runtime synchronizes itself
+  std::atomic<size_t> nextJob{0};
+  unsigned workerCount = static_cast<unsigned>(std::min<size_t>(jobs, batch.size()));
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < workerCount; i++) {
+    workers.emplace_back([&]() {
+      for (size_t job = nextJob++; job < batch.size(); job = nextJob++) {
+        promises[job].set_value(runJob(batch[job], options));
+      }
+    });
+  }
+
+  // report in input order as results come in
+  size_t failed = 0;
+  size_t totalBytes = 0;
+  for (size_t i = 0; i < batch.size(); i++) {
+    JobResult result = futures[i].get();
+    if (result.exitCode != 0) {
+      failed++;
+    }
+    totalBytes += result.sourceBytes;
+    out << "== " << batch[i].sourcePath << " -> " << batch[i].outputDir << " ("
+        << (result.exitCode == 0 ? "ok" : "failed") << ", " << std::fixed << std::setprecision(1)
+        << result.milliseconds << " ms) ==" << std::endl;
+    out << result.out;
+    err << result.err;
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  out << "\nBatch compiled " << batch.size() << " programs (" << failed << " failed) on " << workerCount
+      << " workers in " << std::setprecision(3) << seconds << " s" << std::endl;
+  out << "Throughput: " << std::setprecision(1) << batch.size() / seconds << " programs/s, "
+      << totalBytes / 1024.0 / seconds << " KiB/s of source" << std::endl;
+  if (options.timePasses != TimePassesFormat::NONE) {
+    ParseStats parseStats = getParseStats();
+    out << "Parsing: " << parseStats.llFallbacks << " of " << parseStats.parses
+        << " parses fell back from SLL to full LL prediction" << std::endl;
+  }
+  if (options.cache != nullptr) {
+    CompileCache::Stats stats = options.cache->getStats();
+    out << "Compile cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions
+        << " evictions" << std::endl;
+  }
+
+  return failed == 0 ? 0 : 1;
+}
+
+bool BatchCompiler::collectJobs(const std::vector<std::string>& inputs, std::vector<Job>& collected,
+                                std::ostream& err) const {
+  std::vector<std::string> sources;
+  for (const auto& input : inputs) {
+    if (input.empty() || input[0] != '@') {
+      sources.push_back(input);
+      continue;
+    }
+    std::ifstream manifest(input.substr(1));
+    if (!manifest.is_open()) {
+      err << "Failed to open manifest: " << input.substr(1) << std::endl;
+      return false;
+    }
+    // one path per line, blank lines and # comments are skipped
+    std::string line;
+    while (std::getline(manifest, line)) {
+      size_t start = line.find_first_not_of(" \t\r");
+      if (start == std::string::npos || line[start] == '#') {
+        continue;
+      }
+      size_t end = line.find_last_not_of(" \t\r");
+      sources.push_back(line.substr(start, end - start + 1));
+    }
+  }
+
+  // output directories are named after the source, numbered when two sources share a name
+  std::unordered_set<std::string> usedNames;
+  for (const auto& source : sources) {
+    std::string stem = std::filesystem::path(source).stem().string();
+    std::string name = stem;
+    for (int i = 2; usedNames.count(name); i++) {
+      name = stem + "_" + std::to_string(i);
+    }
+    usedNames.insert(name);
+    collected.push_back({source, (std::filesystem::path(options.outputDir) / name).string()});
+  }
+  return true;
+}
+
+BatchCompiler::JobResult BatchCompiler::runJob(const Job& job, const CompileOptions& options) {
+  JobResult result;
+  auto start = std::chrono::steady_clock::now();
+  std::ostringstream out;
+  std::ostringstream err;
+
+  MappedFile source;
+  if (!source.open(job.sourcePath)) {
+    err << "Failed to open input file: " << job.sourcePath << std::endl;
+    result.exitCode = 1;
+  } else {
+    CompileOptions jobOptions = options;
+    jobOptions.outputDir = job.outputDir;
+    result.sourceBytes = source.contents().size();
+    // one bad program shouldn't take the whole batch down
+    try {
+      result.exitCode = compileSource(source.contents(), jobOptions, out, err).exitCode;
+    } catch (const std::exception& e) {
+      err << "Internal compiler error: " << e.what() << std::endl;
+      result.exitCode = 1;
+    }
+  }
+
+  result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  result.out = out.str();
+  result.err = err.str();
+  return result;
+}
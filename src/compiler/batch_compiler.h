@@ -0,0 +1,40 @@
+#ifndef BATCH_COMPILER_H
+#define BATCH_COMPILER_H
+
+#include "compile_driver.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// compiles many independent programs on a pool of worker threads
+// inputs are source files, or @manifest files listing one source file per line
+// each program gets its own output directory under options.outputDir, named after the source file
+class BatchCompiler {
+public:
+  BatchCompiler(const CompileOptions& options, unsigned jobs);
+
+  // returns the process exit code, non-zero if any program failed
+  int run(const std::vector<std::string>& inputs, std::ostream& out, std::ostream& err);
+
+private:
+  struct Job {
+    std::string sourcePath;
+    std::string outputDir;
+  };
+
+  struct JobResult {
+    int exitCode = 0;
+    size_t sourceBytes = 0;
+    double milliseconds = 0;
+    std::string out;
+    std::string err;
+  };
+
+  CompileOptions options;
+  unsigned jobs;
+
+  bool collectJobs(const std::vector<std::string>& inputs, std::vector<Job>& collected, std::ostream& err) const;
+  static JobResult runJob(const Job& job, const CompileOptions& options);
+};
+
+#endif // BATCH_COMPILER_H
@@ -1,39 +1,27 @@
 #include "bytecode_compiler.h"
+#include "class_file_writer.h"
 #include "listeners/bytecode_ir_generator_listener.h"
 #include "primitive_wrapper_generator.h"
+#include "symbols/type_table.h"
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <ostream>
+#include <sstream>
+#include <unordered_map>
 
-BytecodeCompiler::BytecodeCompiler(
-    cgullParser::ProgramContext* programCtx,
-    std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>> scopeMap,
-    std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>> expressionTypes,
-    std::unordered_set<antlr4::ParserRuleContext*> expectingStringConversion,
-    std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>> constructorMap,
-    std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>> resolvedMethodSymbols)
-    : programCtx(programCtx), scopeMap(scopeMap), expressionTypes(expressionTypes),
-      expectingStringConversion(expectingStringConversion), constructorMap(constructorMap),
-      resolvedMethodSymbols(resolvedMethodSymbols) {}
+BytecodeCompiler::BytecodeCompiler(const AnalysisResult& analysis) : analysis(analysis) {}
 
 void BytecodeCompiler::compile() {
-  // generate wrappers for primitive types as needed
-  for (const auto& [ctx, type] : expressionTypes) {
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
-    if (primitiveType) {
-      if (primitiveType && primitiveType->getPrimitiveKind() != PrimitiveType::PrimitiveKind::VOID) {
-        getOrCreatePrimitiveWrapper(primitiveType->getPrimitiveKind());
-      }
-    }
-  }
+  addPrimitiveWrappers();
   for (const auto& [kind, wrapper] : primitiveWrappers) {
     generatedClasses.push_back(wrapper);
   }
 
   // create a listener to generate the IR
-  BytecodeIRGeneratorListener listener(errorReporter, scopeMap, expressionTypes, resolvedMethodSymbols,
-                                       expectingStringConversion, primitiveWrappers, constructorMap);
+  BytecodeIRGeneratorListener listener(errorReporter, analysis, primitiveWrappers, generatedObjects);
   antlr4::tree::ParseTreeWalker walker;
-  walker.walk(&listener, programCtx);
+  walker.walk(&listener, analysis.programCtx);
 
   // user defined classes
   for (const auto& irClass : listener.getClasses()) {
@@ -41,81 +29,211 @@ void BytecodeCompiler::compile() {
   }
 }
 
-void BytecodeCompiler::generateBytecode(const std::string& outputDir) {
-  // remove existing .jasm and .class files
+std::vector<std::string> BytecodeCompiler::compileAndEmit(const std::string& outputDir, OutputFormat format,
+                                                          const StatementHandler& statementDone) {
+  // classes are written into a staging directory inside outputDir and only moved over the previous output once
+  // generation succeeded, so a failed compile leaves the last good output alone. same filesystem, so moving is a rename
+  std::filesystem::path staging = createStagingDirectory(outputDir);
+  std::vector<std::string> stagedPaths;
   try {
-    std::filesystem::remove_all(outputDir);
+    // the wrappers are tiny and the generated code refers to them, so they're written but kept
+    addPrimitiveWrappers();
+    for (const auto& [kind, wrapper] : primitiveWrappers) {
+      stagedPaths.push_back(writeClass(staging.string(), wrapper, format));
+    }
+
+    // the classes still being generated: each method is encoded as soon as its IR is complete and its instructions
+    // are freed, the fields and the file wait for the end of the class. jasm methods are kept as text, since the
+    // fields come first in the file
+    struct OpenClass {
+      std::unique_ptr<ClassFileWriter> writer;
+      std::ostringstream jasmMethods;
+    };
+    std::unordered_map<IRClass*, OpenClass> openClasses;
+    bool isJasm = format == OutputFormat::JASM;
+
+    BytecodeIRGeneratorListener listener(errorReporter, analysis, primitiveWrappers, generatedObjects);
+    listener.setMethodHandler([&](const std::shared_ptr<IRClass>& irClass, FunctionSymbol* method) {
+      // a class generated after an error is never written
+      if (!errorReporter.hasErrors()) {
+        auto& openClass = openClasses[irClass.get()];
+        if (isJasm) {
+          generateMethod(openClass.jasmMethods, method);
+        } else {
+          if (!openClass.writer) {
+            openClass.writer = std::make_unique<ClassFileWriter>(irClass->name);
+          }
+          addMethod(*openClass.writer, method);
+        }
+      }
+      std::vector<std::shared_ptr<IRInstruction>>().swap(method->instructions);
+    });
+    listener.setClassHandler([&](const std::shared_ptr<IRClass>& irClass) {
+      auto openClass = openClasses.extract(irClass.get());
+      if (!errorReporter.hasErrors()) {
+        std::string filePath;
+        std::ofstream outFile = openClassFile(staging.string(), irClass->name, format, filePath);
+        if (isJasm) {
+          generateClassHeader(outFile, irClass);
+          if (!openClass.empty()) {
+            outFile << openClass.mapped().jasmMethods.str();
+          }
+          outFile << "}\n";
+        } else {
+          ClassFileWriter emptyWriter(irClass->name);
+          ClassFileWriter& writer = openClass.empty() ? emptyWriter : *openClass.mapped().writer;
+          addFields(writer, irClass);
+          writer.write(outFile);
+        }
+        stagedPaths.push_back(filePath);
+      }
+      releaseInstructions(*irClass);
+    });
+
+    // the walker's order, one top level statement at a time so each can be released once its code is generated
+    antlr4::tree::ParseTreeWalker walker;
+    auto* program = analysis.programCtx;
+    listener.enterEveryRule(program);
+    program->enterRule(&listener);
+    for (size_t i = 0; i < program->children.size(); i++) {
+      walker.walk(&listener, program->children[i]);
+      if (statementDone) {
+        statementDone(i);
+      }
+    }
+    program->exitRule(&listener);
+    listener.exitEveryRule(program);
+  } catch (const std::exception&) {
+    std::error_code error;
+    std::filesystem::remove_all(staging, error);
+    throw;
+  }
+
+  std::vector<std::string> outputPaths;
+  if (!errorReporter.hasErrors()) {
+    prepareOutputDirectory(outputDir);
+    for (const auto& stagedPath : stagedPaths) {
+      auto target = std::filesystem::path(outputDir) / std::filesystem::path(stagedPath).filename();
+      std::filesystem::rename(stagedPath, target);
+      outputPaths.push_back(target.string());
+    }
+  }
+  std::error_code error;
+  std::filesystem::remove_all(staging, error);
+  return outputPaths;
+}
+
+std::filesystem::path BytecodeCompiler::createStagingDirectory(const std::string& outputDir) {
+  try {
+    std::filesystem::create_directories(outputDir);
   } catch (const std::exception& e) {
+    throw std::runtime_error("Failed to create output directory: " + outputDir + " (" + e.what() + ")");
+  }
+  // unique within the process, and the clock keeps two processes writing to the same directory apart
+  static std::atomic<uint64_t> nextStaging{0};
+  auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+  for (;;) {
+    auto staging = std::filesystem::path(outputDir) /
+                   (".staging-" + std::to_string(stamp) + "-" + std::to_string(nextStaging++));
+    std::error_code error;
+    if (std::filesystem::create_directory(staging, error)) {
+      return staging;
+    }
+    if (error) {
+      throw std::runtime_error("Failed to create staging directory: " + staging.string() + " (" + error.message() +
+                               ")");
+    }
+  }
+}
+
+void BytecodeCompiler::addPrimitiveWrappers() {
+  // generate wrappers for primitive types as needed
+  analysis.expressionTypes.forEach([&](size_t /*id*/, Type* type) {
+    auto primitiveType = typeCast<PrimitiveType>(type);
+    if (primitiveType && primitiveType->getPrimitiveKind() != PrimitiveType::PrimitiveKind::VOID) {
+      getOrCreatePrimitiveWrapper(primitiveType->getPrimitiveKind());
+    }
+  });
+}
+
+void BytecodeCompiler::releaseInstructions(IRClass& irClass) {
+  // swapped with empty vectors, clear would keep the capacity
+  for (auto method : irClass.methods) {
+    std::vector<std::shared_ptr<IRInstruction>>().swap(method->instructions);
   }
+  std::vector<std::shared_ptr<IRInstruction>>().swap(irClass.instructions);
+}
+
+void BytecodeCompiler::prepareOutputDirectory(const std::string& outputDir) {
   // create output directory if it doesn't exist
   try {
     std::filesystem::create_directories(outputDir);
   } catch (const std::exception& e) {
     throw std::runtime_error("Failed to create output directory: " + outputDir + " (" + e.what() + ")");
   }
+  // remove existing .jasm and .class files, only the kinds of file we write and never subdirectories, the directory
+  // may be shared with other files
+  std::error_code error;
+  for (const auto& entry : std::filesystem::directory_iterator(outputDir, error)) {
+    auto extension = entry.path().extension();
+    if ((extension == ".class" || extension == ".jasm") && entry.is_regular_file(error)) {
+      std::filesystem::remove(entry.path(), error);
+    }
+  }
+}
+
+std::vector<std::string> BytecodeCompiler::generateBytecode(const std::string& outputDir, OutputFormat format) {
+  prepareOutputDirectory(outputDir);
 
+  std::vector<std::string> outputPaths;
   for (const auto& irClass : generatedClasses) {
-    std::string filePath = outputDir + "/" + irClass->name + ".jasm";
-    std::ofstream outFile(filePath);
+    outputPaths.push_back(writeClass(outputDir, irClass, format));
+  }
+  return outputPaths;
+}
 
-    if (!outFile.is_open()) {
-      throw std::runtime_error("Failed to open output file: " + filePath);
-    }
+std::ofstream BytecodeCompiler::openClassFile(const std::string& outputDir, const std::string& className,
+                                             OutputFormat format, std::string& filePath) {
+  bool isJasm = format == OutputFormat::JASM;
+  filePath = outputDir + "/" + className + (isJasm ? ".jasm" : ".class");
+  std::ofstream outFile(filePath, isJasm ? std::ios::out : std::ios::out | std::ios::binary);
 
-    generateClass(outFile, irClass);
-    outFile.close();
+  if (!outFile.is_open()) {
+    throw std::runtime_error("Failed to open output file: " + filePath);
+  }
+  return outFile;
+}
 
-    std::cout << "Generated class file: " << filePath << std::endl;
+std::string BytecodeCompiler::writeClass(const std::string& outputDir, const std::shared_ptr<IRClass>& irClass,
+                                         OutputFormat format) {
+  std::string filePath;
+  std::ofstream outFile = openClassFile(outputDir, irClass->name, format, filePath);
+  if (format == OutputFormat::JASM) {
+    generateClass(outFile, irClass);
+  } else {
+    generateClassFile(outFile, irClass);
   }
+  outFile.close();
+  return filePath;
 }
 
 // right now does not support user types
-std::string BytecodeCompiler::typeToJVMType(const std::shared_ptr<Type>& type) {
-  auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
-  if (primitiveType) {
-    switch (primitiveType->getPrimitiveKind()) {
-    case PrimitiveType::PrimitiveKind::INT:
-      return "I";
-    case PrimitiveType::PrimitiveKind::FLOAT:
-      return "F";
-    case PrimitiveType::PrimitiveKind::STRING:
-      return "java/lang/String";
-    case PrimitiveType::PrimitiveKind::BOOLEAN:
-      return "Z";
-    case PrimitiveType::PrimitiveKind::VOID:
-      return "V";
-    default:
-      throw std::runtime_error("Unsupported right now");
-    }
-  }
-  auto pointerType = std::dynamic_pointer_cast<PointerType>(type);
-  if (pointerType) {
-    return pointerType->toString();
-  }
-  auto arrayType = std::dynamic_pointer_cast<ArrayType>(type);
-  if (arrayType) {
-    return "[" + typeToJVMType(arrayType->getElementType());
+std::string BytecodeCompiler::typeToJVMType(Type* type) { return FunctionSignature::jvmType(type); }
+
+void BytecodeCompiler::generateClass(std::basic_ostream<char>& out, const std::shared_ptr<IRClass>& irClass) {
+  generateClassHeader(out, irClass);
+  for (const auto& method : irClass->methods) {
+    generateMethod(out, method);
   }
-  return type->toString();
+  out << "}\n";
 }
 
-void BytecodeCompiler::generateClass(std::basic_ostream<char>& out, const std::shared_ptr<IRClass>& irClass) {
+void BytecodeCompiler::generateClassHeader(std::basic_ostream<char>& out, const std::shared_ptr<IRClass>& irClass) {
   out << "public class " << irClass->name << " {\n";
 
-  if (irClass->name.find("Reference") != std::string::npos &&
-      (irClass->name == "IntReference" || irClass->name == "FloatReference" || irClass->name == "BoolReference" ||
-       irClass->name == "StringReference")) {
-    std::string fieldType;
-    if (irClass->name == "IntReference")
-      fieldType = "I";
-    else if (irClass->name == "FloatReference")
-      fieldType = "F";
-    else if (irClass->name == "BoolReference")
-      fieldType = "Z";
-    else if (irClass->name == "StringReference")
-      fieldType = "java/lang/String";
-
-    out << "private value " << fieldType << "\n";
+  std::string wrapperFieldType = getWrapperFieldType(irClass);
+  if (!wrapperFieldType.empty()) {
+    out << "private value " << wrapperFieldType << "\n";
   }
 
   // fields
@@ -123,71 +241,115 @@ void BytecodeCompiler::generateClass(std::basic_ostream<char>& out, const std::s
     out << (variable->isPrivate ? "private " : "public ") << variable->name << " " << typeToJVMType(variable->dataType)
         << "\n";
   }
+}
 
-  for (const auto& method : irClass->methods) {
-    // special case for main
-    if (method->name == "main") {
-      out << "public static main(";
-    } else if (method->name == "<init>") {
-      out << "public <init>(";
-    } else {
-      // static just for the main method, really
-      out << "public " << (method->isStructMethod ? "" : "static ") << method->getMangledName() << "(";
-    }
-    // function parameters
-    if (method->name == "main") {
-      out << "[java/lang/String";
-    } else {
-      for (size_t i = 0; i < method->parameters.size(); ++i) {
-        const auto& parameter = method->parameters[i];
-        if (i > 0)
-          out << ", ";
-        out << typeToJVMType(parameter->dataType);
-      }
-    }
-    out << ")";
-    // function return type
-    if (method->returnTypes.size() > 0 && method->name != "<init>") {
-      out << typeToJVMType(method->returnTypes[0]);
-    } else if (method->name == "<init>") {
-      out << "V";
-    }
-    out << "{\n";
+void BytecodeCompiler::generateMethod(std::basic_ostream<char>& out, FunctionSymbol* method) {
+  out << "public " << (isStaticMethod(method) ? "static " : "") << getMethodName(method)
+      << method->getSignature().getDescriptor() << "{\n";
 
-    for (const auto& instruction : method->instructions) {
-      generateInstruction(out, instruction);
-    }
-    // implicit return for void functions, doesn't hurt to be redundant
-    auto voidType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID);
-    if (method->returnTypes[0]->equals(voidType)) {
-      out << "return\n";
-    }
-    out << "}\n";
+  for (const auto& line : getMethodCode(method)) {
+    out << line << "\n";
   }
   out << "}\n";
 }
 
+void BytecodeCompiler::generateClassFile(std::basic_ostream<char>& out, const std::shared_ptr<IRClass>& irClass) {
+  ClassFileWriter writer(irClass->name);
+  // methods before fields, the order compileAndEmit has to add them in, so both write the same constant pool
+  for (const auto& method : irClass->methods) {
+    addMethod(writer, method);
+  }
+  addFields(writer, irClass);
+  writer.write(out);
+}
+
+void BytecodeCompiler::addFields(ClassFileWriter& writer, const std::shared_ptr<IRClass>& irClass) {
+  std::string wrapperFieldType = getWrapperFieldType(irClass);
+  if (!wrapperFieldType.empty()) {
+    writer.addField("value", wrapperFieldType, true);
+  }
+  for (const auto& variable : irClass->variables) {
+    writer.addField(variable->name, typeToJVMType(variable->dataType), variable->isPrivate);
+  }
+}
+
+void BytecodeCompiler::addMethod(ClassFileWriter& writer, FunctionSymbol* method) {
+  writer.addMethod(getMethodName(method), getParameterTypes(method), getReturnType(method), isStaticMethod(method),
+                   getMethodCode(method));
+}
+
+std::string BytecodeCompiler::getWrapperFieldType(const std::shared_ptr<IRClass>& irClass) {
+  if (irClass->name == "IntReference")
+    return "I";
+  else if (irClass->name == "FloatReference")
+    return "F";
+  else if (irClass->name == "BoolReference")
+    return "Z";
+  else if (irClass->name == "StringReference")
+    return "java/lang/String";
+  return "";
+}
+
+std::string BytecodeCompiler::getMethodName(FunctionSymbol* method) {
+  if (method->name == "main" || method->name == "<init>") {
+    return method->name;
+  }
+  return method->getMangledName();
+}
+
+// static just for the main method, really
+bool BytecodeCompiler::isStaticMethod(FunctionSymbol* method) {
+  if (method->name == "main") {
+    return true;
+  }
+  return method->name != "<init>" && !method->isStructMethod;
+}
+
+const std::vector<std::string>& BytecodeCompiler::getParameterTypes(FunctionSymbol* method) {
+  return method->getSignature().getJVMParameterTypes();
+}
+
+const std::string& BytecodeCompiler::getReturnType(FunctionSymbol* method) {
+  return method->getSignature().getJVMReturnType();
+}
+
+std::vector<std::string> BytecodeCompiler::getMethodCode(FunctionSymbol* method) {
+  std::stringstream code;
+  for (const auto& instruction : method->instructions) {
+    generateInstruction(code, instruction);
+  }
+  // implicit return for void functions, doesn't hurt to be redundant
+  auto voidType = TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID);
+  if (method->returnTypes[0]->equals(voidType)) {
+    code << "return\n";
+  }
+
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(code, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
 void BytecodeCompiler::generateInstruction(std::basic_ostream<char>& out,
                                            const std::shared_ptr<IRInstruction>& instruction) {
-  auto callInstruction = std::dynamic_pointer_cast<IRCallInstruction>(instruction);
-  if (callInstruction) {
-    generateCallInstruction(out, callInstruction);
-    return;
-  }
-  auto rawInstruction = std::dynamic_pointer_cast<IRRawInstruction>(instruction);
-  if (rawInstruction) {
-    out << rawInstruction->instruction << "\n";
-    return;
+  switch (instruction->getKind()) {
+  case IRInstruction::InstructionKind::CALL:
+    generateCallInstruction(out, static_cast<IRCallInstruction*>(instruction.get()));
+    break;
+  case IRInstruction::InstructionKind::RAW:
+    out << static_cast<IRRawInstruction*>(instruction.get())->instruction << "\n";
+    break;
   }
 }
 
 // to be continued in HW5
-void BytecodeCompiler::generateCallInstruction(std::basic_ostream<char>& out,
-                                               const std::shared_ptr<IRCallInstruction>& instruction) {
+void BytecodeCompiler::generateCallInstruction(std::basic_ostream<char>& out, IRCallInstruction* instruction) {
   if ((instruction->function->name == "print" || instruction->function->name == "println") &&
       instruction->function->scope->resolve("this") == nullptr) {
     // getstatic already added in enterFunction_call
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(instruction->function->parameters[0]->dataType);
+    auto primitiveType = typeCast<PrimitiveType>(instruction->function->parameters[0]->dataType);
     if (primitiveType->getPrimitiveKind() == PrimitiveType::PrimitiveKind::STRING) {
       out << "invokevirtual java/io/PrintStream." << instruction->function->name << "(java/lang/String)V\n";
     }
@@ -209,32 +371,18 @@ void BytecodeCompiler::generateCallInstruction(std::basic_ostream<char>& out,
 
   if (instruction->function->name == "<init>") {
     // don't use mangled name for constructors
-    out << "invokespecial " << instruction->function->returnTypes[0]->toString() << "." << instruction->function->name
-        << "(";
+    out << "invokespecial " << instruction->function->returnTypes[0]->toString() << "." << instruction->function->name;
   } else {
     // get the "this" from the function's scope
-    auto thisVar = std::dynamic_pointer_cast<VariableSymbol>(instruction->function->scope->resolve("this"));
+    auto thisVar = dynamic_cast<VariableSymbol*>(instruction->function->scope->resolve("this"));
     if (thisVar) {
-      out << "invokevirtual " << thisVar->dataType->toString() << "." << instruction->function->getMangledName() << "(";
+      out << "invokevirtual " << thisVar->dataType->toString() << "." << instruction->function->getMangledName();
     } else {
-      out << "invokestatic Main." << instruction->function->getMangledName() << "(";
+      out << "invokestatic Main." << instruction->function->getMangledName();
     }
   }
 
-  for (int i = 0; i < instruction->function->parameters.size(); i++) {
-    if (i > 0) {
-      out << ", ";
-    }
-    out << typeToJVMType(instruction->function->parameters[i]->dataType);
-  }
-  out << ")";
-  // return type
-  if (instruction->function->returnTypes.size() > 0 && instruction->function->name != "<init>") {
-    out << typeToJVMType(instruction->function->returnTypes[0]);
-  } else {
-    out << "V";
-  }
-  out << "\n";
+  out << instruction->function->getSignature().getDescriptor() << "\n";
 }
 
 std::shared_ptr<IRClass> BytecodeCompiler::getOrCreatePrimitiveWrapper(PrimitiveType::PrimitiveKind kind) {
@@ -243,19 +391,19 @@ std::shared_ptr<IRClass> BytecodeCompiler::getOrCreatePrimitiveWrapper(Primitive
     return it->second;
   }
 
-  auto wrapper = PrimitiveWrapperGenerator::generateWrapperClass(kind);
+  auto wrapper = PrimitiveWrapperGenerator::generateWrapperClass(kind, generatedObjects);
   primitiveWrappers[kind] = wrapper;
   return wrapper;
 }
 
-bool BytecodeCompiler::needsPrimitiveWrapper(const std::shared_ptr<Type>& type) {
-  auto pointerType = std::dynamic_pointer_cast<PointerType>(type);
+bool BytecodeCompiler::needsPrimitiveWrapper(Type* type) {
+  auto pointerType = typeCast<PointerType>(type);
   if (!pointerType) {
     return false;
   }
 
   auto pointeeType = pointerType->getPointedType();
-  auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(pointeeType);
+  auto primitiveType = typeCast<PrimitiveType>(pointeeType);
 
   // needs wrapper if it's a pointer to a primitive (except void)
   return primitiveType && primitiveType->getPrimitiveKind() != PrimitiveType::PrimitiveKind::VOID;
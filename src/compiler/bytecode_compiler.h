@@ -1,43 +1,87 @@
 #ifndef BYTECODE_COMPILER_H
 #define BYTECODE_COMPILER_H
 
+#include "analysis_result.h"
+#include "arena.h"
 #include "errors/error_reporter.h"
 #include "instructions/ir_class.h"
 #include <cgullParser.h>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+class ClassFileWriter;
 
 class BytecodeCompiler {
 public:
-  BytecodeCompiler(
-      cgullParser::ProgramContext* programCtx,
-      std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>> scopeMap,
-      std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>> expressionTypes,
-      std::unordered_set<antlr4::ParserRuleContext*> expectingStringConversion,
-      std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>> constructorMap,
-      std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>> resolvedMethodSymbols);
+  // jasm text is kept around as a debug output
+  enum class OutputFormat { CLASS_FILE, JASM };
+
+  // analysis is only read, and has to outlive the compiler
+  explicit BytecodeCompiler(const AnalysisResult& analysis);
 
   void compile();
-  void generateBytecode(const std::string& outputDir);
+  // returns the paths of the written files
+  std::vector<std::string> generateBytecode(const std::string& outputDir,
+                                            OutputFormat format = OutputFormat::CLASS_FILE);
+  // called with the index of each top level statement (a child of the program node) once its code is generated,
+  // nothing reads its subtree after that
+  using StatementHandler = std::function<void(size_t statementIndex)>;
+  // compile and generateBytecode in one pipeline: each method is encoded as soon as its IR is complete and its
+  // instructions are freed right after, so only the method being generated holds IR. a class is written when its last
+  // method is done
+  // the files go to a staging directory first and replace the previous output only if generation reports no errors,
+  // otherwise nothing is returned and the output directory is left as it was
+  std::vector<std::string> compileAndEmit(const std::string& outputDir,
+                                          OutputFormat format = OutputFormat::CLASS_FILE,
+                                          const StatementHandler& statementDone = {});
   ErrorReporter& getErrorReporter() { return errorReporter; }
 
-  static std::string typeToJVMType(const std::shared_ptr<Type>& type);
+  // makes sure the directory exists and removes the .class and .jasm files of a previous compile, nothing else
+  static void prepareOutputDirectory(const std::string& outputDir);
+
+  static std::string typeToJVMType(Type* type);
 
 private:
   ErrorReporter errorReporter;
-  cgullParser::ProgramContext* programCtx;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>> scopeMap;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>> expressionTypes;
-  std::unordered_set<antlr4::ParserRuleContext*> expectingStringConversion;
+  const AnalysisResult& analysis;
   std::vector<std::shared_ptr<IRClass>> generatedClasses;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>> resolvedMethodSymbols;
+  // symbols made up by code generation: the wrapper classes' and the structs' JVM constructors
+  ObjectArena generatedObjects;
   std::unordered_map<PrimitiveType::PrimitiveKind, std::shared_ptr<IRClass>> primitiveWrappers;
-  std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>> constructorMap;
+
+  // the wrappers for every primitive type some expression has
+  void addPrimitiveWrappers();
+  // writes one class to outputDir, returns the path of the file
+  std::string writeClass(const std::string& outputDir, const std::shared_ptr<IRClass>& irClass, OutputFormat format);
+  // opens the file a class is written to, filePath is set to its path
+  static std::ofstream openClassFile(const std::string& outputDir, const std::string& className, OutputFormat format,
+                                     std::string& filePath);
+  // a new empty directory inside outputDir, which is created if needed
+  static std::filesystem::path createStagingDirectory(const std::string& outputDir);
+  static void releaseInstructions(IRClass& irClass);
 
   void generateClass(std::basic_ostream<char>& out, const std::shared_ptr<IRClass>& irClass);
+  // the class line and the fields, everything before the methods
+  void generateClassHeader(std::basic_ostream<char>& out, const std::shared_ptr<IRClass>& irClass);
+  void generateMethod(std::basic_ostream<char>& out, FunctionSymbol* method);
+  void generateClassFile(std::basic_ostream<char>& out, const std::shared_ptr<IRClass>& irClass);
+  void addFields(ClassFileWriter& writer, const std::shared_ptr<IRClass>& irClass);
+  void addMethod(ClassFileWriter& writer, FunctionSymbol* method);
   void generateInstruction(std::basic_ostream<char>& out, const std::shared_ptr<IRInstruction>& instruction);
-  void generateCallInstruction(std::basic_ostream<char>& out, const std::shared_ptr<IRCallInstruction>& instruction);
+  void generateCallInstruction(std::basic_ostream<char>& out, IRCallInstruction* instruction);
+
+  // shared between the jasm and class file outputs
+  static std::string getWrapperFieldType(const std::shared_ptr<IRClass>& irClass);
+  static std::string getMethodName(FunctionSymbol* method);
+  static bool isStaticMethod(FunctionSymbol* method);
+  // from the signature computed when the function was registered
+  static const std::vector<std::string>& getParameterTypes(FunctionSymbol* method);
+  static const std::string& getReturnType(FunctionSymbol* method);
+  std::vector<std::string> getMethodCode(FunctionSymbol* method);
 
   std::shared_ptr<IRClass> getOrCreatePrimitiveWrapper(PrimitiveType::PrimitiveKind kind);
-  bool needsPrimitiveWrapper(const std::shared_ptr<Type>& type);
+  bool needsPrimitiveWrapper(Type* type);
 };
 
 #endif // BYTECODE_COMPILER_H
@@ -0,0 +1,1239 @@
+#include "class_file_writer.h"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+namespace {
+
+// java 8 class files, the oldest version that still lets us use invokedynamic and requires stack map frames
+constexpr uint16_t MAJOR_VERSION = 52;
+
+constexpr uint16_t ACC_PUBLIC = 0x0001;
+constexpr uint16_t ACC_PRIVATE = 0x0002;
+constexpr uint16_t ACC_STATIC = 0x0008;
+constexpr uint16_t ACC_SUPER = 0x0020;
+
+constexpr uint8_t CONSTANT_UTF8 = 1;
+constexpr uint8_t CONSTANT_INTEGER = 3;
+constexpr uint8_t CONSTANT_FLOAT = 4;
+constexpr uint8_t CONSTANT_CLASS = 7;
+constexpr uint8_t CONSTANT_STRING = 8;
+constexpr uint8_t CONSTANT_FIELDREF = 9;
+constexpr uint8_t CONSTANT_METHODREF = 10;
+constexpr uint8_t CONSTANT_NAME_AND_TYPE = 12;
+constexpr uint8_t CONSTANT_METHOD_HANDLE = 15;
+constexpr uint8_t CONSTANT_INVOKE_DYNAMIC = 18;
+
+// opcodes that need special handling, everything else comes from the tables below
+constexpr uint8_t ACONST_NULL = 0x01;
+constexpr uint8_t ICONST_0 = 0x03;
+constexpr uint8_t FCONST_0 = 0x0b;
+constexpr uint8_t BIPUSH = 0x10;
+constexpr uint8_t SIPUSH = 0x11;
+constexpr uint8_t LDC = 0x12;
+constexpr uint8_t LDC_W = 0x13;
+constexpr uint8_t ILOAD = 0x15;
+constexpr uint8_t FLOAD = 0x17;
+constexpr uint8_t ALOAD = 0x19;
+constexpr uint8_t IALOAD = 0x2e;
+constexpr uint8_t FALOAD = 0x30;
+constexpr uint8_t AALOAD = 0x32;
+constexpr uint8_t BALOAD = 0x33;
+constexpr uint8_t ISTORE = 0x36;
+constexpr uint8_t FSTORE = 0x38;
+constexpr uint8_t ASTORE = 0x3a;
+constexpr uint8_t IASTORE = 0x4f;
+constexpr uint8_t FASTORE = 0x51;
+constexpr uint8_t AASTORE = 0x53;
+constexpr uint8_t BASTORE = 0x54;
+constexpr uint8_t POP = 0x57;
+constexpr uint8_t DUP = 0x59;
+constexpr uint8_t DUP_X1 = 0x5a;
+constexpr uint8_t DUP_X2 = 0x5b;
+constexpr uint8_t SWAP = 0x5f;
+constexpr uint8_t IFEQ = 0x99;
+constexpr uint8_t IF_ICMPEQ = 0x9f;
+constexpr uint8_t IF_ACMPNE = 0xa6;
+constexpr uint8_t GOTO = 0xa7;
+constexpr uint8_t GOTO_W = 0xc8;
+constexpr uint8_t IRETURN = 0xac;
+constexpr uint8_t FRETURN = 0xae;
+constexpr uint8_t ARETURN = 0xb0;
+constexpr uint8_t RETURN = 0xb1;
+constexpr uint8_t GETSTATIC = 0xb2;
+constexpr uint8_t PUTSTATIC = 0xb3;
+constexpr uint8_t GETFIELD = 0xb4;
+constexpr uint8_t PUTFIELD = 0xb5;
+constexpr uint8_t INVOKEVIRTUAL = 0xb6;
+constexpr uint8_t INVOKESPECIAL = 0xb7;
+constexpr uint8_t INVOKESTATIC = 0xb8;
+constexpr uint8_t INVOKEDYNAMIC = 0xba;
+constexpr uint8_t NEW = 0xbb;
+constexpr uint8_t ARRAYLENGTH = 0xbe;
+constexpr uint8_t ATHROW = 0xbf;
+constexpr uint8_t WIDE = 0xc4;
+constexpr uint8_t MULTIANEWARRAY = 0xc5;
+constexpr uint8_t IFNULL = 0xc6;
+constexpr uint8_t IFNONNULL = 0xc7;
+
+const std::unordered_map<std::string, uint8_t> simpleOpcodes = {
+    {"nop", 0x00},    {"aconst_null", 0x01}, {"iaload", 0x2e}, {"faload", 0x30}, {"aaload", 0x32},
+    {"baload", 0x33}, {"iastore", 0x4f},     {"fastore", 0x51}, {"aastore", 0x53}, {"bastore", 0x54},
+    {"pop", 0x57},    {"dup", 0x59},         {"dup_x1", 0x5a},  {"dup_x2", 0x5b},  {"swap", 0x5f},
+    {"iadd", 0x60},   {"fadd", 0x62},        {"isub", 0x64},    {"fsub", 0x66},    {"imul", 0x68},
+    {"fmul", 0x6a},   {"idiv", 0x6c},        {"fdiv", 0x6e},    {"irem", 0x70},    {"frem", 0x72},
+    {"ineg", 0x74},   {"fneg", 0x76},        {"ishl", 0x78},    {"ishr", 0x7a},    {"iushr", 0x7c},
+    {"iand", 0x7e},   {"ior", 0x80},         {"ixor", 0x82},    {"i2f", 0x86},     {"f2i", 0x8b},
+    {"fcmpl", 0x95},  {"fcmpg", 0x96},       {"ireturn", 0xac}, {"freturn", 0xae}, {"areturn", 0xb0},
+    {"return", 0xb1}, {"arraylength", 0xbe}, {"athrow", 0xbf},
+};
+
+const std::unordered_map<std::string, uint8_t> branchOpcodes = {
+    {"ifeq", 0x99},      {"ifne", 0x9a},      {"iflt", 0x9b},      {"ifge", 0x9c},      {"ifgt", 0x9d},
+    {"ifle", 0x9e},      {"if_icmpeq", 0x9f}, {"if_icmpne", 0xa0}, {"if_icmplt", 0xa1}, {"if_icmpge", 0xa2},
+    {"if_icmpgt", 0xa3}, {"if_icmple", 0xa4}, {"if_acmpeq", 0xa5}, {"if_acmpne", 0xa6}, {"goto", 0xa7},
+    {"ifnull", 0xc6},    {"ifnonnull", 0xc7},
+};
+
+// generic opcode and the opcode of the _0 short form
+const std::unordered_map<std::string, std::pair<uint8_t, uint8_t>> localOpcodes = {
+    {"iload", {ILOAD, 0x1a}},   {"fload", {FLOAD, 0x22}},   {"aload", {ALOAD, 0x2a}},
+    {"istore", {ISTORE, 0x3b}}, {"fstore", {FSTORE, 0x43}}, {"astore", {ASTORE, 0x4b}},
+};
+
+const std::unordered_map<std::string, uint8_t> fieldOpcodes = {
+    {"getstatic", GETSTATIC}, {"putstatic", PUTSTATIC}, {"getfield", GETFIELD}, {"putfield", PUTFIELD}};
+
+const std::unordered_map<std::string, uint8_t> invokeOpcodes = {
+    {"invokevirtual", INVOKEVIRTUAL}, {"invokespecial", INVOKESPECIAL}, {"invokestatic", INVOKESTATIC}};
+
+const std::unordered_map<std::string, uint8_t> methodHandleKinds = {
+    {"invokevirtual", 5}, {"invokestatic", 6}, {"invokespecial", 7}, {"newinvokespecial", 8}};
+
+void putU1(std::vector<uint8_t>& out, uint8_t value) { out.push_back(value); }
+
+void putU2(std::vector<uint8_t>& out, uint16_t value) {
+  out.push_back(static_cast<uint8_t>(value >> 8));
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+void putU4(std::vector<uint8_t>& out, uint32_t value) {
+  putU2(out, static_cast<uint16_t>(value >> 16));
+  putU2(out, static_cast<uint16_t>(value));
+}
+
+void putBytes(std::vector<uint8_t>& out, const std::vector<uint8_t>& bytes) {
+  out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+std::string trim(const std::string& text) {
+  size_t start = text.find_first_not_of(" \t\r\n");
+  if (start == std::string::npos) {
+    return "";
+  }
+  size_t end = text.find_last_not_of(" \t\r\n");
+  return text.substr(start, end - start + 1);
+}
+
+void appendUtf8(std::string& out, uint32_t codePoint) {
+  if (codePoint < 0x80) {
+    out += static_cast<char>(codePoint);
+  } else if (codePoint < 0x800) {
+    out += static_cast<char>(0xc0 | (codePoint >> 6));
+    out += static_cast<char>(0x80 | (codePoint & 0x3f));
+  } else {
+    out += static_cast<char>(0xe0 | (codePoint >> 12));
+    out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+    out += static_cast<char>(0x80 | (codePoint & 0x3f));
+  }
+}
+
+// the class file uses "modified" utf-8: no raw nul bytes and supplementary characters as surrogate pairs
+std::string toModifiedUtf8(const std::string& text) {
+  std::string out;
+  out.reserve(text.size());
+  for (size_t i = 0; i < text.size();) {
+    auto c = static_cast<unsigned char>(text[i]);
+    if (c == 0) {
+      out += "\xc0\x80";
+      i++;
+    } else if (c >= 0xf0 && i + 3 < text.size()) {
+      uint32_t codePoint = ((c & 0x07) << 18) | ((static_cast<unsigned char>(text[i + 1]) & 0x3f) << 12) |
+                           ((static_cast<unsigned char>(text[i + 2]) & 0x3f) << 6) |
+                           (static_cast<unsigned char>(text[i + 3]) & 0x3f);
+      codePoint -= 0x10000;
+      appendUtf8(out, 0xd800 + (codePoint >> 10));
+      appendUtf8(out, 0xdc00 + (codePoint & 0x3ff));
+      i += 4;
+    } else {
+      out += static_cast<char>(c);
+      i++;
+    }
+  }
+  return out;
+}
+
+// reads a quoted literal starting at pos, leaves pos after the closing quote
+std::string parseStringLiteral(const std::string& text, size_t& pos) {
+  if (pos >= text.size() || text[pos] != '"') {
+    throw std::runtime_error("Expected string literal in: " + text);
+  }
+  std::string value;
+  for (pos++; pos < text.size() && text[pos] != '"'; pos++) {
+    if (text[pos] != '\\' || pos + 1 >= text.size()) {
+      value += text[pos];
+      continue;
+    }
+    char escaped = text[++pos];
+    switch (escaped) {
+    case 'n':
+      value += '\n';
+      break;
+    case 't':
+      value += '\t';
+      break;
+    case 'r':
+      value += '\r';
+      break;
+    case 'b':
+      value += '\b';
+      break;
+    case 'f':
+      value += '\f';
+      break;
+    case 'u':
+      if (pos + 4 < text.size()) {
+        appendUtf8(value, std::stoul(text.substr(pos + 1, 4), nullptr, 16));
+        pos += 4;
+        break;
+      }
+      value += escaped;
+      break;
+    default:
+      // \" \\ \/ and anything unknown is just the character itself
+      value += escaped;
+      break;
+    }
+  }
+  if (pos >= text.size()) {
+    throw std::runtime_error("Unterminated string literal in: " + text);
+  }
+  pos++;
+  return value;
+}
+
+// jasm type (I, java/lang/String, [I) to a field descriptor (I, Ljava/lang/String;, [I)
+std::string toFieldDescriptor(const std::string& type) {
+  std::string trimmed = trim(type);
+  if (trimmed.empty()) {
+    throw std::runtime_error("Missing type in class file writer");
+  }
+  if (trimmed[0] == '[') {
+    return "[" + toFieldDescriptor(trimmed.substr(1));
+  }
+  if (trimmed.size() == 1 && std::string("BCDFIJSZV").find(trimmed[0]) != std::string::npos) {
+    return trimmed;
+  }
+  return "L" + trimmed + ";";
+}
+
+// name used for CONSTANT_Class, arrays are named by their descriptor
+std::string toClassName(const std::string& type) {
+  std::string trimmed = trim(type);
+  return trimmed[0] == '[' ? toFieldDescriptor(trimmed) : trimmed;
+}
+
+std::string toMethodDescriptor(const std::vector<std::string>& parameterTypes, const std::string& returnType) {
+  std::string descriptor = "(";
+  for (const auto& parameterType : parameterTypes) {
+    descriptor += toFieldDescriptor(parameterType);
+  }
+  return descriptor + ")" + toFieldDescriptor(returnType);
+}
+
+// "(I, [I)V" or "(java/lang/String,)java/lang/String"
+void parseMethodType(const std::string& text, std::vector<std::string>& parameterTypes, std::string& returnType) {
+  size_t open = text.find('(');
+  size_t close = text.find(')', open);
+  if (open == std::string::npos || close == std::string::npos) {
+    throw std::runtime_error("Malformed method type: " + text);
+  }
+  std::string parameters = text.substr(open + 1, close - open - 1);
+  size_t start = 0;
+  while (start <= parameters.size()) {
+    size_t comma = parameters.find(',', start);
+    if (comma == std::string::npos) {
+      comma = parameters.size();
+    }
+    std::string parameter = trim(parameters.substr(start, comma - start));
+    if (!parameter.empty()) {
+      parameterTypes.push_back(parameter);
+    }
+    start = comma + 1;
+  }
+  returnType = trim(text.substr(close + 1));
+}
+
+// "Owner.name" split at the last dot, class names use slashes so the owner never contains one
+void parseMemberReference(const std::string& text, std::string& owner, std::string& name) {
+  size_t dot = text.rfind('.');
+  if (dot == std::string::npos) {
+    throw std::runtime_error("Malformed member reference: " + text);
+  }
+  owner = trim(text.substr(0, dot));
+  name = trim(text.substr(dot + 1));
+}
+
+struct VerificationType {
+  enum Tag : uint8_t {
+    TOP = 0,
+    INTEGER = 1,
+    FLOAT = 2,
+    NULL_TYPE = 5,
+    UNINITIALIZED_THIS = 6,
+    OBJECT = 7,
+    UNINITIALIZED = 8,
+  };
+
+  Tag tag = TOP;
+  // object class, or the class being constructed while uninitialized
+  std::string className;
+  // index of the `new` instruction for UNINITIALIZED
+  size_t newInstruction = 0;
+
+  bool isReference() const { return tag >= NULL_TYPE; }
+  bool operator==(const VerificationType& other) const {
+    return tag == other.tag && className == other.className && newInstruction == other.newInstruction;
+  }
+  bool operator!=(const VerificationType& other) const { return !(*this == other); }
+
+  static VerificationType of(Tag tag, const std::string& className = "", size_t newInstruction = 0) {
+    VerificationType type;
+    type.tag = tag;
+    type.className = className;
+    type.newInstruction = newInstruction;
+    return type;
+  }
+
+  static VerificationType fromDescriptor(const std::string& descriptor) {
+    switch (descriptor[0]) {
+    case 'B':
+    case 'C':
+    case 'I':
+    case 'S':
+    case 'Z':
+      return of(INTEGER);
+    case 'F':
+      return of(FLOAT);
+    case 'L':
+      return of(OBJECT, descriptor.substr(1, descriptor.size() - 2));
+    case '[':
+      return of(OBJECT, descriptor);
+    default:
+      throw std::runtime_error("Unsupported type in class file writer: " + descriptor);
+    }
+  }
+
+  // least upper bound, good enough for the code we generate
+  static VerificationType merge(const VerificationType& a, const VerificationType& b) {
+    if (a == b) {
+      return a;
+    }
+    if (a.tag == NULL_TYPE && b.tag == OBJECT) {
+      return b;
+    }
+    if (b.tag == NULL_TYPE && a.tag == OBJECT) {
+      return a;
+    }
+    if (a.tag == OBJECT && b.tag == OBJECT) {
+      return of(OBJECT, "java/lang/Object");
+    }
+    return of(TOP);
+  }
+};
+
+struct Frame {
+  std::vector<VerificationType> locals;
+  std::vector<VerificationType> stack;
+
+  bool operator==(const Frame& other) const { return locals == other.locals && stack == other.stack; }
+  bool operator!=(const Frame& other) const { return !(*this == other); }
+};
+
+struct Instruction {
+  // source text, for error messages
+  std::string text;
+  uint8_t opcode = 0;
+  // everything but the branch offset
+  std::vector<uint8_t> bytes;
+  // branch target
+  std::string label;
+  int local = -1;
+  // pushed by constants, loaded fields, invoke results, new and multianewarray
+  std::optional<VerificationType> result;
+  // values popped by invokes (without the receiver), putfield/putstatic and multianewarray
+  size_t argumentCount = 0;
+  std::string memberName;
+  // invokedynamic call site descriptor and bootstrap method, resolved by the writer
+  std::string descriptor;
+  std::string bootstrap;
+
+  size_t size() const { return bytes.size() + (label.empty() ? 0 : 2); }
+  bool isBranch() const { return !label.empty(); }
+  bool isUnconditional() const {
+    return opcode == GOTO || opcode == ATHROW || (opcode >= IRETURN && opcode <= RETURN);
+  }
+};
+
+void setConstantIndex(Instruction& instruction, uint16_t index) {
+  if (index <= 0xff) {
+    instruction.bytes = {LDC, static_cast<uint8_t>(index)};
+  } else {
+    instruction.bytes = {LDC_W};
+    putU2(instruction.bytes, index);
+  }
+}
+
+void parseLdc(ConstantPool& constantPool, Instruction& instruction, const std::string& operand) {
+  instruction.opcode = LDC;
+  if (!operand.empty() && operand[0] == '"') {
+    size_t pos = 0;
+    std::string value = parseStringLiteral(operand, pos);
+    setConstantIndex(instruction, constantPool.addString(value));
+    instruction.result = VerificationType::of(VerificationType::OBJECT, "java/lang/String");
+  } else if (operand.find_first_of(".eEfF") != std::string::npos && operand.find_first_of("xX") == std::string::npos) {
+    setConstantIndex(instruction, constantPool.addFloat(std::stof(operand)));
+    instruction.result = VerificationType::of(VerificationType::FLOAT);
+  } else {
+    long long value = std::stoll(operand, nullptr, 0);
+    if (value < INT32_MIN || value > INT32_MAX) {
+      throw std::runtime_error("Integer constant out of range: " + operand);
+    }
+    setConstantIndex(instruction, constantPool.addInteger(static_cast<int32_t>(value)));
+    instruction.result = VerificationType::of(VerificationType::INTEGER);
+  }
+}
+
+Instruction parseInstruction(ConstantPool& constantPool, const std::string& text) {
+  Instruction instruction;
+  instruction.text = text;
+
+  size_t space = text.find_first_of(" \t");
+  std::string mnemonic = text.substr(0, space);
+  std::string operand = space == std::string::npos ? "" : trim(text.substr(space));
+
+  if (auto it = simpleOpcodes.find(mnemonic); it != simpleOpcodes.end()) {
+    instruction.opcode = it->second;
+    instruction.bytes = {it->second};
+    if (instruction.opcode == ACONST_NULL) {
+      instruction.result = VerificationType::of(VerificationType::NULL_TYPE);
+    }
+  } else if (auto it = branchOpcodes.find(mnemonic); it != branchOpcodes.end()) {
+    instruction.opcode = it->second;
+    instruction.bytes = {it->second};
+    instruction.label = operand;
+  } else if (auto it = localOpcodes.find(mnemonic); it != localOpcodes.end()) {
+    int local = std::stoi(operand);
+    if (local < 0 || local > 0xffff) {
+      throw std::runtime_error("Local variable index out of range: " + text);
+    }
+    instruction.opcode = it->second.first;
+    instruction.local = local;
+    if (local <= 3) {
+      instruction.bytes = {static_cast<uint8_t>(it->second.second + local)};
+    } else if (local <= 0xff) {
+      instruction.bytes = {it->second.first, static_cast<uint8_t>(local)};
+    } else {
+      instruction.bytes = {WIDE, it->second.first};
+      putU2(instruction.bytes, static_cast<uint16_t>(local));
+    }
+  } else if (mnemonic == "iconst") {
+    int value = std::stoi(operand);
+    instruction.result = VerificationType::of(VerificationType::INTEGER);
+    if (value >= -1 && value <= 5) {
+      instruction.opcode = static_cast<uint8_t>(ICONST_0 + value);
+      instruction.bytes = {instruction.opcode};
+    } else if (value >= INT8_MIN && value <= INT8_MAX) {
+      instruction.opcode = BIPUSH;
+      instruction.bytes = {BIPUSH, static_cast<uint8_t>(value)};
+    } else if (value >= INT16_MIN && value <= INT16_MAX) {
+      instruction.opcode = SIPUSH;
+      instruction.bytes = {SIPUSH};
+      putU2(instruction.bytes, static_cast<uint16_t>(value));
+    } else {
+      parseLdc(constantPool, instruction, operand);
+    }
+  } else if (mnemonic == "fconst") {
+    float value = std::stof(operand);
+    if (value == 0.0f || value == 1.0f || value == 2.0f) {
+      instruction.opcode = static_cast<uint8_t>(FCONST_0 + static_cast<int>(value));
+      instruction.bytes = {instruction.opcode};
+      instruction.result = VerificationType::of(VerificationType::FLOAT);
+    } else {
+      parseLdc(constantPool, instruction, operand);
+    }
+  } else if (mnemonic == "ldc" || mnemonic == "ldc_w") {
+    parseLdc(constantPool, instruction, operand);
+  } else if (auto it = fieldOpcodes.find(mnemonic); it != fieldOpcodes.end()) {
+    // Owner.name type
+    size_t typeStart = operand.find_first_of(" \t");
+    if (typeStart == std::string::npos) {
+      throw std::runtime_error("Missing field type: " + text);
+    }
+    std::string owner, name;
+    parseMemberReference(operand.substr(0, typeStart), owner, name);
+    std::string descriptor = toFieldDescriptor(operand.substr(typeStart));
+    instruction.opcode = it->second;
+    instruction.bytes = {it->second};
+    putU2(instruction.bytes, constantPool.addFieldRef(owner, name, descriptor));
+    if (instruction.opcode == GETSTATIC || instruction.opcode == GETFIELD) {
+      instruction.result = VerificationType::fromDescriptor(descriptor);
+    } else {
+      instruction.argumentCount = 1;
+    }
+  } else if (auto it = invokeOpcodes.find(mnemonic); it != invokeOpcodes.end()) {
+    // Owner.name(params)return
+    size_t open = operand.find('(');
+    if (open == std::string::npos) {
+      throw std::runtime_error("Missing method type: " + text);
+    }
+    std::string owner, name, returnType;
+    std::vector<std::string> parameterTypes;
+    parseMemberReference(operand.substr(0, open), owner, name);
+    parseMethodType(operand.substr(open), parameterTypes, returnType);
+    instruction.opcode = it->second;
+    instruction.bytes = {it->second};
+    putU2(instruction.bytes,
+          constantPool.addMethodRef(owner, name, toMethodDescriptor(parameterTypes, returnType)));
+    instruction.argumentCount = parameterTypes.size();
+    instruction.memberName = name;
+    if (toFieldDescriptor(returnType) != "V") {
+      instruction.result = VerificationType::fromDescriptor(toFieldDescriptor(returnType));
+    }
+  } else if (mnemonic == "invokedynamic") {
+    // name(params)return { bootstrap method handle[static arguments] }
+    size_t open = operand.find('{');
+    size_t close = operand.rfind('}');
+    if (open == std::string::npos || close == std::string::npos || close < open) {
+      throw std::runtime_error("Missing bootstrap method: " + text);
+    }
+    std::string callSite = trim(operand.substr(0, open));
+    size_t paren = callSite.find('(');
+    std::string returnType;
+    std::vector<std::string> parameterTypes;
+    parseMethodType(callSite, parameterTypes, returnType);
+    instruction.opcode = INVOKEDYNAMIC;
+    instruction.memberName = trim(callSite.substr(0, paren));
+    instruction.descriptor = toMethodDescriptor(parameterTypes, returnType);
+    instruction.bootstrap = trim(operand.substr(open + 1, close - open - 1));
+    instruction.argumentCount = parameterTypes.size();
+    instruction.bytes = {INVOKEDYNAMIC};
+    if (toFieldDescriptor(returnType) != "V") {
+      instruction.result = VerificationType::fromDescriptor(toFieldDescriptor(returnType));
+    }
+  } else if (mnemonic == "new") {
+    std::string className = toClassName(operand);
+    instruction.opcode = NEW;
+    instruction.bytes = {NEW};
+    putU2(instruction.bytes, constantPool.addClass(className));
+    // newInstruction is filled in once we know where this lands
+    instruction.result = VerificationType::of(VerificationType::UNINITIALIZED, className);
+  } else if (mnemonic == "multianewarray") {
+    size_t split = operand.find_last_of(" \t");
+    if (split == std::string::npos) {
+      throw std::runtime_error("Missing dimensions: " + text);
+    }
+    std::string className = toClassName(operand.substr(0, split));
+    int dimensions = std::stoi(operand.substr(split + 1));
+    if (dimensions < 1 || dimensions > 0xff) {
+      throw std::runtime_error("Invalid array dimensions: " + text);
+    }
+    instruction.opcode = MULTIANEWARRAY;
+    instruction.bytes = {MULTIANEWARRAY};
+    putU2(instruction.bytes, constantPool.addClass(className));
+    putU1(instruction.bytes, static_cast<uint8_t>(dimensions));
+    instruction.argumentCount = dimensions;
+    instruction.result = VerificationType::of(VerificationType::OBJECT, className);
+  } else {
+    throw std::runtime_error("Unsupported instruction in class file writer: " + text);
+  }
+  return instruction;
+}
+
+VerificationType pop(Frame& frame, const Instruction& instruction) {
+  if (frame.stack.empty()) {
+    throw std::runtime_error("Stack underflow at: " + instruction.text);
+  }
+  auto value = frame.stack.back();
+  frame.stack.pop_back();
+  return value;
+}
+
+VerificationType arrayElement(const VerificationType& array, const Instruction& instruction) {
+  if (array.tag == VerificationType::NULL_TYPE) {
+    return array;
+  }
+  if (array.tag != VerificationType::OBJECT || array.className.empty() || array.className[0] != '[') {
+    throw std::runtime_error("Expected an array at: " + instruction.text);
+  }
+  return VerificationType::fromDescriptor(array.className.substr(1));
+}
+
+// abstract interpretation of one instruction over the verifier's types
+void execute(const Instruction& instruction, Frame& frame) {
+  auto intType = VerificationType::of(VerificationType::INTEGER);
+  auto floatType = VerificationType::of(VerificationType::FLOAT);
+  uint8_t opcode = instruction.opcode;
+
+  switch (opcode) {
+  case ILOAD:
+  case FLOAD:
+  case ALOAD: {
+    auto value = frame.locals[instruction.local];
+    if (opcode == ALOAD ? !value.isReference() : value.tag == VerificationType::TOP) {
+      throw std::runtime_error("Load of an unassigned local at: " + instruction.text);
+    }
+    frame.stack.push_back(value);
+    return;
+  }
+  case ISTORE:
+  case FSTORE:
+  case ASTORE:
+    frame.locals[instruction.local] = pop(frame, instruction);
+    return;
+  case IALOAD:
+  case BALOAD:
+  case FALOAD:
+  case AALOAD: {
+    pop(frame, instruction);
+    auto array = pop(frame, instruction);
+    frame.stack.push_back(opcode == AALOAD ? arrayElement(array, instruction)
+                                           : (opcode == FALOAD ? floatType : intType));
+    return;
+  }
+  case IASTORE:
+  case FASTORE:
+  case AASTORE:
+  case BASTORE:
+    pop(frame, instruction);
+    pop(frame, instruction);
+    pop(frame, instruction);
+    return;
+  case POP:
+    pop(frame, instruction);
+    return;
+  case DUP: {
+    auto value = pop(frame, instruction);
+    frame.stack.insert(frame.stack.end(), {value, value});
+    return;
+  }
+  case DUP_X1: {
+    auto first = pop(frame, instruction);
+    auto second = pop(frame, instruction);
+    frame.stack.insert(frame.stack.end(), {first, second, first});
+    return;
+  }
+  case DUP_X2: {
+    auto first = pop(frame, instruction);
+    auto second = pop(frame, instruction);
+    auto third = pop(frame, instruction);
+    frame.stack.insert(frame.stack.end(), {first, third, second, first});
+    return;
+  }
+  case SWAP: {
+    auto first = pop(frame, instruction);
+    auto second = pop(frame, instruction);
+    frame.stack.insert(frame.stack.end(), {first, second});
+    return;
+  }
+  case GETFIELD:
+  case PUTFIELD:
+  case GETSTATIC:
+  case PUTSTATIC:
+    for (size_t i = 0; i < instruction.argumentCount; i++) {
+      pop(frame, instruction);
+    }
+    if (opcode == GETFIELD || opcode == PUTFIELD) {
+      pop(frame, instruction);
+    }
+    if (instruction.result) {
+      frame.stack.push_back(*instruction.result);
+    }
+    return;
+  case INVOKEVIRTUAL:
+  case INVOKESPECIAL:
+  case INVOKESTATIC:
+  case INVOKEDYNAMIC: {
+    for (size_t i = 0; i < instruction.argumentCount; i++) {
+      pop(frame, instruction);
+    }
+    if (opcode == INVOKEVIRTUAL || opcode == INVOKESPECIAL) {
+      auto receiver = pop(frame, instruction);
+      // a constructor call initializes every copy of the receiver
+      if (opcode == INVOKESPECIAL && instruction.memberName == "<init>" &&
+          (receiver.tag == VerificationType::UNINITIALIZED || receiver.tag == VerificationType::UNINITIALIZED_THIS)) {
+        auto initialized = VerificationType::of(VerificationType::OBJECT, receiver.className);
+        std::replace(frame.locals.begin(), frame.locals.end(), receiver, initialized);
+        std::replace(frame.stack.begin(), frame.stack.end(), receiver, initialized);
+      }
+    }
+    if (instruction.result) {
+      frame.stack.push_back(*instruction.result);
+    }
+    return;
+  }
+  case MULTIANEWARRAY:
+    for (size_t i = 0; i < instruction.argumentCount; i++) {
+      pop(frame, instruction);
+    }
+    frame.stack.push_back(*instruction.result);
+    return;
+  default:
+    break;
+  }
+
+  // constants, new
+  if (instruction.result) {
+    frame.stack.push_back(*instruction.result);
+    return;
+  }
+  // arithmetic and comparisons, all on ints/floats
+  switch (opcode) {
+  case 0x00: // nop
+  case GOTO:
+  case RETURN:
+    return;
+  case 0x74: // ineg
+  case ARRAYLENGTH:
+  case 0x8b: // f2i
+    pop(frame, instruction);
+    frame.stack.push_back(intType);
+    return;
+  case 0x76: // fneg
+  case 0x86: // i2f
+    pop(frame, instruction);
+    frame.stack.push_back(floatType);
+    return;
+  case 0x62: // fadd
+  case 0x66: // fsub
+  case 0x6a: // fmul
+  case 0x6e: // fdiv
+  case 0x72: // frem
+    pop(frame, instruction);
+    pop(frame, instruction);
+    frame.stack.push_back(floatType);
+    return;
+  case IRETURN:
+  case FRETURN:
+  case ARETURN:
+  case ATHROW:
+  case IFNULL:
+  case IFNONNULL:
+    pop(frame, instruction);
+    return;
+  default:
+    break;
+  }
+  if (opcode >= IFEQ && opcode < IF_ICMPEQ) {
+    pop(frame, instruction);
+  } else if (opcode >= IF_ICMPEQ && opcode <= IF_ACMPNE) {
+    pop(frame, instruction);
+    pop(frame, instruction);
+  } else {
+    // remaining int binary ops and fcmpl/fcmpg
+    pop(frame, instruction);
+    pop(frame, instruction);
+    frame.stack.push_back(intType);
+  }
+}
+
+std::vector<VerificationType> trimLocals(std::vector<VerificationType> locals) {
+  while (!locals.empty() && locals.back().tag == VerificationType::TOP) {
+    locals.pop_back();
+  }
+  return locals;
+}
+
+} // namespace
+
+uint16_t ConstantPool::add(const std::vector<uint8_t>& entry) {
+  // the encoded entry doubles as its own key
+  std::string key(entry.begin(), entry.end());
+  auto it = entries.find(key);
+  if (it != entries.end()) {
+    return it->second;
+  }
+  if (nextIndex == 0xffff) {
+    throw std::runtime_error("Constant pool overflow");
+  }
+  putBytes(data, entry);
+  entries[key] = nextIndex;
+  return nextIndex++;
+}
+
+uint16_t ConstantPool::addUtf8(const std::string& value) {
+  std::string encoded = toModifiedUtf8(value);
+  if (encoded.size() > 0xffff) {
+    throw std::runtime_error("Constant too long for the class file format");
+  }
+  std::vector<uint8_t> entry = {CONSTANT_UTF8};
+  putU2(entry, static_cast<uint16_t>(encoded.size()));
+  entry.insert(entry.end(), encoded.begin(), encoded.end());
+  return add(entry);
+}
+
+uint16_t ConstantPool::addInteger(int32_t value) {
+  std::vector<uint8_t> entry = {CONSTANT_INTEGER};
+  putU4(entry, static_cast<uint32_t>(value));
+  return add(entry);
+}
+
+uint16_t ConstantPool::addFloat(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  std::vector<uint8_t> entry = {CONSTANT_FLOAT};
+  putU4(entry, bits);
+  return add(entry);
+}
+
+uint16_t ConstantPool::addClass(const std::string& name) {
+  std::vector<uint8_t> entry = {CONSTANT_CLASS};
+  putU2(entry, addUtf8(name));
+  return add(entry);
+}
+
+uint16_t ConstantPool::addString(const std::string& value) {
+  std::vector<uint8_t> entry = {CONSTANT_STRING};
+  putU2(entry, addUtf8(value));
+  return add(entry);
+}
+
+uint16_t ConstantPool::addNameAndType(const std::string& name, const std::string& descriptor) {
+  std::vector<uint8_t> entry = {CONSTANT_NAME_AND_TYPE};
+  putU2(entry, addUtf8(name));
+  putU2(entry, addUtf8(descriptor));
+  return add(entry);
+}
+
+uint16_t ConstantPool::addFieldRef(const std::string& owner, const std::string& name, const std::string& descriptor) {
+  std::vector<uint8_t> entry = {CONSTANT_FIELDREF};
+  putU2(entry, addClass(owner));
+  putU2(entry, addNameAndType(name, descriptor));
+  return add(entry);
+}
+
+uint16_t ConstantPool::addMethodRef(const std::string& owner, const std::string& name,
+                                    const std::string& descriptor) {
+  std::vector<uint8_t> entry = {CONSTANT_METHODREF};
+  putU2(entry, addClass(owner));
+  putU2(entry, addNameAndType(name, descriptor));
+  return add(entry);
+}
+
+uint16_t ConstantPool::addMethodHandle(uint8_t referenceKind, uint16_t referenceIndex) {
+  std::vector<uint8_t> entry = {CONSTANT_METHOD_HANDLE, referenceKind};
+  putU2(entry, referenceIndex);
+  return add(entry);
+}
+
+uint16_t ConstantPool::addInvokeDynamic(uint16_t bootstrapMethod, const std::string& name,
+                                        const std::string& descriptor) {
+  std::vector<uint8_t> entry = {CONSTANT_INVOKE_DYNAMIC};
+  putU2(entry, bootstrapMethod);
+  putU2(entry, addNameAndType(name, descriptor));
+  return add(entry);
+}
+
+ClassFileWriter::ClassFileWriter(const std::string& className) : className(className) {
+  thisClass = constantPool.addClass(className);
+  superClass = constantPool.addClass("java/lang/Object");
+}
+
+void ClassFileWriter::addField(const std::string& name, const std::string& type, bool isPrivate) {
+  std::vector<uint8_t> field;
+  putU2(field, isPrivate ? ACC_PRIVATE : ACC_PUBLIC);
+  putU2(field, constantPool.addUtf8(name));
+  putU2(field, constantPool.addUtf8(toFieldDescriptor(type)));
+  putU2(field, 0); // attributes
+  fields.push_back(field);
+}
+
+void ClassFileWriter::addMethod(const std::string& name, const std::vector<std::string>& parameterTypes,
+                                const std::string& returnType, bool isStatic, const std::vector<std::string>& code) {
+  std::vector<uint8_t> codeAttribute;
+  try {
+    codeAttribute = assembleCode(name, parameterTypes, isStatic, code);
+  } catch (const std::exception& e) {
+    throw std::runtime_error("Failed to assemble " + className + "." + name + ": " + e.what());
+  }
+
+  std::vector<uint8_t> method;
+  putU2(method, ACC_PUBLIC | (isStatic ? ACC_STATIC : 0));
+  putU2(method, constantPool.addUtf8(name));
+  putU2(method, constantPool.addUtf8(toMethodDescriptor(parameterTypes, returnType)));
+  putU2(method, 1); // attributes
+  putU2(method, constantPool.addUtf8("Code"));
+  putU4(method, static_cast<uint32_t>(codeAttribute.size()));
+  putBytes(method, codeAttribute);
+  methods.push_back(method);
+}
+
+// "invokestatic Owner.name(params)return[static arguments]"
+uint16_t ClassFileWriter::addBootstrapMethod(const std::string& bootstrap) {
+  size_t space = bootstrap.find_first_of(" \t");
+  auto kind = methodHandleKinds.find(bootstrap.substr(0, space));
+  if (space == std::string::npos || kind == methodHandleKinds.end()) {
+    throw std::runtime_error("Unsupported bootstrap method: " + bootstrap);
+  }
+  std::string handle = trim(bootstrap.substr(space));
+  size_t open = handle.find('(');
+  size_t close = handle.find(')', open);
+  size_t argumentsStart = handle.find('[', close);
+  size_t argumentsEnd = handle.rfind(']');
+  if (open == std::string::npos || close == std::string::npos) {
+    throw std::runtime_error("Malformed bootstrap method: " + bootstrap);
+  }
+
+  std::string owner, name, returnType;
+  std::vector<std::string> parameterTypes;
+  parseMemberReference(handle.substr(0, open), owner, name);
+  std::string methodType = argumentsStart == std::string::npos ? handle.substr(open)
+                                                               : handle.substr(open, argumentsStart - open);
+  parseMethodType(methodType, parameterTypes, returnType);
+  uint16_t methodRef = constantPool.addMethodRef(owner, name, toMethodDescriptor(parameterTypes, returnType));
+
+  std::vector<uint8_t> entry;
+  putU2(entry, constantPool.addMethodHandle(kind->second, methodRef));
+  std::vector<uint16_t> arguments;
+  if (argumentsStart != std::string::npos && argumentsEnd != std::string::npos && argumentsEnd > argumentsStart) {
+    std::string list = handle.substr(argumentsStart + 1, argumentsEnd - argumentsStart - 1);
+    size_t pos = 0;
+    while (pos < list.size()) {
+      if (list[pos] == ',' || list[pos] == ' ' || list[pos] == '\t') {
+        pos++;
+      } else if (list[pos] == '"') {
+        arguments.push_back(constantPool.addString(parseStringLiteral(list, pos)));
+      } else {
+        size_t end = list.find(',', pos);
+        std::string argument = trim(list.substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+        if (argument.find('.') != std::string::npos) {
+          arguments.push_back(constantPool.addFloat(std::stof(argument)));
+        } else {
+          arguments.push_back(constantPool.addInteger(std::stoi(argument)));
+        }
+        pos = end == std::string::npos ? list.size() : end;
+      }
+    }
+  }
+  putU2(entry, static_cast<uint16_t>(arguments.size()));
+  for (auto argument : arguments) {
+    putU2(entry, argument);
+  }
+
+  std::string key(entry.begin(), entry.end());
+  auto it = bootstrapMethodIndices.find(key);
+  if (it != bootstrapMethodIndices.end()) {
+    return it->second;
+  }
+  if (bootstrapMethods.empty()) {
+    bootstrapMethodsName = constantPool.addUtf8("BootstrapMethods");
+  }
+  auto index = static_cast<uint16_t>(bootstrapMethods.size());
+  bootstrapMethods.push_back(entry);
+  bootstrapMethodIndices[key] = index;
+  return index;
+}
+
+std::vector<uint8_t> ClassFileWriter::assembleCode(const std::string& methodName,
+                                                   const std::vector<std::string>& parameterTypes, bool isStatic,
+                                                   const std::vector<std::string>& code) {
+  std::vector<Instruction> instructions;
+  std::unordered_map<std::string, size_t> labels;
+  for (const auto& line : code) {
+    std::string text = trim(line);
+    if (text.empty()) {
+      continue;
+    }
+    if (text.back() == ':') {
+      labels[text.substr(0, text.size() - 1)] = instructions.size();
+      continue;
+    }
+    auto instruction = parseInstruction(constantPool, text);
+    if (instruction.opcode == INVOKEDYNAMIC) {
+      uint16_t bootstrapMethod = addBootstrapMethod(instruction.bootstrap);
+      putU2(instruction.bytes,
+            constantPool.addInvokeDynamic(bootstrapMethod, instruction.memberName, instruction.descriptor));
+      putU2(instruction.bytes, 0);
+    }
+    if (instruction.opcode == NEW) {
+      instruction.result->newInstruction = instructions.size();
+    }
+    instructions.push_back(instruction);
+  }
+  if (instructions.empty()) {
+    throw std::runtime_error("Method has no instructions");
+  }
+
+  // initial frame comes from the descriptor
+  Frame entry;
+  if (!isStatic) {
+    entry.locals.push_back(
+        VerificationType::of(methodName == "<init>" ? VerificationType::UNINITIALIZED_THIS : VerificationType::OBJECT,
+                             className));
+  }
+  for (const auto& parameterType : parameterTypes) {
+    entry.locals.push_back(VerificationType::fromDescriptor(toFieldDescriptor(parameterType)));
+  }
+  size_t maxLocals = entry.locals.size();
+  for (const auto& instruction : instructions) {
+    maxLocals = std::max(maxLocals, static_cast<size_t>(instruction.local + 1));
+  }
+  auto initialLocals = entry.locals;
+  entry.locals.resize(maxLocals);
+
+  std::vector<size_t> targets(instructions.size(), instructions.size());
+  for (size_t i = 0; i < instructions.size(); i++) {
+    if (instructions[i].isBranch()) {
+      auto it = labels.find(instructions[i].label);
+      if (it == labels.end()) {
+        throw std::runtime_error("Undefined label: " + instructions[i].label);
+      }
+      targets[i] = it->second;
+    }
+  }
+
+  // data flow over the verifier's types, this also tells us which instructions are reachable
+  std::vector<std::optional<Frame>> frames(instructions.size());
+  std::vector<bool> isTarget(instructions.size(), false);
+  std::vector<size_t> worklist;
+  size_t maxStack = 0;
+  auto flowInto = [&](size_t index, const Frame& frame) {
+    if (index >= instructions.size()) {
+      throw std::runtime_error("Execution can fall off the end of the method");
+    }
+    if (!frames[index]) {
+      frames[index] = frame;
+      worklist.push_back(index);
+      return;
+    }
+    auto& existing = *frames[index];
+    if (existing.stack.size() != frame.stack.size()) {
+      throw std::runtime_error("Inconsistent stack height at: " + instructions[index].text);
+    }
+    Frame merged = existing;
+    for (size_t i = 0; i < merged.locals.size(); i++) {
+      merged.locals[i] = VerificationType::merge(merged.locals[i], frame.locals[i]);
+    }
+    for (size_t i = 0; i < merged.stack.size(); i++) {
+      merged.stack[i] = VerificationType::merge(merged.stack[i], frame.stack[i]);
+    }
+    if (merged != existing) {
+      existing = merged;
+      worklist.push_back(index);
+    }
+  };
+  flowInto(0, entry);
+  while (!worklist.empty()) {
+    size_t index = worklist.back();
+    worklist.pop_back();
+    const auto& instruction = instructions[index];
+    Frame frame = *frames[index];
+    execute(instruction, frame);
+    maxStack = std::max(maxStack, frame.stack.size());
+    if (instruction.isBranch()) {
+      isTarget[targets[index]] = true;
+      flowInto(targets[index], frame);
+    }
+    if (!instruction.isUnconditional()) {
+      flowInto(index + 1, frame);
+    }
+  }
+
+  // lay out the reachable instructions, unreachable ones (like the redundant trailing return) are dropped
+  // a branch whose offset doesn't fit in 16 bits is widened: goto becomes goto_w, and a conditional branch is
+  // inverted to jump over a goto_w to the target. widening only moves code apart, so repeating until no branch is
+  // widened anymore terminates
+  std::vector<bool> isWide(instructions.size(), false);
+  auto wideSize = [&](size_t i) -> uint32_t { return instructions[i].opcode == GOTO ? 5 : 8; };
+  std::vector<uint32_t> offsets(instructions.size() + 1);
+  auto branchDelta = [&](size_t i) {
+    return static_cast<int64_t>(offsets[targets[i]]) - static_cast<int64_t>(offsets[i]);
+  };
+  for (bool widened = true; widened;) {
+    uint32_t offset = 0;
+    for (size_t i = 0; i < instructions.size(); i++) {
+      offsets[i] = offset;
+      if (frames[i]) {
+        offset += isWide[i] ? wideSize(i) : static_cast<uint32_t>(instructions[i].size());
+      }
+    }
+    offsets[instructions.size()] = offset;
+
+    widened = false;
+    for (size_t i = 0; i < instructions.size(); i++) {
+      if (frames[i] && instructions[i].isBranch() && !isWide[i] &&
+          (branchDelta(i) < INT16_MIN || branchDelta(i) > INT16_MAX)) {
+        isWide[i] = true;
+        widened = true;
+      }
+    }
+  }
+  if (offsets[instructions.size()] > 0xffff) {
+    throw std::runtime_error("Method code too large");
+  }
+
+  std::vector<uint8_t> bytecode;
+  for (size_t i = 0; i < instructions.size(); i++) {
+    if (!frames[i]) {
+      continue;
+    }
+    if (!isWide[i]) {
+      putBytes(bytecode, instructions[i].bytes);
+      if (instructions[i].isBranch()) {
+        putU2(bytecode, static_cast<uint16_t>(branchDelta(i)));
+      }
+      continue;
+    }
+    int64_t delta = branchDelta(i);
+    if (instructions[i].opcode != GOTO) {
+      // the opcodes come in pairs that test opposite conditions: ifeq/ifne, ..., ifnull/ifnonnull
+      uint8_t inverted = instructions[i].opcode == IFNULL || instructions[i].opcode == IFNONNULL
+                             ? static_cast<uint8_t>(instructions[i].opcode ^ 1)
+                             : static_cast<uint8_t>(((instructions[i].opcode - IFEQ) ^ 1) + IFEQ);
+      putU1(bytecode, inverted);
+      putU2(bytecode, 8);
+      // the goto_w's offset is relative to itself
+      delta -= 3;
+      // the jump over the goto_w lands on the next instruction, which needs a frame like any other target
+      isTarget[i + 1] = true;
+    }
+    putU1(bytecode, GOTO_W);
+    putU4(bytecode, static_cast<uint32_t>(static_cast<int32_t>(delta)));
+  }
+
+  auto putType = [&](std::vector<uint8_t>& out, const VerificationType& type) {
+    putU1(out, type.tag);
+    if (type.tag == VerificationType::OBJECT) {
+      putU2(out, constantPool.addClass(type.className));
+    } else if (type.tag == VerificationType::UNINITIALIZED) {
+      putU2(out, static_cast<uint16_t>(offsets[type.newInstruction]));
+    }
+  };
+
+  // one frame per branch target, compressed against the previous frame
+  std::vector<uint8_t> stackMapTable;
+  uint16_t frameCount = 0;
+  auto previousLocals = initialLocals;
+  int64_t previousOffset = -1;
+  for (size_t i = 0; i < instructions.size(); i++) {
+    if (!frames[i] || !isTarget[i]) {
+      continue;
+    }
+    auto locals = trimLocals(frames[i]->locals);
+    const auto& stack = frames[i]->stack;
+    auto delta = static_cast<uint16_t>(offsets[i] - previousOffset - 1);
+    bool sameLocals = locals == previousLocals;
+    size_t common = std::min(locals.size(), previousLocals.size());
+    bool isPrefix = std::equal(locals.begin(), locals.begin() + common, previousLocals.begin());
+
+    if (sameLocals && stack.empty()) {
+      if (delta < 64) {
+        putU1(stackMapTable, static_cast<uint8_t>(delta));
+      } else {
+        putU1(stackMapTable, 251);
+        putU2(stackMapTable, delta);
+      }
+    } else if (sameLocals && stack.size() == 1) {
+      if (delta < 64) {
+        putU1(stackMapTable, static_cast<uint8_t>(64 + delta));
+      } else {
+        putU1(stackMapTable, 247);
+        putU2(stackMapTable, delta);
+      }
+      putType(stackMapTable, stack[0]);
+    } else if (stack.empty() && isPrefix && locals.size() < previousLocals.size() &&
+               previousLocals.size() - locals.size() <= 3) {
+      // chop
+      putU1(stackMapTable, static_cast<uint8_t>(251 - (previousLocals.size() - locals.size())));
+      putU2(stackMapTable, delta);
+    } else if (stack.empty() && isPrefix && locals.size() > previousLocals.size() &&
+               locals.size() - previousLocals.size() <= 3) {
+      // append
+      putU1(stackMapTable, static_cast<uint8_t>(251 + (locals.size() - previousLocals.size())));
+      putU2(stackMapTable, delta);
+      for (size_t j = previousLocals.size(); j < locals.size(); j++) {
+        putType(stackMapTable, locals[j]);
+      }
+    } else {
+      putU1(stackMapTable, 255);
+      putU2(stackMapTable, delta);
+      putU2(stackMapTable, static_cast<uint16_t>(locals.size()));
+      for (const auto& local : locals) {
+        putType(stackMapTable, local);
+      }
+      putU2(stackMapTable, static_cast<uint16_t>(stack.size()));
+      for (const auto& value : stack) {
+        putType(stackMapTable, value);
+      }
+    }
+    frameCount++;
+    previousLocals = locals;
+    previousOffset = offsets[i];
+  }
+
+  std::vector<uint8_t> codeAttribute;
+  putU2(codeAttribute, static_cast<uint16_t>(maxStack));
+  putU2(codeAttribute, static_cast<uint16_t>(maxLocals));
+  putU4(codeAttribute, static_cast<uint32_t>(bytecode.size()));
+  putBytes(codeAttribute, bytecode);
+  putU2(codeAttribute, 0); // exception table
+  if (frameCount == 0) {
+    putU2(codeAttribute, 0);
+    return codeAttribute;
+  }
+  putU2(codeAttribute, 1);
+  putU2(codeAttribute, constantPool.addUtf8("StackMapTable"));
+  putU4(codeAttribute, static_cast<uint32_t>(stackMapTable.size() + 2));
+  putU2(codeAttribute, frameCount);
+  putBytes(codeAttribute, stackMapTable);
+  return codeAttribute;
+}
+
+void ClassFileWriter::write(std::ostream& out) const {
+  std::vector<uint8_t> classFile;
+  putU4(classFile, 0xcafebabe);
+  putU2(classFile, 0); // minor version
+  putU2(classFile, MAJOR_VERSION);
+  putU2(classFile, constantPool.count());
+  putBytes(classFile, constantPool.bytes());
+  putU2(classFile, ACC_PUBLIC | ACC_SUPER);
+  putU2(classFile, thisClass);
+  putU2(classFile, superClass);
+  putU2(classFile, 0); // interfaces
+
+  putU2(classFile, static_cast<uint16_t>(fields.size()));
+  for (const auto& field : fields) {
+    putBytes(classFile, field);
+  }
+  putU2(classFile, static_cast<uint16_t>(methods.size()));
+  for (const auto& method : methods) {
+    putBytes(classFile, method);
+  }
+
+  if (bootstrapMethods.empty()) {
+    putU2(classFile, 0);
+  } else {
+    std::vector<uint8_t> attribute;
+    putU2(attribute, static_cast<uint16_t>(bootstrapMethods.size()));
+    for (const auto& bootstrapMethod : bootstrapMethods) {
+      putBytes(attribute, bootstrapMethod);
+    }
+    putU2(classFile, 1);
+    putU2(classFile, bootstrapMethodsName);
+    putU4(classFile, static_cast<uint32_t>(attribute.size()));
+    putBytes(classFile, attribute);
+  }
+
+  out.write(reinterpret_cast<const char*>(classFile.data()), static_cast<std::streamsize>(classFile.size()));
+}
@@ -0,0 +1,63 @@
+#ifndef CLASS_FILE_WRITER_H
+#define CLASS_FILE_WRITER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ConstantPool {
+public:
+  uint16_t addUtf8(const std::string& value);
+  uint16_t addInteger(int32_t value);
+  uint16_t addFloat(float value);
+  uint16_t addClass(const std::string& name);
+  uint16_t addString(const std::string& value);
+  uint16_t addNameAndType(const std::string& name, const std::string& descriptor);
+  uint16_t addFieldRef(const std::string& owner, const std::string& name, const std::string& descriptor);
+  uint16_t addMethodRef(const std::string& owner, const std::string& name, const std::string& descriptor);
+  uint16_t addMethodHandle(uint8_t referenceKind, uint16_t referenceIndex);
+  uint16_t addInvokeDynamic(uint16_t bootstrapMethod, const std::string& name, const std::string& descriptor);
+
+  // constant_pool_count, one more than the number of entries
+  uint16_t count() const { return nextIndex; }
+  const std::vector<uint8_t>& bytes() const { return data; }
+
+private:
+  uint16_t add(const std::vector<uint8_t>& entry);
+
+  std::vector<uint8_t> data;
+  std::unordered_map<std::string, uint16_t> entries;
+  uint16_t nextIndex = 1;
+};
+
+// assembles the same instruction text we emit as jasm straight into a .class file
+// types are written the jasm way too (I, F, Z, V, java/lang/String, [I, ...)
+class ClassFileWriter {
+public:
+  explicit ClassFileWriter(const std::string& className);
+
+  void addField(const std::string& name, const std::string& type, bool isPrivate);
+  // code is one instruction or "label:" per entry
+  void addMethod(const std::string& name, const std::vector<std::string>& parameterTypes,
+                 const std::string& returnType, bool isStatic, const std::vector<std::string>& code);
+  void write(std::ostream& out) const;
+
+private:
+  std::string className;
+  ConstantPool constantPool;
+  uint16_t thisClass;
+  uint16_t superClass;
+  std::vector<std::vector<uint8_t>> fields;
+  std::vector<std::vector<uint8_t>> methods;
+  std::vector<std::vector<uint8_t>> bootstrapMethods;
+  std::unordered_map<std::string, uint16_t> bootstrapMethodIndices;
+  uint16_t bootstrapMethodsName = 0;
+
+  std::vector<uint8_t> assembleCode(const std::string& methodName, const std::vector<std::string>& parameterTypes,
+                                    bool isStatic, const std::vector<std::string>& code);
+  uint16_t addBootstrapMethod(const std::string& bootstrap);
+};
+
+#endif // CLASS_FILE_WRITER_H
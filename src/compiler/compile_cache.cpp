@@ -0,0 +1,412 @@
+#include "compile_cache.h"
+#include "bytecode_compiler.h"
+#include "sha256.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#elif defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// bump when the entry layout changes
+const char* CACHE_FORMAT = "cgull-cache 2";
+
+// the running executable, empty if the platform won't tell
+fs::path executablePath() {
+#ifdef __APPLE__
+  uint32_t size = 0;
+  _NSGetExecutablePath(nullptr, &size);
+  std::string path(size, '\0');
+  if (_NSGetExecutablePath(path.data(), &size) != 0) {
+    return {};
+  }
+  path.resize(std::char_traits<char>::length(path.c_str()));
+  std::error_code error;
+  fs::path resolved = fs::canonical(path, error);
+  return error ? fs::path(path) : resolved;
+#elif defined(_WIN32)
+  wchar_t path[32768];
+  DWORD length = GetModuleFileNameW(nullptr, path, static_cast<DWORD>(std::size(path)));
+  if (length == 0 || length == std::size(path)) {
+    return {};
+  }
+  return fs::path(std::wstring(path, length));
+#else
+  std::error_code error;
+  fs::path path = fs::read_symlink("/proc/self/exe", error);
+  return error ? fs::path() : path;
+#endif
+}
+
+// the version alone isn't bumped for every change, so the executable's size and mtime are mixed in too
+// and a rebuilt compiler never reuses entries from an older build
+const std::string& compilerIdentity() {
+  static const std::string identity = [] {
+    std::string result = CGULL_VERSION;
+    std::error_code sizeError;
+    std::error_code timeError;
+    fs::path executable = executablePath();
+    if (!executable.empty()) {
+      uintmax_t size = fs::file_size(executable, sizeError);
+      auto modified = fs::last_write_time(executable, timeError);
+      if (!sizeError && !timeError) {
+        result += " " + std::to_string(size) + " " + std::to_string(modified.time_since_epoch().count());
+      }
+    }
+    return result;
+  }();
+  return identity;
+}
+
+bool readFile(const fs::path& path, std::string& contents) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  contents = buffer.str();
+  return true;
+}
+
+void writeFile(const fs::path& path, const std::string& contents) {
+  std::ofstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open cache file: " + path.string());
+  }
+  file << contents;
+}
+
+uintmax_t directorySize(const fs::path& path) {
+  uintmax_t total = 0;
+  std::error_code error;
+  for (const auto& entry : fs::recursive_directory_iterator(path, error)) {
+    if (entry.is_regular_file(error)) {
+      total += entry.file_size(error);
+    }
+  }
+  return total;
+}
+
+// unique per thread and call, so concurrent stores never share a staging directory
+std::string uniqueSuffix() {
+  std::ostringstream suffix;
+  suffix << ".tmp." << std::hash<std::thread::id>()(std::this_thread::get_id()) << "."
+         << std::chrono::steady_clock::now().time_since_epoch().count();
+  return suffix.str();
+}
+
+bool isTemporary(const fs::path& path) { return path.filename().string().find(".tmp") != std::string::npos; }
+
+// mutex between processes sharing the cache directory: creating a directory either succeeds for exactly one of
+// them or fails, on every platform. a lock left behind by a crashed process is taken over once it's stale
+class DirectoryLock {
+public:
+  explicit DirectoryLock(fs::path lockPath) : path(std::move(lockPath)) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    for (;;) {
+      std::error_code error;
+      if (fs::create_directory(path, error)) {
+        held = true;
+        return;
+      }
+      auto created = fs::last_write_time(path, error);
+      if (!error && fs::file_time_type::clock::now() - created > std::chrono::seconds(30)) {
+        fs::remove(path, error);
+        continue;
+      }
+      if (std::chrono::steady_clock::now() > deadline) {
+        return;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  ~DirectoryLock() {
+    if (held) {
+      std::error_code error;
+      fs::remove(path, error);
+    }
+  }
+  DirectoryLock(const DirectoryLock&) = delete;
+  DirectoryLock& operator=(const DirectoryLock&) = delete;
+
+  bool isHeld() const { return held; }
+
+private:
+  fs::path path;
+  bool held = false;
+};
+
+} // namespace
+
+CompileCache::CompileCache(const std::string& directory, uintmax_t maxBytes)
+    : directory(directory), maxBytes(maxBytes) {
+  std::error_code error;
+  fs::create_directories(directory, error);
+}
+
+CompileCache::~CompileCache() {
+  // read, add and write back under the lock, so processes finishing together don't lose each other's counts
+  DirectoryLock lock(fs::path(directory) / "lock.tmp");
+  if (!lock.isHeld()) {
+    return; // the counters aren't worth waiting longer for
+  }
+  Stats totals = readStatsFile();
+  totals.hits += stats.hits;
+  totals.misses += stats.misses;
+  totals.stores += stats.stores;
+  totals.evictions += stats.evictions;
+
+  std::ostringstream contents;
+  contents << "hits " << totals.hits << "\nmisses " << totals.misses << "\nstores " << totals.stores
+           << "\nevictions " << totals.evictions << "\n";
+  try {
+    fs::path staging = fs::path(directory) / ("stats" + uniqueSuffix());
+    writeFile(staging, contents.str());
+    fs::rename(staging, fs::path(directory) / "stats");
+  } catch (const std::exception&) {
+    // losing the counters isn't worth failing the compile over
+  }
+}
+
+std::string CompileCache::makeKey(std::string_view source, const std::string& flags) {
+  // the header ends at the blank line and the source can't change where, so no two inputs hash the same text
+  Sha256 digest;
+  digest.update(CACHE_FORMAT);
+  digest.update("\ncompiler " + compilerIdentity());
+  digest.update("\nflags " + flags);
+  digest.update("\nsource-length " + std::to_string(source.size()) + "\n\n");
+  digest.update(source);
+  return digest.hexDigest();
+}
+
+std::string CompileCache::entryPath(const std::string& key) const { return (fs::path(directory) / key).string(); }
+
+bool CompileCache::restore(const std::string& key, const std::string& outputDir,
+                           std::vector<std::string>& outputPaths) {
+  fs::path entry = entryPath(key);
+  std::string storedKey;
+  std::string manifest;
+  bool hit = readFile(entry / "key", storedKey) && storedKey == key && readFile(entry / "manifest", manifest);
+
+  if (hit) {
+    try {
+      BytecodeCompiler::prepareOutputDirectory(outputDir);
+      std::vector<std::string> restored;
+      std::istringstream names(manifest);
+      std::string name;
+      while (std::getline(names, name)) {
+        std::string target = outputDir + "/" + name;
+        fs::copy_file(entry / "files" / name, target, fs::copy_options::overwrite_existing);
+        restored.push_back(target);
+      }
+      // mark as recently used for eviction
+      fs::last_write_time(entry / "key", fs::file_time_type::clock::now());
+      outputPaths = restored;
+    } catch (const std::exception&) {
+      // evicted underneath us, the normal compile rewrites the output directory anyway
+      hit = false;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (hit) {
+    stats.hits++;
+  } else {
+    stats.misses++;
+  }
+  return hit;
+}
+
+void CompileCache::store(const std::string& key, const std::vector<std::string>& outputPaths) {
+  fs::path entry = entryPath(key);
+  // an entry named after the same digest holds the same files, another thread or process got there first
+  std::error_code existsError;
+  if (fs::exists(entry / "key", existsError)) {
+    return;
+  }
+
+  fs::path staging = entry.string() + uniqueSuffix();
+  uintmax_t entrySize = 0;
+  try {
+    fs::create_directories(staging / "files");
+    std::string manifest;
+    for (const auto& path : outputPaths) {
+      std::string name = fs::path(path).filename().string();
+      fs::copy_file(path, staging / "files" / name);
+      entrySize += fs::file_size(staging / "files" / name);
+      manifest += name + "\n";
+    }
+    writeFile(staging / "manifest", manifest);
+    // written last, an entry without a matching key is never used
+    writeFile(staging / "key", key);
+    entrySize += manifest.size() + key.size();
+
+    // replace a half removed entry, or lose the race to another thread storing the same program
+    std::error_code error;
+    fs::remove_all(entry, error);
+    fs::rename(staging, entry, error);
+    if (error) {
+      fs::remove_all(staging, error);
+      return;
+    }
+  } catch (const std::exception&) {
+    std::error_code error;
+    fs::remove_all(staging, error);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.stores++;
+  }
+
+  // the running total is kept in the size file, the entries are only listed and sized once it's over the limit
+  // (or missing, for a new cache)
+  DirectoryLock lock(fs::path(directory) / "lock.tmp");
+  if (!lock.isHeld()) {
+    return; // the total is low by this entry until the next scan
+  }
+  uintmax_t total = 0;
+  if (!readSizeFile(total) || (total += entrySize) > maxBytes) {
+    total = evict();
+  }
+  writeSizeFile(total);
+}
+
+uintmax_t CompileCache::evict() {
+  struct Entry {
+    fs::path path;
+    fs::file_time_type lastUsed;
+    uintmax_t size;
+  };
+
+  std::vector<Entry> entries;
+  uintmax_t total = 0;
+  std::error_code error;
+  for (const auto& item : fs::directory_iterator(directory, error)) {
+    if (!item.is_directory(error) || isTemporary(item.path())) {
+      continue;
+    }
+    auto lastUsed = fs::last_write_time(item.path() / "key", error);
+    if (error) {
+      // half written or half removed by someone else
+      continue;
+    }
+    uintmax_t size = directorySize(item.path());
+    entries.push_back({item.path(), lastUsed, size});
+    total += size;
+  }
+  if (total <= maxBytes) {
+    return total;
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+  uint64_t evicted = 0;
+  for (const auto& entry : entries) {
+    if (total <= maxBytes) {
+      break;
+    }
+    fs::remove_all(entry.path, error);
+    total -= entry.size;
+    evicted++;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  stats.evictions += evicted;
+  return total;
+}
+
+bool CompileCache::readSizeFile(uintmax_t& total) const {
+  std::string contents;
+  if (!readFile(fs::path(directory) / "size", contents)) {
+    return false;
+  }
+  std::istringstream value(contents);
+  return static_cast<bool>(value >> total);
+}
+
+void CompileCache::writeSizeFile(uintmax_t total) const {
+  try {
+    fs::path staging = fs::path(directory) / ("size" + uniqueSuffix());
+    writeFile(staging, std::to_string(total) + "\n");
+    fs::rename(staging, fs::path(directory) / "size");
+  } catch (const std::exception&) {
+    // the next store without a size file scans the entries again
+  }
+}
+
+CompileCache::Stats CompileCache::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+CompileCache::Stats CompileCache::readStatsFile() const {
+  Stats totals;
+  std::string contents;
+  if (!readFile(fs::path(directory) / "stats", contents)) {
+    return totals;
+  }
+  std::istringstream lines(contents);
+  std::string name;
+  uint64_t value;
+  while (lines >> name >> value) {
+    if (name == "hits") {
+      totals.hits = value;
+    } else if (name == "misses") {
+      totals.misses = value;
+    } else if (name == "stores") {
+      totals.stores = value;
+    } else if (name == "evictions") {
+      totals.evictions = value;
+    }
+  }
+  return totals;
+}
+
+CompileCache::Stats CompileCache::getTotalStats() const {
+  Stats totals = readStatsFile();
+  Stats current = getStats();
+  totals.hits += current.hits;
+  totals.misses += current.misses;
+  totals.stores += current.stores;
+  totals.evictions += current.evictions;
+  return totals;
+}
+
+uintmax_t CompileCache::getSizeBytes() const {
+  uintmax_t total = 0;
+  std::error_code error;
+  for (const auto& item : fs::directory_iterator(directory, error)) {
+    if (item.is_directory(error) && !isTemporary(item.path())) {
+      total += directorySize(item.path());
+    }
+  }
+  return total;
+}
+
+size_t CompileCache::getEntryCount() const {
+  size_t count = 0;
+  std::error_code error;
+  for (const auto& item : fs::directory_iterator(directory, error)) {
+    if (item.is_directory(error) && !isTemporary(item.path())) {
+      count++;
+    }
+  }
+  return count;
+}
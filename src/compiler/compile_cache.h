@@ -0,0 +1,65 @@
+#ifndef COMPILE_CACHE_H
+#define COMPILE_CACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef CGULL_VERSION
+#define CGULL_VERSION "dev"
+#endif
+
+// on-disk cache of generated class files, keyed by a sha-256 digest of the source bytes, the compiler build and the
+// output format. a hit restores the files into the output directory without lexing, parsing or analyzing the program
+//
+// every entry is a directory named after the digest, holding the digest again (written last, so a half written
+// entry is a miss) and a copy of the generated files, never the source. the key file's mtime is the last use, and
+// the least recently used entries are evicted once the running total in the size file grows past the size limit
+// safe to share between threads, and between processes using the same directory (the shared stats and size files
+// are only updated under a lock directory in the cache)
+class CompileCache {
+public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t evictions = 0;
+  };
+
+  CompileCache(const std::string& directory, uintmax_t maxBytes);
+  // adds this process's counters to the totals kept in the cache directory
+  ~CompileCache();
+
+  // copies the cached files for this key into outputDir, returns false on a miss
+  bool restore(const std::string& key, const std::string& outputDir, std::vector<std::string>& outputPaths);
+  // caches the files a successful compile wrote, then evicts old entries if needed
+  void store(const std::string& key, const std::vector<std::string>& outputPaths);
+
+  // digest of everything that changes the generated files for a given source, as hex
+  static std::string makeKey(std::string_view source, const std::string& flags);
+
+  Stats getStats() const;
+  // totals over every process that used the cache directory, including this one
+  Stats getTotalStats() const;
+  uintmax_t getSizeBytes() const;
+  size_t getEntryCount() const;
+
+private:
+  std::string directory;
+  uintmax_t maxBytes;
+  mutable std::mutex mutex;
+  Stats stats;
+
+  std::string entryPath(const std::string& key) const;
+  Stats readStatsFile() const;
+  // the total size of the entries as of the last store, false if there's no size file yet
+  bool readSizeFile(uintmax_t& total) const;
+  void writeSizeFile(uintmax_t total) const;
+  // lists and sizes every entry, removes the least recently used ones while over maxBytes and returns the total
+  // after that. called with the lock held
+  uintmax_t evict();
+};
+
+#endif // COMPILE_CACHE_H
@@ -0,0 +1,332 @@
+#include "compile_driver.h"
+#include "input/arena_token_factory.h"
+#include "input/native_lexer.h"
+#include "input/utf8_char_stream.h"
+#include "listeners/collecting_error_listener.h"
+#include "parallel_parser.h"
+#include "semantic_analyzer.h"
+#include <antlr4-runtime.h>
+#include <atomic>
+#include <charconv>
+#include <cgullLexer.h>
+#include <cgullParser.h>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+std::atomic<uint64_t> totalParses{0};
+std::atomic<uint64_t> totalLLFallbacks{0};
+
+void printTokens(std::ostream& out, const antlr4::dfa::Vocabulary& vocabulary, antlr4::CommonTokenStream& tokens) {
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    auto token = tokens.get(i);
+    std::string tokenName = std::string(vocabulary.getSymbolicName(token->getType()));
+    out << "Token: " << tokenName << ", Text: '" << token->getText() << "'"
+        << ", Start: " << token->getStartIndex() << ", End: " << token->getStopIndex()
+        << ", Line: " << token->getLine() << std::endl;
+  }
+}
+
+void printErrors(std::ostream& err, const std::string& label, const CollectingErrorListener& listener) {
+  if (!listener.errors.empty()) {
+    err << "\n" << label << " errors:\n";
+    for (const auto& error : listener.errors) {
+      err << error << std::endl;
+    }
+    err << label << " failed with " << listener.errors.size() << " errors." << std::endl;
+  }
+}
+
+void printGeneratedFiles(std::ostream& out, const CompileResult& result, const CompileOptions& options) {
+  for (const auto& path : result.outputPaths) {
+    out << "Generated class file: " << path << std::endl;
+  }
+  out << "Bytecode written to " << options.outputDir << " directory" << std::endl;
+  out << "Compilation completed successfully!" << std::endl;
+}
+
+bool hasAnyErrors(const CollectingErrorListener& lexerListener, const CollectingErrorListener& parserListener) {
+  return !lexerListener.errors.empty() || !parserListener.errors.empty();
+}
+
+// SLL prediction is much cheaper and enough for nearly every valid program, so try it first with a strategy that
+// gives up at the first syntax error, and only reparse with full LL and real error reporting when it does
+// large programs get their SLL attempt split over several threads
+cgullParser::ProgramContext* parseProgram(cgullParser& parser, ParallelParser& parallelParser,
+                                          CollectingErrorListener& errorListener, PassTimer* timer) {
+  auto* interpreter = parser.getInterpreter<antlr4::atn::ParserATNSimulator>();
+  cgullParser::ProgramContext* tree = nullptr;
+  totalParses++;
+  // errors only go to errorListener, never to antlr's console listener, which would bypass the err stream
+  parser.removeErrorListeners();
+  if (parallelParser.canSplit()) {
+    PassTimer::Pass sllPass(timer, "sll (parallel)");
+    tree = parallelParser.parse(timer);
+  } else {
+    PassTimer::Pass sllPass(timer, "sll");
+    interpreter->setPredictionMode(antlr4::atn::PredictionMode::SLL);
+    parser.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+    try {
+      tree = parser.program();
+    } catch (const antlr4::ParseCancellationException&) {
+      tree = nullptr;
+    }
+  }
+  if (timer != nullptr) {
+    timer->addCount("ll fallbacks", tree == nullptr ? 1 : 0);
+  }
+  if (tree != nullptr) {
+    return tree;
+  }
+
+  totalLLFallbacks++;
+  PassTimer::Pass llPass(timer, "ll fallback");
+  // also rewinds the token stream
+  parser.reset();
+  parser.addErrorListener(&errorListener);
+  parser.setErrorHandler(std::make_shared<antlr4::DefaultErrorStrategy>());
+  interpreter->setPredictionMode(antlr4::atn::PredictionMode::LL);
+  return parser.program();
+}
+
+} // namespace
+
+bool parseCountFlag(const std::string& text, uint64_t& value) {
+  const char* end = text.data() + text.size();
+  auto [last, status] = std::from_chars(text.data(), end, value);
+  return !text.empty() && status == std::errc() && last == end;
+}
+
+bool applyCompileFlag(const std::vector<std::string>& args, size_t& index, CompileOptions& options,
+                      std::string& error) {
+  const std::string& arg = args[index];
+  // the thread counts, checked before they're applied
+  auto parseJobs = [&](unsigned& jobs) {
+    uint64_t value = 0;
+    if (!parseCountFlag(args[++index], value) || value > std::numeric_limits<unsigned>::max()) {
+      error = "Invalid value for " + arg + ": " + args[index];
+      return false;
+    }
+    jobs = static_cast<unsigned>(value);
+    return true;
+  };
+  if (arg == "--lexer") {
+    options.stopStage = LEXING;
+  } else if (arg == "--parser") {
+    options.stopStage = PARSING;
+  } else if (arg == "--semantic") {
+    options.stopStage = SEMANTIC_ANALYSIS;
+  } else if (arg == "--semantic=compact") {
+    options.stopStage = SEMANTIC_ANALYSIS;
+    options.compactJson = true;
+  } else if (arg == "--jasm") {
+    // debug output, write .jasm text instead of .class files
+    options.outputFormat = BytecodeCompiler::OutputFormat::JASM;
+  } else if (arg == "--parse-jobs" && index + 1 < args.size()) {
+    return parseJobs(options.parseJobs);
+  } else if (arg == "--check-jobs" && index + 1 < args.size()) {
+    return parseJobs(options.checkJobs);
+  } else if (arg == "--pipeline") {
+    options.pipeline = true;
+  } else if (arg == "--antlr-lexer") {
+    options.antlrLexer = true;
+  } else if (arg == "--time-passes") {
+    options.timePasses = TimePassesFormat::TABLE;
+  } else if (arg == "--time-passes=json") {
+    options.timePasses = TimePassesFormat::JSON;
+  } else if (arg == "--out-dir" && index + 1 < args.size()) {
+    options.outputDir = args[++index];
+  } else {
+    return false;
+  }
+  return true;
+}
+
+namespace {
+
+// the whole pipeline, timer is null unless --time-passes is on
+CompileResult runPipeline(std::string_view source, const CompileOptions& options, std::ostream& out,
+                          std::ostream& err, PassTimer* timer) {
+  CompileResult result;
+
+  // only the generated files are cached, the stage outputs are for debugging anyway
+  std::string cacheKey;
+  if (options.cache != nullptr && options.stopStage == NONE) {
+    PassTimer::Pass cacheLookupPass(timer, "cache lookup");
+    bool isJasm = options.outputFormat == BytecodeCompiler::OutputFormat::JASM;
+    cacheKey = CompileCache::makeKey(source, isJasm ? "--jasm" : "");
+    if (options.cache->restore(cacheKey, options.outputDir, result.outputPaths)) {
+      out << "Source unchanged, restored " << result.outputPaths.size() << " files from the compile cache" << std::endl;
+      printGeneratedFiles(out, result, options);
+      return result;
+    }
+  }
+
+  PassTimer::Pass lexingPass(timer, "lexing");
+  // tokens live in this arena until the whole compile is done, declared first so it's destroyed last
+  Arena tokenArena;
+  // identifiers are interned while lexing, semantic analysis looks names up by these atoms
+  auto atoms = std::make_shared<AtomTable>();
+  ArenaTokenFactory tokenFactory(tokenArena, atoms.get());
+
+  // code points come straight from the source bytes, and token text is sliced from them on demand
+  Utf8CharStream input(source);
+  CollectingErrorListener lexerErrorListener;
+
+  // the hand written lexer makes the same tokens without the ATN simulation, but only for ascii sources
+  std::unique_ptr<antlr4::TokenSource> lexer;
+  if (!options.antlrLexer && input.isAscii()) {
+    auto nativeLexer = std::make_unique<NativeLexer>(&input, source);
+    nativeLexer->setTokenFactory(&tokenFactory);
+    nativeLexer->setErrorListener(&lexerErrorListener);
+    lexer = std::move(nativeLexer);
+  } else {
+    auto antlrLexer = std::make_unique<cgullLexer>(&input);
+    antlrLexer->setTokenFactory(&tokenFactory);
+    antlrLexer->removeErrorListeners();
+    antlrLexer->addErrorListener(&lexerErrorListener);
+    lexer = std::move(antlrLexer);
+  }
+
+  antlr4::CommonTokenStream tokens(lexer.get());
+  tokens.fill();
+  lexingPass.stop();
+
+  if (options.stopStage == LEXING) {
+    printTokens(out, NativeLexer::getVocabulary(), tokens);
+    printErrors(err, "Lexer", lexerErrorListener);
+    if (!lexerErrorListener.errors.empty()) {
+      result.exitCode = 1;
+      return result;
+    }
+    out << "Lexing completed successfully!" << std::endl;
+    return result;
+  }
+
+  PassTimer::Pass parsingPass(timer, "parsing");
+  cgullParser parser(&tokens);
+  // owns the tree when the program was parsed in chunks
+  ParallelParser parallelParser(tokens, options.parseJobs);
+
+  CollectingErrorListener parserErrorListener;
+  cgullParser::ProgramContext* tree = parseProgram(parser, parallelParser, parserErrorListener, timer);
+  parsingPass.stop();
+
+  if (options.stopStage == PARSING) {
+    out << "Parse tree: \n" << tree->toStringTree(&parser, true) << std::endl;
+    printErrors(err, "Lexer", lexerErrorListener);
+    printErrors(err, "Parser", parserErrorListener);
+    if (hasAnyErrors(lexerErrorListener, parserErrorListener)) {
+      err << "Lexing and/or parsing failed with errors." << std::endl;
+      result.exitCode = 1;
+      return result;
+    }
+    out << "Parsing completed successfully!" << std::endl;
+    return result;
+  }
+
+  printErrors(err, "Lexer", lexerErrorListener);
+  printErrors(err, "Parser", parserErrorListener);
+
+  if (hasAnyErrors(lexerErrorListener, parserErrorListener)) {
+    err << "Lexing and/or parsing failed with errors. Semantic analysis will not be performed." << std::endl;
+    result.exitCode = 1;
+    return result;
+  }
+
+  PassTimer::Pass semanticPass(timer, "semantic analysis");
+  SemanticAnalyzer semanticAnalyzer(atoms);
+  semanticAnalyzer.analyze(tree, timer, options.checkJobs);
+  semanticPass.stop();
+
+  if (options.stopStage == SEMANTIC_ANALYSIS) {
+    semanticAnalyzer.printSymbolsAsJson(out, options.compactJson);
+    if (semanticAnalyzer.getErrorReporter().hasErrors()) {
+      err << "Semantic analysis failed with errors." << std::endl;
+      semanticAnalyzer.getErrorReporter().displayErrors(err);
+      result.exitCode = 1;
+      return result;
+    }
+    out << "Semantic analysis completed successfully!" << std::endl;
+    return result;
+  }
+
+  semanticAnalyzer.getErrorReporter().displayErrors(err);
+
+  // dont continue if there are any errors
+  if (semanticAnalyzer.getErrorReporter().hasErrors()) {
+    err << "Semantic analysis failed with errors. Bytecode generation will not be performed." << std::endl;
+    result.exitCode = 1;
+    return result;
+  }
+
+  try {
+    BytecodeCompiler compiler(semanticAnalyzer.getResult());
+    if (options.pipeline) {
+      // code generation only reads the analysis result
+      semanticAnalyzer.releaseFrontEndTables();
+      PassTimer::Pass pipelinePass(timer, "ir generation, bytecode emission");
+      // a program parsed in chunks gives each chunk's subtree back once code generation has moved past it
+      result.outputPaths = compiler.compileAndEmit(options.outputDir, options.outputFormat, [&](size_t statementIndex) {
+        parallelParser.releaseStatementsThrough(statementIndex);
+      });
+    } else {
+      PassTimer::Pass irPass(timer, "ir generation");
+      compiler.compile();
+    }
+
+    if (compiler.getErrorReporter().hasErrors()) {
+      err << "Bytecode generation failed with errors." << std::endl;
+      compiler.getErrorReporter().displayErrors(err);
+      result.exitCode = 1;
+      return result;
+    }
+    out << "Bytecode generation completed successfully!" << std::endl;
+
+    if (!options.pipeline) {
+      PassTimer::Pass emissionPass(timer, "bytecode emission");
+      result.outputPaths = compiler.generateBytecode(options.outputDir, options.outputFormat);
+    }
+  } catch (const std::exception& e) {
+    err << "Bytecode generation failed: " << e.what() << std::endl;
+    result.exitCode = 1;
+    return result;
+  }
+  if (!cacheKey.empty()) {
+    PassTimer::Pass cacheStorePass(timer, "cache store");
+    options.cache->store(cacheKey, result.outputPaths);
+  }
+  printGeneratedFiles(out, result, options);
+
+  return result;
+}
+
+} // namespace
+
+ParseStats getParseStats() {
+  ParseStats stats;
+  stats.parses = totalParses;
+  stats.llFallbacks = totalLLFallbacks;
+  return stats;
+}
+
+CompileResult compileSource(std::string_view source, const CompileOptions& options, std::ostream& out,
+                            std::ostream& err) {
+  if (options.timePasses == TimePassesFormat::NONE) {
+    return runPipeline(source, options, out, err, nullptr);
+  }
+
+  PassTimer timer;
+  CompileResult result;
+  {
+    PassTimer::Pass totalPass(&timer, "total");
+    result = runPipeline(source, options, out, err, &timer);
+  }
+  if (options.timePasses == TimePassesFormat::JSON) {
+    timer.printJson(err);
+  } else {
+    timer.printTable(err);
+  }
+  return result;
+}
@@ -0,0 +1,74 @@
+#ifndef COMPILE_DRIVER_H
+#define COMPILE_DRIVER_H
+
+#include "bytecode_compiler.h"
+#include "compile_cache.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum StopStage {
+  NONE,
+  LEXING,
+  PARSING,
+  SEMANTIC_ANALYSIS,
+};
+
+enum class TimePassesFormat {
+  NONE,
+  TABLE,
+  JSON,
+};
+
+struct CompileOptions {
+  StopStage stopStage = NONE;
+  // --semantic=compact, the symbol table is printed on one line instead of indented
+  bool compactJson = false;
+  // --time-passes, the report is printed to err after the compile
+  TimePassesFormat timePasses = TimePassesFormat::NONE;
+  // --antlr-lexer, always use the generated lexer instead of the hand written one
+  bool antlrLexer = false;
+  // --parse-jobs, threads parsing chunks of large programs, 0 for one per core and 1 to always parse serially
+  unsigned parseJobs = 0;
+  // --check-jobs, threads type checking the functions of large programs, 0 for one per core and 1 for serial
+  unsigned checkJobs = 0;
+  // --pipeline, each class is written and its IR freed as soon as it is complete instead of after the whole program
+  bool pipeline = false;
+  BytecodeCompiler::OutputFormat outputFormat = BytecodeCompiler::OutputFormat::CLASS_FILE;
+  std::string outputDir = "out";
+  // full compiles are looked up in and stored to this cache when set, not owned
+  CompileCache* cache = nullptr;
+};
+
+struct ParseStats {
+  uint64_t parses = 0;
+  // parses where SLL prediction failed and the program was parsed again with full LL
+  uint64_t llFallbacks = 0;
+};
+
+struct CompileResult {
+  int exitCode = 0;
+  std::vector<std::string> outputPaths;
+};
+
+// runs one program through the whole pipeline, printing to out/err instead of the console
+// source isn't copied, it has to stay alive until this returns
+// only read-only state (builtins, the antlr DFA cache) is shared between calls, so separate programs
+// can be compiled on separate threads
+CompileResult compileSource(std::string_view source, const CompileOptions& options, std::ostream& out,
+                            std::ostream& err);
+
+// applies the flag at args[index] to options, consuming its value if it takes one
+// returns false if it isn't a compile flag, or if its value is invalid, which is described in error
+bool applyCompileFlag(const std::vector<std::string>& args, size_t& index, CompileOptions& options,
+                      std::string& error);
+
+// parses a flag value that has to be a non-negative decimal number, false for anything else
+bool parseCountFlag(const std::string& text, uint64_t& value);
+
+// totals over every compile in this process
+ParseStats getParseStats();
+
+#endif // COMPILE_DRIVER_H
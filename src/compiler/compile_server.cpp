@@ -0,0 +1,349 @@
+#include "compile_server.h"
+#include "compile_driver.h"
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+// requests are served one at a time, so a client that stalls or sends without end would hold up every other one
+constexpr uint64_t MAX_REQUEST_BYTES = 64 * 1024 * 1024;
+constexpr int RECEIVE_TIMEOUT_SECONDS = 10;
+
+void handleStopSignal(int) { stopRequested = 1; }
+
+// small program touching most of the grammar, parsed once so the first real request hits a warm DFA
+const char* WARM_UP_SOURCE = R"(
+struct Node {
+  string value;
+  Node next;
+}
+
+fn length(Node head) -> int {
+  int count = 0;
+  for (head != nullptr) {
+    count++;
+    head = head.next;
+  }
+  return count;
+}
+
+fn main() {
+  int[] values = allocate int[3];
+  float total = 0.0;
+  for (int i = 0; i < 3; i++) {
+    values[i] = i * 2 + 1;
+    total = total + (values[i]) as float;
+  }
+  if (total > 4.0 && !false) {
+    println("total: " + total);
+  } else if (total == 0.0) {
+    println("empty");
+  } else {
+    println("small");
+  }
+  for {
+    break;
+  }
+}
+)";
+
+#ifndef _WIN32
+bool writeAll(int fd, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t count = send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    written += static_cast<size_t>(count);
+  }
+  return true;
+}
+#endif
+
+std::string trim(const std::string& text) {
+  size_t start = text.find_first_not_of(" \t\r");
+  if (start == std::string::npos) {
+    return "";
+  }
+  size_t end = text.find_last_not_of(" \t\r");
+  return text.substr(start, end - start + 1);
+}
+
+} // namespace
+
+CompileServer::CompileServer(const std::string& socketPath, const CompileOptions& defaults)
+    : socketPath(socketPath), defaults(defaults) {}
+
+bool CompileServer::warmUp(std::ostream& log) {
+  CompileOptions options = defaults;
+  options.stopStage = PARSING;
+  std::ostringstream discarded;
+  std::ostringstream errors;
+  // a syntax error would only warm up the error recovery, not the DFA valid programs need
+  if (compileSource(WARM_UP_SOURCE, options, discarded, errors).exitCode != 0) {
+    log << "Warm-up program failed to parse:\n" << errors.str();
+    return false;
+  }
+  return true;
+}
+
+#ifdef _WIN32
+
+int CompileServer::run(std::ostream& log) {
+  log << "--serve needs unix domain sockets, which aren't supported on this platform yet" << std::endl;
+  return 1;
+}
+
+bool CompileServer::readRequest(int, Request&, std::string&) const { return false; }
+
+#else
+
+int CompileServer::run(std::ostream& log) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    log << "Socket path too long: " << socketPath << std::endl;
+    return 1;
+  }
+  socketPath.copy(address.sun_path, socketPath.size());
+
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server < 0) {
+    log << "Failed to create socket: " << std::strerror(errno) << std::endl;
+    return 1;
+  }
+  // only clear the path if nobody is listening on it anymore
+  if (connect(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+    log << "Another server is already listening on " << socketPath << std::endl;
+    close(server);
+    return 1;
+  }
+  close(server);
+  unlink(socketPath.c_str());
+
+  server = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server < 0 || bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      listen(server, 16) != 0) {
+    log << "Failed to listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+    if (server >= 0) {
+      close(server);
+    }
+    return 1;
+  }
+
+  // no SA_RESTART, so a signal interrupts accept and we get to clean up the socket
+  struct sigaction action {};
+  action.sa_handler = handleStopSignal;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+
+  auto warmUpStart = std::chrono::steady_clock::now();
+  warmUp(log);
+  double warmUpMilliseconds =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - warmUpStart).count();
+  log << "Listening on " << socketPath << " (warm-up took " << std::fixed << std::setprecision(1)
+      << warmUpMilliseconds << " ms)" << std::endl;
+
+  while (!stopRequested) {
+    int client = accept(server, nullptr, nullptr);
+    if (client < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      log << "Failed to accept connection: " << std::strerror(errno) << std::endl;
+      break;
+    }
+    auto accepted = std::chrono::steady_clock::now();
+    struct timeval timeout {};
+    timeout.tv_sec = RECEIVE_TIMEOUT_SECONDS;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    Request request;
+    std::string error;
+    std::string response;
+    if (!readRequest(client, request, error)) {
+      std::ostringstream out;
+      out << "status: 1\nstdout-length: 0\nstderr-length: " << error.size() + 1 << "\n\n" << error << "\n";
+      response = out.str();
+      log << "Bad request: " << error << std::endl;
+    } else if (request.shutdown) {
+      response = "status: 0\nstdout-length: 0\nstderr-length: 0\n\n";
+      stopRequested = 1;
+    } else {
+      response = handleRequest(request, accepted, log);
+    }
+    writeAll(client, response);
+    close(client);
+  }
+
+  close(server);
+  unlink(socketPath.c_str());
+  log << "Served " << requestCount << " requests, shutting down" << std::endl;
+  return 0;
+}
+
+bool CompileServer::readRequest(int client, Request& request, std::string& error) const {
+  std::string data;
+  char buffer[8192];
+  size_t headerEnd = std::string::npos;
+  size_t contentLength = std::string::npos;
+  bool timedOut = false;
+  bool tooLarge = false;
+
+  auto readMore = [&]() {
+    for (;;) {
+      ssize_t count = recv(client, buffer, sizeof(buffer), 0);
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count <= 0) {
+        timedOut = count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        return false;
+      }
+      if (data.size() + static_cast<size_t>(count) > MAX_REQUEST_BYTES) {
+        tooLarge = true;
+        return false;
+      }
+      data.append(buffer, static_cast<size_t>(count));
+      return true;
+    }
+  };
+  // why readMore stopped before the request was complete
+  auto readError = [&](const std::string& closedBefore) {
+    if (timedOut) {
+      return "No data from the client for " + std::to_string(RECEIVE_TIMEOUT_SECONDS) + " seconds";
+    }
+    if (tooLarge) {
+      return "Request larger than " + std::to_string(MAX_REQUEST_BYTES) + " bytes";
+    }
+    return "Connection closed before the end of the " + closedBefore;
+  };
+
+  // a request with no header lines starts straight with the blank line
+  auto findHeaderEnd = [&]() { return data.compare(0, 1, "\n") == 0 ? 0 : data.find("\n\n"); };
+  while ((headerEnd = findHeaderEnd()) == std::string::npos) {
+    if (!readMore()) {
+      error = readError("request header");
+      return false;
+    }
+  }
+
+  std::istringstream header(data.substr(0, headerEnd));
+  std::string line;
+  while (std::getline(header, line)) {
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    std::string key = trim(line.substr(0, colon));
+    std::string value = trim(line.substr(colon + 1));
+    if (key == "flags") {
+      std::istringstream flags(value);
+      std::string flag;
+      while (flags >> flag) {
+        request.flags.push_back(flag);
+      }
+    } else if (key == "out-dir") {
+      request.outputDir = value;
+    } else if (key == "content-length") {
+      uint64_t length = 0;
+      if (!parseCountFlag(value, length) || length > MAX_REQUEST_BYTES) {
+        error = "Invalid content-length: " + value;
+        return false;
+      }
+      contentLength = static_cast<size_t>(length);
+    } else if (key == "command" && value == "shutdown") {
+      request.shutdown = true;
+    }
+  }
+
+  size_t bodyStart = headerEnd == 0 ? 1 : headerEnd + 2;
+  if (contentLength == std::string::npos) {
+    while (readMore()) {
+    }
+    if (timedOut || tooLarge) {
+      error = readError("source");
+      return false;
+    }
+    request.source = data.substr(bodyStart);
+    return true;
+  }
+  while (data.size() - bodyStart < contentLength) {
+    if (!readMore()) {
+      error = readError("source");
+      return false;
+    }
+  }
+  request.source = data.substr(bodyStart, contentLength);
+  return true;
+}
+
+#endif
+
+std::string CompileServer::handleRequest(const Request& request, std::chrono::steady_clock::time_point accepted,
+                                         std::ostream& log) {
+  requestCount++;
+  CompileOptions options = defaults;
+  std::string flagError;
+  for (size_t i = 0; i < request.flags.size() && flagError.empty(); i++) {
+    applyCompileFlag(request.flags, i, options, flagError);
+  }
+  if (!request.outputDir.empty()) {
+    options.outputDir = request.outputDir;
+  }
+  // relative paths would resolve against the server's working directory, not the client's
+  if (flagError.empty() && options.outputDir != defaults.outputDir &&
+      !std::filesystem::path(options.outputDir).is_absolute()) {
+    flagError = "The output directory of a request has to be an absolute path: " + options.outputDir;
+  }
+
+  std::ostringstream out;
+  std::ostringstream err;
+  CompileResult result;
+  if (!flagError.empty()) {
+    err << flagError << std::endl;
+    result.exitCode = 1;
+  } else {
+    try {
+      result = compileSource(request.source, options, out, err);
+    } catch (const std::exception& e) {
+      err << "Internal compiler error: " << e.what() << std::endl;
+      result.exitCode = 1;
+    }
+  }
+  double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - accepted).count();
+
+  std::string stdoutText = out.str();
+  std::string stderrText = err.str();
+  std::ostringstream response;
+  response << "status: " << result.exitCode << "\n";
+  response << "latency-ms: " << std::fixed << std::setprecision(3) << milliseconds << "\n";
+  for (const auto& path : result.outputPaths) {
+    response << "output: " << std::filesystem::absolute(path).string() << "\n";
+  }
+  response << "stdout-length: " << stdoutText.size() << "\n";
+  response << "stderr-length: " << stderrText.size() << "\n\n";
+  response << stdoutText << stderrText;
+
+  log << "Request " << requestCount << ": status " << result.exitCode << ", " << request.source.size()
+      << " bytes, " << std::setprecision(1) << milliseconds << " ms" << std::endl;
+  return response.str();
+}
@@ -0,0 +1,46 @@
+#ifndef COMPILE_SERVER_H
+#define COMPILE_SERVER_H
+
+#include "compile_driver.h"
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// long running compiler listening on a local unix socket, so the antlr DFA cache and builtins stay warm
+// one request per connection, handled one at a time:
+//
+//   request:  header lines ("flags: --jasm", "out-dir: /abs/dir", "content-length: N"), a blank line, the source
+//             without content-length the source runs until the client shuts down its write side
+//             "command: shutdown" stops the server
+//             an output directory given by the request (out-dir or --out-dir) has to be absolute
+//             at most 64 MiB, and a client that sends nothing for 10 seconds gets an error response
+//   response: "status: N", "latency-ms: X", one "output: /abs/path" per written file,
+//             "stdout-length: N", "stderr-length: N", a blank line, then the stdout and stderr text
+class CompileServer {
+public:
+  CompileServer(const std::string& socketPath, const CompileOptions& defaults);
+
+  // serves until a shutdown request or SIGINT/SIGTERM, returns the process exit code
+  int run(std::ostream& log);
+
+private:
+  struct Request {
+    std::vector<std::string> flags;
+    std::string outputDir;
+    std::string source;
+    bool shutdown = false;
+  };
+
+  std::string socketPath;
+  CompileOptions defaults;
+  size_t requestCount = 0;
+
+  // parses a small program to fill the DFA cache, false (with the errors logged) if it didn't parse cleanly
+  bool warmUp(std::ostream& log);
+  bool readRequest(int client, Request& request, std::string& error) const;
+  // compiles one request and builds its response, latency counts from when the connection was accepted
+  std::string handleRequest(const Request& request, std::chrono::steady_clock::time_point accepted, std::ostream& log);
+};
+
+#endif // COMPILE_SERVER_H
@@ -58,4 +58,12 @@ void ErrorReporter::displayErrors(std::ostream& out) const {
   }
 }
 
+void ErrorReporter::append(const ErrorReporter& other) {
+  errors.insert(errors.end(), other.errors.begin(), other.errors.end());
+}
+
+void ErrorReporter::append(const ErrorReporter& other, size_t begin, size_t end) {
+  errors.insert(errors.end(), other.errors.begin() + begin, other.errors.begin() + end);
+}
+
 bool ErrorReporter::hasErrors() const { return !errors.empty(); }
@@ -33,7 +33,12 @@ public:
 
   void reportError(ErrorType type, int line, int column, const std::string& message);
   void displayErrors(std::ostream& out = std::cerr) const;
+  // adds other's errors after this one's, for passes that collect errors separately
+  void append(const ErrorReporter& other);
+  // only other's errors from begin up to end, in the order they were reported
+  void append(const ErrorReporter& other, size_t begin, size_t end);
   bool hasErrors() const;
+  size_t getErrorCount() const { return errors.size(); }
 
 private:
   std::vector<CompilerError> errors;
@@ -0,0 +1,57 @@
+#include "flat_ast.h"
+#include "input/arena_token_factory.h"
+#include <cgullParser.h>
+
+FlatAst FlatAst::lower(const NodeIndex& index, const AtomTable& atoms) {
+  FlatAst ast;
+  ast.nodes.resize(index.size());
+  ast.positions.resize(index.size());
+  for (size_t id = 1; id < index.size(); id++) {
+    auto* ctx = index.getNode(id);
+    Node& node = ast.nodes[id];
+    node.kind = static_cast<uint8_t>(ctx->getRuleIndex());
+    node.parent = static_cast<uint32_t>(NodeIndex::idOf(static_cast<antlr4::ParserRuleContext*>(ctx->parent)));
+    for (auto* child : ctx->children) {
+      if (auto* terminal = dynamic_cast<antlr4::tree::TerminalNode*>(child)) {
+        size_t type = terminal->getSymbol()->getType();
+        if (node.firstToken == 0) {
+          node.firstToken = static_cast<uint16_t>(type);
+        }
+        if (type == cgullParser::IDENTIFIER && node.identifier == NO_ATOM) {
+          node.identifier = identifierAtom(terminal, atoms);
+        } else if (type == cgullParser::FN_SPECIAL) {
+          node.flags |= Node::SPECIAL_NAME;
+        }
+      } else if (auto* rule = dynamic_cast<antlr4::ParserRuleContext*>(child)) {
+        // the last child for now, the backwards pass turns it into the subtree end
+        node.subtreeEnd = static_cast<uint32_t>(NodeIndex::idOf(rule));
+      }
+    }
+
+    if (auto* start = ctx->getStart()) {
+      SourcePosition& position = ast.positions[id];
+      position.line = static_cast<uint32_t>(start->getLine());
+      position.column = static_cast<uint32_t>(start->getCharPositionInLine());
+    }
+  }
+
+  // children have larger ids than their parent, so going backwards every child's subtree is done before its parent's
+  for (size_t id = index.size(); id-- > 1;) {
+    Node& node = ast.nodes[id];
+    node.subtreeEnd = node.subtreeEnd == 0 ? static_cast<uint32_t>(id + 1) : ast.nodes[node.subtreeEnd].subtreeEnd;
+  }
+  return ast;
+}
+
+uint32_t FlatAst::childOfKind(size_t id, size_t kind, size_t n) const {
+  for (uint32_t child : children(id)) {
+    if (nodes[child].kind == kind && n-- == 0) {
+      return child;
+    }
+  }
+  return 0;
+}
+
+size_t FlatAst::getMemoryBytes() const {
+  return nodes.capacity() * sizeof(Node) + positions.capacity() * sizeof(SourcePosition);
+}
@@ -0,0 +1,93 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include "node_table.h"
+#include "symbols/atom_table.h"
+#include <cstdint>
+#include <vector>
+
+// where a node starts in the source, for error messages: the line and column of its first token. a node that matched
+// no tokens is at 0:0
+struct SourcePosition {
+  uint32_t line = 0;
+  uint32_t column = 0;
+};
+
+// the parse tree lowered into flat arrays, without antlr's token lists, strings and virtual accessors
+// node ids are the ones NodeIndex gave the tree (0 is no node), so every NodeTable of the analysis indexes this too
+// ids are preorder, so the children of a node aren't stored: the first one comes right after it, and every other one
+// right after the subtree of the one before. the terminals a pass looks at are kept on their parent (its first
+// operator token and its first identifier)
+// a node is 16 bytes and its position 8 more. the passes that don't need the contexts (node roles, node scopes, use
+// before definition) run on this, and it is freed before type checking, so it's never alive next to the type tables or
+// the IR
+class FlatAst {
+public:
+  struct Node {
+    // a FN_SPECIAL ($) right before the node's identifier, like in fn $str()
+    static constexpr uint8_t SPECIAL_NAME = 1;
+
+    // cgullParser::Rule*, the grammar has far fewer than 256 rules
+    uint8_t kind = 0;
+    uint8_t flags = 0;
+    // type of the first token directly under the node, 0 if it has none, e.g. AND_OP for a && b
+    uint16_t firstToken = 0;
+    uint32_t parent = 0;
+    // the subtree of node id is [id, subtreeEnd)
+    uint32_t subtreeEnd = 0;
+    // the first IDENTIFIER directly under the node, NO_ATOM if there is none
+    Atom identifier = NO_ATOM;
+  };
+
+  // the child ids of a node, in source order
+  class Children {
+  public:
+    class Iterator {
+    public:
+      Iterator(const Node* nodes, uint32_t id) : nodes(nodes), id(id) {}
+      uint32_t operator*() const { return id; }
+      // the next sibling starts where this child's subtree ends
+      Iterator& operator++() {
+        id = nodes[id].subtreeEnd;
+        return *this;
+      }
+      bool operator!=(const Iterator& other) const { return id != other.id; }
+
+    private:
+      const Node* nodes;
+      uint32_t id;
+    };
+
+    Children(const Node* nodes, uint32_t id) : nodes(nodes), id(id) {}
+    Iterator begin() const { return Iterator(nodes, id + 1); }
+    Iterator end() const { return Iterator(nodes, nodes[id].subtreeEnd); }
+
+  private:
+    const Node* nodes;
+    uint32_t id;
+  };
+
+  FlatAst() = default;
+
+  // one pass over the ids of index, identifiers are looked up in atoms
+  static FlatAst lower(const NodeIndex& index, const AtomTable& atoms);
+
+  // one more than the largest id
+  size_t size() const { return nodes.size(); }
+  const Node& node(size_t id) const { return nodes[id]; }
+  uint8_t kind(size_t id) const { return nodes[id].kind; }
+  const SourcePosition& position(size_t id) const { return positions[id]; }
+  Children children(size_t id) const { return Children(nodes.data(), static_cast<uint32_t>(id)); }
+  // the n-th child of the given kind (counting from 0), 0 if there are fewer
+  uint32_t childOfKind(size_t id, size_t kind, size_t n = 0) const;
+
+  // bytes held by the arrays
+  size_t getMemoryBytes() const;
+
+private:
+  // positions are only read for error messages, so they sit apart from the nodes walked by every pass
+  std::vector<Node> nodes{Node()};
+  std::vector<SourcePosition> positions{SourcePosition()};
+};
+
+#endif // FLAT_AST_H
@@ -0,0 +1,48 @@
+#include "arena_token_factory.h"
+#include <cgullLexer.h>
+
+std::unique_ptr<antlr4::CommonToken>
+ArenaTokenFactory::create(std::pair<antlr4::TokenSource*, antlr4::CharStream*> source, size_t type,
+                          const std::string& text, size_t channel, size_t start, size_t stop, size_t line,
+                          size_t charPositionInLine) {
+  auto* arenaToken = new (arena) ArenaToken(source, type, channel, start, stop);
+  std::unique_ptr<antlr4::CommonToken> token(arenaToken);
+  token->setLine(line);
+  token->setCharPositionInLine(charPositionInLine);
+  // only set by lexer actions and the parser's conjured "missing" tokens, normal tokens read their text from
+  // the input stream when asked
+  if (!text.empty()) {
+    token->setText(text);
+  }
+  if (atoms != nullptr && type == cgullLexer::IDENTIFIER) {
+    if (text.empty()) {
+      internIdentifier(*arenaToken, source.second, start, stop);
+    } else {
+      arenaToken->atom = atoms->intern(text);
+    }
+  }
+  tokenCount++;
+  return token;
+}
+
+void ArenaTokenFactory::internIdentifier(ArenaToken& token, antlr4::CharStream* input, size_t start, size_t stop) {
+  if (input != lastInput) {
+    lastInput = input;
+    lastUtf8Input = dynamic_cast<Utf8CharStream*>(input);
+  }
+  if (lastUtf8Input != nullptr) {
+    token.atom = atoms->intern(lastUtf8Input->getTextView(start, stop));
+  } else {
+    token.atom = atoms->intern(input->getText(antlr4::misc::Interval(start, stop)));
+  }
+}
+
+std::unique_ptr<antlr4::CommonToken> ArenaTokenFactory::create(size_t type, const std::string& text) {
+  auto* arenaToken = new (arena) ArenaToken(type, text);
+  std::unique_ptr<antlr4::CommonToken> token(arenaToken);
+  if (atoms != nullptr && type == cgullLexer::IDENTIFIER) {
+    arenaToken->atom = atoms->intern(text);
+  }
+  tokenCount++;
+  return token;
+}
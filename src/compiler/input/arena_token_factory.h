@@ -0,0 +1,60 @@
+#ifndef ARENA_TOKEN_FACTORY_H
+#define ARENA_TOKEN_FACTORY_H
+
+#include "../arena.h"
+#include "../symbols/atom_table.h"
+#include "utf8_char_stream.h"
+#include <antlr4-runtime.h>
+
+// CommonToken carved out of an arena, its text is only the start/stop offsets into the input stream
+// token streams still own tokens through unique_ptr<Token>, so deleting one runs the destructor as usual
+// but hands the memory back to nobody, it goes away with the arena
+class ArenaToken : public antlr4::CommonToken {
+public:
+  using antlr4::CommonToken::CommonToken;
+
+  static void* operator new(size_t size, Arena& arena) { return arena.allocate(size, alignof(ArenaToken)); }
+  static void operator delete(void*) noexcept {}
+  // only used if a constructor throws
+  static void operator delete(void*, Arena&) noexcept {}
+
+  // the interned text of an IDENTIFIER token, NO_ATOM for every other token
+  Atom atom = NO_ATOM;
+};
+
+// the atom of an identifier, interned while lexing when the token came from an ArenaTokenFactory sharing this atom
+// table, otherwise looked up by its text (NO_ATOM if it was never interned)
+inline Atom identifierAtom(antlr4::tree::TerminalNode* identifier, const AtomTable& atoms) {
+  auto* token = dynamic_cast<ArenaToken*>(identifier->getSymbol());
+  if (token != nullptr && token->atom != NO_ATOM) {
+    return token->atom;
+  }
+  return atoms.find(identifier->getSymbol()->getText());
+}
+
+// token factory for the lexer, one per compilation
+// the arena has to outlive the lexer, the token stream, the parser and the parse tree
+// with an atom table, identifiers are interned as they are lexed
+class ArenaTokenFactory : public antlr4::TokenFactory<antlr4::CommonToken> {
+public:
+  explicit ArenaTokenFactory(Arena& arena, AtomTable* atoms = nullptr) : arena(arena), atoms(atoms) {}
+
+  std::unique_ptr<antlr4::CommonToken> create(std::pair<antlr4::TokenSource*, antlr4::CharStream*> source, size_t type,
+                                              const std::string& text, size_t channel, size_t start, size_t stop,
+                                              size_t line, size_t charPositionInLine) override;
+  std::unique_ptr<antlr4::CommonToken> create(size_t type, const std::string& text) override;
+
+  size_t getTokenCount() const { return tokenCount; }
+
+private:
+  Arena& arena;
+  AtomTable* atoms;
+  size_t tokenCount = 0;
+  // the stream the last identifier came from, checked once per stream instead of once per token
+  antlr4::CharStream* lastInput = nullptr;
+  Utf8CharStream* lastUtf8Input = nullptr;
+
+  void internIdentifier(ArenaToken& token, antlr4::CharStream* input, size_t start, size_t stop);
+};
+
+#endif // ARENA_TOKEN_FACTORY_H
@@ -0,0 +1,70 @@
+#include "mapped_file.h"
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+void MappedFile::close() {
+#ifndef _WIN32
+  if (mapping != nullptr) {
+    munmap(mapping, mappingSize);
+  }
+#endif
+  mapping = nullptr;
+  mappingSize = 0;
+  buffer.clear();
+  view = {};
+}
+
+bool MappedFile::open(const std::string& path) {
+  close();
+#ifndef _WIN32
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info {};
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+    ::close(fd);
+    return readIntoBuffer(path);
+  }
+  if (info.st_size == 0) {
+    // mmap rejects empty mappings, and there's nothing to map anyway
+    ::close(fd);
+    return true;
+  }
+
+  void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (address == MAP_FAILED) {
+    return readIntoBuffer(path);
+  }
+  // the lexer reads front to back
+  madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+  mapping = address;
+  mappingSize = static_cast<size_t>(info.st_size);
+  view = std::string_view(static_cast<const char*>(mapping), mappingSize);
+  return true;
+#else
+  return readIntoBuffer(path);
+#endif
+}
+
+bool MappedFile::readIntoBuffer(const std::string& path) {
+  std::ifstream inputFile(path, std::ios::binary);
+  if (!inputFile.is_open()) {
+    return false;
+  }
+  std::stringstream inputBuffer;
+  inputBuffer << inputFile.rdbuf();
+  buffer = inputBuffer.str();
+  view = buffer;
+  return true;
+}
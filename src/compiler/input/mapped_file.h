@@ -0,0 +1,30 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+
+// read-only view of a whole source file, memory mapped so the bytes are never copied
+// falls back to reading the file into memory where mapping isn't possible (windows, pipes)
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // returns false if the file can't be opened, contents() stays valid until this is destroyed
+  bool open(const std::string& path);
+  std::string_view contents() const { return view; }
+
+private:
+  void* mapping = nullptr;
+  size_t mappingSize = 0;
+  std::string buffer;
+  std::string_view view;
+
+  void close();
+  bool readIntoBuffer(const std::string& path);
+};
+
+#endif // MAPPED_FILE_H
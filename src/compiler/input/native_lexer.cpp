@@ -0,0 +1,479 @@
+#include "native_lexer.h"
+#include <algorithm>
+#include <cgullLexer.h>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CGULL_LEXER_SSE2 1
+#endif
+
+namespace {
+
+// ----- character classes -----
+
+enum CharClass : unsigned char {
+  WHITESPACE = 1 << 0,
+  IDENTIFIER_START = 1 << 1,
+  IDENTIFIER_PART = 1 << 2,
+  DIGIT = 1 << 3,
+  HEX_DIGIT = 1 << 4,
+};
+
+struct CharClasses {
+  unsigned char classes[256] = {};
+
+  CharClasses() {
+    for (int c = 0; c < 256; c++) {
+      unsigned char flags = 0;
+      if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+        flags |= WHITESPACE;
+      }
+      if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') {
+        flags |= IDENTIFIER_START | IDENTIFIER_PART;
+      }
+      if (c >= '0' && c <= '9') {
+        flags |= IDENTIFIER_PART | DIGIT | HEX_DIGIT;
+      }
+      if ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) {
+        flags |= HEX_DIGIT;
+      }
+      classes[c] = flags;
+    }
+  }
+};
+
+const CharClasses charClasses;
+
+bool is(char c, CharClass charClass) { return charClasses.classes[static_cast<unsigned char>(c)] & charClass; }
+
+// ----- keyword and operator tables, built from the generated lexer's vocabulary -----
+
+struct FixedToken {
+  std::string text;
+  size_t type;
+  // for literals with a space like 'else if': the part after the first word, and the type when it follows
+  std::string compoundSuffix{};
+  size_t compoundType = 0;
+};
+
+struct TokenTables {
+  // keywords by first character
+  std::vector<FixedToken> keywords[128];
+  // operators and punctuation by first character, longest first
+  std::vector<FixedToken> operators[128];
+};
+
+std::string unquoteLiteral(std::string_view literal) {
+  std::string text;
+  for (size_t i = 1; i + 1 < literal.size(); i++) {
+    if (literal[i] == '\\' && i + 2 < literal.size()) {
+      i++;
+    }
+    text += literal[i];
+  }
+  return text;
+}
+
+const TokenTables& tokenTables() {
+  static const TokenTables tables = [] {
+    TokenTables result;
+    const antlr4::dfa::Vocabulary& vocabulary = NativeLexer::getVocabulary();
+    std::vector<std::pair<std::string, size_t>> compounds;
+
+    for (size_t type = 1; type <= vocabulary.getMaxTokenType(); type++) {
+      std::string_view literal = vocabulary.getLiteralName(type);
+      if (literal.size() < 3) {
+        continue; // lexer rules without a fixed text
+      }
+      std::string text = unquoteLiteral(literal);
+      unsigned char first = static_cast<unsigned char>(text[0]);
+      if (text.find(' ') != std::string::npos) {
+        compounds.emplace_back(text, type);
+      } else if (is(text[0], IDENTIFIER_START)) {
+        result.keywords[first].push_back({text, type});
+      } else {
+        result.operators[first].push_back({text, type});
+      }
+    }
+
+    for (auto& candidates : result.operators) {
+      std::stable_sort(candidates.begin(), candidates.end(),
+                       [](const FixedToken& a, const FixedToken& b) { return a.text.size() > b.text.size(); });
+    }
+
+    // 'else if' is one token, but only ever starts where the word 'else' would be matched
+    for (const auto& [text, type] : compounds) {
+      std::string head = text.substr(0, text.find(' '));
+      auto& candidates = result.keywords[static_cast<unsigned char>(head[0])];
+      auto keyword = std::find_if(candidates.begin(), candidates.end(),
+                                  [&](const FixedToken& candidate) { return candidate.text == head; });
+      if (keyword == candidates.end()) {
+        candidates.push_back({head, cgullLexer::IDENTIFIER});
+        keyword = candidates.end() - 1;
+      }
+      keyword->compoundSuffix = text.substr(head.size());
+      keyword->compoundType = type;
+    }
+    return result;
+  }();
+  return tables;
+}
+
+// ----- scanning, 16 bytes at a time where sse2 is available -----
+
+#ifdef CGULL_LEXER_SSE2
+int firstSetBit(unsigned mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+__m128i load(const char* data, size_t offset) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+}
+
+__m128i matches(__m128i chunk, char c) { return _mm_cmpeq_epi8(chunk, _mm_set1_epi8(c)); }
+#endif
+
+// first offset at or after from that isn't a space, tab, cr or lf
+size_t skipWhitespace(std::string_view data, size_t from) {
+#ifdef CGULL_LEXER_SSE2
+  for (; from + 16 <= data.size(); from += 16) {
+    __m128i chunk = load(data.data(), from);
+    __m128i space = _mm_or_si128(_mm_or_si128(matches(chunk, ' '), matches(chunk, '\t')),
+                                 _mm_or_si128(matches(chunk, '\r'), matches(chunk, '\n')));
+    unsigned other = ~static_cast<unsigned>(_mm_movemask_epi8(space)) & 0xFFFF;
+    if (other != 0) {
+      return from + firstSetBit(other);
+    }
+  }
+#endif
+  while (from < data.size() && is(data[from], WHITESPACE)) {
+    from++;
+  }
+  return from;
+}
+
+// first cr or lf at or after from, or the end of the input
+size_t findLineEnd(std::string_view data, size_t from) {
+#ifdef CGULL_LEXER_SSE2
+  for (; from + 16 <= data.size(); from += 16) {
+    __m128i chunk = load(data.data(), from);
+    unsigned found = _mm_movemask_epi8(_mm_or_si128(matches(chunk, '\r'), matches(chunk, '\n')));
+    if (found != 0) {
+      return from + firstSetBit(found);
+    }
+  }
+#endif
+  while (from < data.size() && data[from] != '\r' && data[from] != '\n') {
+    from++;
+  }
+  return from;
+}
+
+// first character that ends a run of plain string characters: a quote, backslash, cr or lf
+size_t findStringStop(std::string_view data, size_t from) {
+#ifdef CGULL_LEXER_SSE2
+  for (; from + 16 <= data.size(); from += 16) {
+    __m128i chunk = load(data.data(), from);
+    __m128i stop = _mm_or_si128(_mm_or_si128(matches(chunk, '"'), matches(chunk, '\\')),
+                                _mm_or_si128(matches(chunk, '\r'), matches(chunk, '\n')));
+    unsigned found = _mm_movemask_epi8(stop);
+    if (found != 0) {
+      return from + firstSetBit(found);
+    }
+  }
+#endif
+  while (from < data.size() && data[from] != '"' && data[from] != '\\' && data[from] != '\r' && data[from] != '\n') {
+    from++;
+  }
+  return from;
+}
+
+// offset of the '*' of the first "*/" at or after from, or npos if the comment is never closed
+size_t findCommentEnd(std::string_view data, size_t from) {
+#ifdef CGULL_LEXER_SSE2
+  // compare each byte and the one after it at once
+  for (; from + 17 <= data.size(); from += 16) {
+    __m128i stars = matches(load(data.data(), from), '*');
+    __m128i slashes = matches(load(data.data(), from + 1), '/');
+    unsigned found = _mm_movemask_epi8(_mm_and_si128(stars, slashes));
+    if (found != 0) {
+      return from + firstSetBit(found);
+    }
+  }
+#endif
+  for (; from + 1 < data.size(); from++) {
+    if (data[from] == '*' && data[from + 1] == '/') {
+      return from;
+    }
+  }
+  return std::string_view::npos;
+}
+
+size_t countNewlines(std::string_view data, size_t from, size_t to) {
+  size_t count = 0;
+#ifdef CGULL_LEXER_SSE2
+  for (; from + 16 <= to; from += 16) {
+    unsigned found = _mm_movemask_epi8(matches(load(data.data(), from), '\n'));
+    while (found != 0) {
+      found &= found - 1;
+      count++;
+    }
+  }
+#endif
+  for (; from < to; from++) {
+    count += data[from] == '\n';
+  }
+  return count;
+}
+
+// same escaping as antlr4::Lexer::getErrorDisplay
+std::string errorDisplay(std::string_view text) {
+  std::string display;
+  for (char c : text) {
+    switch (c) {
+    case '\n':
+      display += "\\n";
+      break;
+    case '\t':
+      display += "\\t";
+      break;
+    case '\r':
+      display += "\\r";
+      break;
+    default:
+      display += c;
+      break;
+    }
+  }
+  return display;
+}
+
+} // namespace
+
+NativeLexer::NativeLexer(antlr4::CharStream* input, std::string_view data)
+    : input(input), data(data), factory(antlr4::CommonTokenFactory::DEFAULT.get()) {}
+
+const antlr4::dfa::Vocabulary& NativeLexer::getVocabulary() {
+  // the vocabulary is static data of the generated lexer, but only reachable through an instance
+  static antlr4::ANTLRInputStream emptyInput;
+  static cgullLexer vocabularyLexer(&emptyInput);
+  return vocabularyLexer.getVocabulary();
+}
+
+size_t NativeLexer::literalType(std::string_view literal) {
+  const antlr4::dfa::Vocabulary& vocabulary = getVocabulary();
+  for (size_t type = 1; type <= vocabulary.getMaxTokenType(); type++) {
+    if (vocabulary.getLiteralName(type) == literal) {
+      return type;
+    }
+  }
+  return antlr4::Token::INVALID_TYPE;
+}
+
+void NativeLexer::advanceTo(size_t end) {
+  size_t newlines = countNewlines(data, position, end);
+  if (newlines != 0) {
+    line += newlines;
+    size_t lastNewline = end - 1;
+    while (data[lastNewline] != '\n') {
+      lastNewline--;
+    }
+    lineStart = lastNewline + 1;
+  }
+  position = end;
+}
+
+std::unique_ptr<antlr4::Token> NativeLexer::emit(size_t type, size_t start, size_t startLine, size_t startColumn) {
+  // stop is one before start for the empty EOF token, wrapping around just like antlr's
+  return factory->create({this, input}, type, "", antlr4::Token::DEFAULT_CHANNEL, start, position - 1, startLine,
+                         startColumn);
+}
+
+void NativeLexer::recover(size_t start, size_t failIndex, size_t startLine, size_t startColumn) {
+  std::string_view text = data.substr(start, failIndex < data.size() ? failIndex - start + 1 : std::string_view::npos);
+  if (errorListener != nullptr) {
+    errorListener->syntaxError(nullptr, nullptr, startLine, startColumn,
+                               "token recognition error at: '" + errorDisplay(text) + "'", nullptr);
+  }
+  advanceTo(failIndex < data.size() ? failIndex + 1 : data.size());
+}
+
+std::unique_ptr<antlr4::Token> NativeLexer::nextToken() {
+  for (;;) {
+    size_t start = position;
+    size_t startLine = line;
+    size_t startColumn = position - lineStart;
+    if (position >= data.size()) {
+      return emit(antlr4::Token::EOF, start, startLine, startColumn);
+    }
+
+    char c = data[position];
+    size_t type = 0;
+    size_t length = 0;
+
+    if (is(c, WHITESPACE)) {
+      advanceTo(skipWhitespace(data, position));
+      continue;
+    }
+    if (c == '/' && position + 1 < data.size() && data[position + 1] == '/') {
+      advanceTo(findLineEnd(data, position + 2));
+      continue;
+    }
+    if (c == '/' && position + 1 < data.size() && data[position + 1] == '*') {
+      size_t close = findCommentEnd(data, position + 2);
+      if (close != std::string_view::npos) {
+        advanceTo(close + 2);
+        continue;
+      }
+      // never closed, antlr falls back to the '/' it matched before
+    }
+
+    if (c == '"') {
+      size_t failIndex = 0;
+      length = matchString(failIndex);
+      if (length == 0) {
+        recover(start, failIndex, startLine, startColumn);
+        continue;
+      }
+      type = cgullLexer::STRING_LITERAL;
+    } else if (is(c, DIGIT)) {
+      length = matchNumber(type);
+    } else if (is(c, IDENTIFIER_START)) {
+      length = matchWord(type);
+    } else {
+      length = matchOperator(type);
+      if (length == 0) {
+        recover(start, start, startLine, startColumn);
+        continue;
+      }
+    }
+
+    // no token spans a newline
+    position += length;
+    return emit(type, start, startLine, startColumn);
+  }
+}
+
+size_t NativeLexer::matchString(size_t& failIndex) const {
+  size_t i = position + 1;
+  for (;;) {
+    i = findStringStop(data, i);
+    if (i >= data.size()) {
+      failIndex = data.size();
+      return 0;
+    }
+    char c = data[i];
+    if (c == '"') {
+      return i + 1 - position;
+    }
+    if (c == '\r' || c == '\n') {
+      failIndex = i;
+      return 0;
+    }
+
+    // escape sequence
+    if (i + 1 >= data.size()) {
+      failIndex = data.size();
+      return 0;
+    }
+    char escaped = data[i + 1];
+    if (std::strchr("\"\\/bfnrt", escaped) != nullptr && escaped != '\0') {
+      i += 2;
+      continue;
+    }
+    if (escaped != 'u') {
+      failIndex = i + 1;
+      return 0;
+    }
+    for (size_t digit = i + 2; digit < i + 6; digit++) {
+      if (digit >= data.size()) {
+        failIndex = data.size();
+        return 0;
+      }
+      if (!is(data[digit], HEX_DIGIT)) {
+        failIndex = digit;
+        return 0;
+      }
+    }
+    i += 6;
+  }
+}
+
+size_t NativeLexer::matchNumber(size_t& type) const {
+  size_t i = position;
+  if (data[i] == '0' && i + 2 < data.size()) {
+    if (data[i + 1] == 'x' && is(data[i + 2], HEX_DIGIT)) {
+      i += 2;
+      while (i < data.size() && is(data[i], HEX_DIGIT)) {
+        i++;
+      }
+      type = cgullLexer::HEX_LITERAL;
+      return i - position;
+    }
+    if (data[i + 1] == 'b' && (data[i + 2] == '0' || data[i + 2] == '1')) {
+      i += 2;
+      while (i < data.size() && (data[i] == '0' || data[i] == '1')) {
+        i++;
+      }
+      type = cgullLexer::BINARY_LITERAL;
+      return i - position;
+    }
+  }
+
+  while (i < data.size() && is(data[i], DIGIT)) {
+    i++;
+  }
+  type = cgullLexer::NUMBER_LITERAL;
+  if (i + 1 < data.size() && data[i] == '.' && is(data[i + 1], DIGIT)) {
+    i += 2;
+    while (i < data.size() && is(data[i], DIGIT)) {
+      i++;
+    }
+    type = cgullLexer::DECIMAL_LITERAL;
+  }
+  return i - position;
+}
+
+size_t NativeLexer::matchWord(size_t& type) const {
+  size_t i = position + 1;
+  while (i < data.size() && is(data[i], IDENTIFIER_PART)) {
+    i++;
+  }
+  size_t length = i - position;
+  type = cgullLexer::IDENTIFIER;
+
+  for (const auto& keyword : tokenTables().keywords[static_cast<unsigned char>(data[position])]) {
+    if (keyword.text.size() != length || data.compare(position, length, keyword.text) != 0) {
+      continue;
+    }
+    if (keyword.compoundType != 0 && data.compare(i, keyword.compoundSuffix.size(), keyword.compoundSuffix) == 0) {
+      type = keyword.compoundType;
+      return length + keyword.compoundSuffix.size();
+    }
+    type = keyword.type;
+    break;
+  }
+  return length;
+}
+
+size_t NativeLexer::matchOperator(size_t& type) const {
+  unsigned char first = static_cast<unsigned char>(data[position]);
+  if (first >= 128) {
+    return 0;
+  }
+  for (const auto& candidate : tokenTables().operators[first]) {
+    if (data.compare(position, candidate.text.size(), candidate.text) == 0) {
+      type = candidate.type;
+      return candidate.text.size();
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef NATIVE_LEXER_H
+#define NATIVE_LEXER_H
+
+#include <antlr4-runtime.h>
+#include <string_view>
+
+// hand written replacement for the generated cgullLexer, producing exactly the same tokens (types, offsets,
+// lines, columns) and the same "token recognition error" messages, without simulating the lexer ATN
+//
+// fixed tokens (keywords, operators, punctuation) are read from cgullLexer's vocabulary, so the token types
+// always match the grammar. whitespace, comments and string bodies are scanned 16 bytes at a time with sse2
+// where available
+//
+// only handles ascii input, where code point indexes and byte offsets are the same, the driver keeps
+// using cgullLexer for anything else
+class NativeLexer : public antlr4::TokenSource {
+public:
+  // input has to be an ascii stream over exactly these bytes
+  NativeLexer(antlr4::CharStream* input, std::string_view data);
+
+  std::unique_ptr<antlr4::Token> nextToken() override;
+  size_t getLine() const override { return line; }
+  size_t getCharPositionInLine() override { return position - lineStart; }
+  antlr4::CharStream* getInputStream() override { return input; }
+  std::string getSourceName() override { return input->getSourceName(); }
+  antlr4::TokenFactory<antlr4::CommonToken>* getTokenFactory() override { return factory; }
+
+  void setTokenFactory(antlr4::TokenFactory<antlr4::CommonToken>* tokenFactory) { factory = tokenFactory; }
+  // errors are reported like the generated lexer does, with no recognizer
+  void setErrorListener(antlr4::ANTLRErrorListener* listener) { errorListener = listener; }
+
+  // cgullLexer's vocabulary, for printing token names
+  static const antlr4::dfa::Vocabulary& getVocabulary();
+  // the type of the token with the given quoted literal, like "'{'", for tokens the grammar gives no name
+  static size_t literalType(std::string_view literal);
+
+private:
+  antlr4::CharStream* input;
+  std::string_view data;
+  antlr4::TokenFactory<antlr4::CommonToken>* factory;
+  antlr4::ANTLRErrorListener* errorListener = nullptr;
+
+  size_t position = 0;
+  size_t line = 1;
+  // offset of the first character on the current line
+  size_t lineStart = 0;
+
+  // moves position forward, keeping track of lines
+  void advanceTo(size_t end);
+  std::unique_ptr<antlr4::Token> emit(size_t type, size_t start, size_t startLine, size_t startColumn);
+  // like antlr: report from the token start up to and including the failing character, then skip that character
+  void recover(size_t start, size_t failIndex, size_t startLine, size_t startColumn);
+
+  // length of the string literal at position, or 0 with failIndex set
+  size_t matchString(size_t& failIndex) const;
+  size_t matchNumber(size_t& type) const;
+  size_t matchWord(size_t& type) const;
+  size_t matchOperator(size_t& type) const;
+};
+
+#endif // NATIVE_LEXER_H
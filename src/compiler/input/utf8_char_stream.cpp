@@ -0,0 +1,202 @@
+#include "utf8_char_stream.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+const size_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+bool isContinuation(unsigned char byte) { return (byte & 0xC0) == 0x80; }
+
+} // namespace
+
+Utf8CharStream::Utf8CharStream(std::string_view data, const std::string& sourceName)
+    : data(data), sourceName(sourceName) {
+  ascii = allAscii(data);
+  if (ascii) {
+    codePointCount = data.size();
+    return;
+  }
+
+  // one decoding pass to count code points and remember where every 64th one starts
+  size_t offset = 0;
+  size_t codePoint = 0;
+  while (offset < data.size()) {
+    if (codePointCount % CHECKPOINT_INTERVAL == 0) {
+      checkpoints.push_back(offset);
+    }
+    offset += decode(offset, codePoint);
+    codePointCount++;
+  }
+}
+
+bool Utf8CharStream::allAscii(std::string_view bytes) {
+  // eight bytes at a time, any high bit means a multi-byte sequence
+  const uint64_t highBits = 0x8080808080808080ULL;
+  size_t i = 0;
+  for (; i + 8 <= bytes.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes.data() + i, sizeof(word));
+    if (word & highBits) {
+      return false;
+    }
+  }
+  for (; i < bytes.size(); i++) {
+    if (static_cast<unsigned char>(bytes[i]) & 0x80) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t Utf8CharStream::decode(size_t offset, size_t& codePoint) const {
+  auto byteAt = [&](size_t i) { return static_cast<unsigned char>(data[i]); };
+  unsigned char lead = byteAt(offset);
+  if (lead < 0x80) {
+    codePoint = lead;
+    return 1;
+  }
+
+  size_t length;
+  size_t minimum;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+    minimum = 0x80;
+    codePoint = lead & 0x1F;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    minimum = 0x800;
+    codePoint = lead & 0x0F;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    minimum = 0x10000;
+    codePoint = lead & 0x07;
+  } else {
+    codePoint = REPLACEMENT_CHARACTER;
+    return 1;
+  }
+
+  if (offset + length > data.size()) {
+    codePoint = REPLACEMENT_CHARACTER;
+    return 1;
+  }
+  for (size_t i = 1; i < length; i++) {
+    if (!isContinuation(byteAt(offset + i))) {
+      codePoint = REPLACEMENT_CHARACTER;
+      return 1;
+    }
+    codePoint = (codePoint << 6) | (byteAt(offset + i) & 0x3F);
+  }
+  // overlong encodings, surrogates and anything past the unicode range
+  if (codePoint < minimum || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF) {
+    codePoint = REPLACEMENT_CHARACTER;
+    return 1;
+  }
+  return length;
+}
+
+size_t Utf8CharStream::byteOffsetOf(size_t codePointIndex) const {
+  if (ascii || codePointIndex == 0) {
+    return codePointIndex;
+  }
+  if (codePointIndex >= codePointCount) {
+    return data.size();
+  }
+  size_t offset = checkpoints[codePointIndex / CHECKPOINT_INTERVAL];
+  size_t codePoint = 0;
+  for (size_t i = 0; i < codePointIndex % CHECKPOINT_INTERVAL; i++) {
+    offset += decode(offset, codePoint);
+  }
+  return offset;
+}
+
+void Utf8CharStream::consume() {
+  if (position >= codePointCount) {
+    throw antlr4::IllegalStateException("cannot consume EOF");
+  }
+  if (ascii) {
+    byteOffset++;
+  } else {
+    size_t codePoint = 0;
+    byteOffset += decode(byteOffset, codePoint);
+  }
+  position++;
+}
+
+size_t Utf8CharStream::LA(ssize_t i) {
+  if (i == 0) {
+    return 0; // undefined
+  }
+  // LA(-1) is the code point just consumed
+  if (i < 0) {
+    i++;
+    if (static_cast<ssize_t>(position) + i - 1 < 0) {
+      return antlr4::IntStream::EOF;
+    }
+  }
+  size_t target = position + i - 1;
+  if (target >= codePointCount) {
+    return antlr4::IntStream::EOF;
+  }
+  if (ascii) {
+    return static_cast<unsigned char>(data[target]);
+  }
+
+  size_t codePoint = 0;
+  if (target >= position && target - position < 4) {
+    // short lookahead, walk forward from the current code point
+    size_t offset = byteOffset;
+    for (size_t skipped = position; skipped < target; skipped++) {
+      offset += decode(offset, codePoint);
+    }
+    decode(offset, codePoint);
+  } else {
+    decode(byteOffsetOf(target), codePoint);
+  }
+  return codePoint;
+}
+
+void Utf8CharStream::seek(size_t index) {
+  if (index <= position) {
+    position = index;
+    byteOffset = byteOffsetOf(index);
+    return;
+  }
+  // seeks forward go through consume so the byte offset stays in sync, just like ANTLRInputStream
+  index = std::min(index, codePointCount);
+  if (index - position > CHECKPOINT_INTERVAL) {
+    position = index;
+    byteOffset = byteOffsetOf(index);
+    return;
+  }
+  while (position < index) {
+    consume();
+  }
+}
+
+std::string Utf8CharStream::getSourceName() const {
+  if (sourceName.empty()) {
+    return antlr4::IntStream::UNKNOWN_SOURCE_NAME;
+  }
+  return sourceName;
+}
+
+std::string_view Utf8CharStream::getTextView(size_t start, size_t stop) const {
+  if (start >= codePointCount || stop < start) {
+    return {};
+  }
+  if (stop >= codePointCount) {
+    stop = codePointCount - 1;
+  }
+  size_t startOffset = byteOffsetOf(start);
+  size_t stopOffset = byteOffsetOf(stop + 1);
+  return data.substr(startOffset, stopOffset - startOffset);
+}
+
+std::string Utf8CharStream::getText(const antlr4::misc::Interval& interval) {
+  if (interval.a < 0 || interval.b < 0) {
+    return "";
+  }
+  return std::string(getTextView(static_cast<size_t>(interval.a), static_cast<size_t>(interval.b)));
+}
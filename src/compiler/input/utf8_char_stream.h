@@ -0,0 +1,56 @@
+#ifndef UTF8_CHAR_STREAM_H
+#define UTF8_CHAR_STREAM_H
+
+#include <antlr4-runtime.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// antlr char stream reading code points straight out of utf-8 bytes, instead of ANTLRInputStream's utf-32 copy
+// the bytes aren't owned and must outlive the stream, the tokens and the parse tree (token text is sliced from them)
+//
+// indexes are code points like every antlr stream. pure ascii input (the usual case) maps them 1:1 to bytes,
+// otherwise the byte offset of every 64th code point is kept so seeks only decode a short run
+// invalid utf-8 is read leniently, each bad byte becomes one U+FFFD
+class Utf8CharStream : public antlr4::CharStream {
+public:
+  Utf8CharStream(std::string_view data, const std::string& sourceName = "");
+
+  void consume() override;
+  size_t LA(ssize_t i) override;
+  // the whole input is always available, nothing to mark
+  ssize_t mark() override { return -1; }
+  void release(ssize_t) override {}
+  size_t index() override { return position; }
+  void seek(size_t index) override;
+  size_t size() override { return codePointCount; }
+  std::string getSourceName() const override;
+
+  std::string getText(const antlr4::misc::Interval& interval) override;
+  // same as getText without building a string, for callers that can work on a view
+  std::string_view getTextView(size_t start, size_t stop) const;
+  std::string toString() const override { return std::string(data); }
+
+  bool isAscii() const { return ascii; }
+
+private:
+  static constexpr size_t CHECKPOINT_INTERVAL = 64;
+
+  std::string_view data;
+  std::string sourceName;
+  bool ascii = true;
+  size_t codePointCount = 0;
+  // byte offset of code point k * CHECKPOINT_INTERVAL, only built for non-ascii input
+  std::vector<size_t> checkpoints;
+
+  // current code point and its byte offset
+  size_t position = 0;
+  size_t byteOffset = 0;
+
+  static bool allAscii(std::string_view bytes);
+  // decodes the code point at offset, returns its length in bytes
+  size_t decode(size_t offset, size_t& codePoint) const;
+  size_t byteOffsetOf(size_t codePointIndex) const;
+};
+
+#endif // UTF8_CHAR_STREAM_H
@@ -10,11 +10,11 @@
 struct IRClass {
   std::string name;
   std::vector<std::shared_ptr<IRInstruction>> instructions;
-  std::vector<std::shared_ptr<FunctionSymbol>> methods;
-  std::vector<std::shared_ptr<VariableSymbol>> variables;
-  std::unordered_map<std::shared_ptr<VariableSymbol>, std::string> defaultValues;
+  std::vector<FunctionSymbol*> methods;
+  std::vector<VariableSymbol*> variables;
+  std::unordered_map<VariableSymbol*, std::string> defaultValues;
 
-  std::shared_ptr<FunctionSymbol> getMethod(const std::string& name);
+  FunctionSymbol* getMethod(const std::string& name);
 };
 
 #endif // IR_CLASS_H
@@ -1,13 +1,13 @@
 #include "ir_instruction.h"
 #include "../symbols/symbol.h"
 
-IRCallInstruction::IRCallInstruction(const std::shared_ptr<FunctionSymbol>& function) : function(function) {}
+IRCallInstruction::IRCallInstruction(FunctionSymbol* function) : IRInstruction(KIND), function(function) {}
 
 std::string IRCallInstruction::toString() const {
   // temp
   return "call " + function->getMangledName();
 }
 
-IRRawInstruction::IRRawInstruction(const std::string& instruction) : instruction(instruction) {}
+IRRawInstruction::IRRawInstruction(const std::string& instruction) : IRInstruction(KIND), instruction(instruction) {}
 
 std::string IRRawInstruction::toString() const { return instruction; }
@@ -8,23 +8,39 @@ class FunctionSymbol;
 
 class IRInstruction {
 public:
+  enum class InstructionKind { CALL, RAW };
+
+  explicit IRInstruction(InstructionKind kind) : kind(kind) {}
   virtual ~IRInstruction() = default;
+  InstructionKind getKind() const { return kind; }
   virtual std::string toString() const = 0;
+
+private:
+  InstructionKind kind;
 };
 
 class IRCallInstruction : public IRInstruction {
 public:
-  IRCallInstruction(const std::shared_ptr<FunctionSymbol>& function);
-  std::shared_ptr<FunctionSymbol> function;
+  static constexpr InstructionKind KIND = InstructionKind::CALL;
+
+  IRCallInstruction(FunctionSymbol* function);
+  FunctionSymbol* function = nullptr;
 
   std::string toString() const override;
 };
 
 class IRRawInstruction : public IRInstruction {
 public:
+  static constexpr InstructionKind KIND = InstructionKind::RAW;
+
   IRRawInstruction(const std::string& instruction);
   std::string instruction;
   std::string toString() const override;
 };
 
+// checked downcast from the kind tag, null if instruction isn't a T, without copying a shared_ptr
+template <typename T> T* instructionCast(IRInstruction* instruction) {
+  return instruction != nullptr && instruction->getKind() == T::KIND ? static_cast<T*>(instruction) : nullptr;
+}
+
 #endif // IR_INSTRUCTION_H
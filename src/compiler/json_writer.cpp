@@ -0,0 +1,144 @@
+#include "json_writer.h"
+#include <cstdio>
+
+JsonWriter::JsonWriter(std::ostream& out, bool compact) : out(out), compact(compact) {
+  buffer.reserve(FLUSH_BYTES + 1024);
+}
+
+JsonWriter::~JsonWriter() {
+  flush();
+}
+
+void JsonWriter::beginObject() {
+  beforeValue();
+  buffer += '{';
+  hasMembers.push_back(false);
+}
+
+void JsonWriter::endObject() {
+  close('}');
+}
+
+void JsonWriter::beginArray() {
+  beforeValue();
+  buffer += '[';
+  hasMembers.push_back(false);
+}
+
+void JsonWriter::endArray() {
+  close(']');
+}
+
+void JsonWriter::key(std::string_view name) {
+  beforeValue();
+  writeString(name);
+  buffer += compact ? ":" : ": ";
+  afterKey = true;
+}
+
+void JsonWriter::value(std::string_view text) {
+  beforeValue();
+  writeString(text);
+  maybeFlush();
+}
+
+void JsonWriter::value(bool flag) {
+  beforeValue();
+  buffer += flag ? "true" : "false";
+}
+
+void JsonWriter::value(int64_t number) {
+  beforeValue();
+  buffer += std::to_string(number);
+}
+
+void JsonWriter::value(const void* pointer) {
+  char text[2 + 2 * sizeof(void*) + 1];
+  std::snprintf(text, sizeof(text), "%p", pointer);
+  value(std::string_view(text));
+}
+
+void JsonWriter::flush() {
+  if (!buffer.empty()) {
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+  }
+  out.flush();
+}
+
+void JsonWriter::beforeValue() {
+  // a member's value follows its key on the same line
+  if (afterKey) {
+    afterKey = false;
+    return;
+  }
+  if (hasMembers.empty()) {
+    return;
+  }
+  if (hasMembers.back()) {
+    buffer += ',';
+  }
+  hasMembers.back() = true;
+  newline();
+}
+
+void JsonWriter::close(char bracket) {
+  bool hadMembers = hasMembers.back();
+  hasMembers.pop_back();
+  // empty containers stay on one line
+  if (hadMembers) {
+    newline();
+  }
+  buffer += bracket;
+  // the document ends with a newline in both modes
+  if (hasMembers.empty()) {
+    buffer += '\n';
+  }
+  maybeFlush();
+}
+
+void JsonWriter::newline() {
+  if (!compact) {
+    buffer += '\n';
+    buffer.append(2 * hasMembers.size(), ' ');
+  }
+}
+
+void JsonWriter::writeString(std::string_view text) {
+  buffer += '"';
+  for (char c : text) {
+    switch (c) {
+    case '"':
+      buffer += "\\\"";
+      break;
+    case '\\':
+      buffer += "\\\\";
+      break;
+    case '\n':
+      buffer += "\\n";
+      break;
+    case '\t':
+      buffer += "\\t";
+      break;
+    case '\r':
+      buffer += "\\r";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[7];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+        buffer += escaped;
+      } else {
+        buffer += c;
+      }
+    }
+  }
+  buffer += '"';
+}
+
+void JsonWriter::maybeFlush() {
+  if (buffer.size() >= FLUSH_BYTES) {
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// writes a JSON document front to back into a buffer that is handed to out in large chunks
+// indented two spaces per level, or on one line in compact mode
+class JsonWriter {
+public:
+  explicit JsonWriter(std::ostream& out, bool compact = false);
+  // flushes whatever is still buffered
+  ~JsonWriter();
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+  // the next value or container is this member of the current object
+  void key(std::string_view name);
+
+  void value(std::string_view text);
+  void value(const char* text) { value(std::string_view(text)); }
+  void value(bool flag);
+  void value(int64_t number);
+  void value(int number) { value(static_cast<int64_t>(number)); }
+  // pointers are written as a string, for ids that only have to match within one document
+  void value(const void* pointer);
+
+  void flush();
+
+private:
+  static constexpr size_t FLUSH_BYTES = 64 * 1024;
+
+  std::ostream& out;
+  bool compact;
+  std::string buffer;
+  // whether each open container has a member yet
+  std::vector<bool> hasMembers;
+  bool afterKey = false;
+
+  void beforeValue();
+  void close(char bracket);
+  void newline();
+  void writeString(std::string_view text);
+  void maybeFlush();
+};
+
+#endif // JSON_WRITER_H
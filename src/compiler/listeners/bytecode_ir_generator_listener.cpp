@@ -1,46 +1,85 @@
 #include "bytecode_ir_generator_listener.h"
 #include "../bytecode_compiler.h"
+#include "../input/arena_token_factory.h"
 #include "../primitive_wrapper_generator.h"
+#include "../symbols/type_table.h"
 #include "type_checking_listener.h"
 
+namespace {
+
+// the variable an identifier names in a scope, looked up by the identifier's atom
+VariableSymbol* resolveVariable(Scope* scope, antlr4::tree::TerminalNode* identifier) {
+  return dynamic_cast<VariableSymbol*>(scope->resolve(identifierAtom(identifier, scope->getAtoms())));
+}
+
+} // namespace
+
 BytecodeIRGeneratorListener::BytecodeIRGeneratorListener(
-    ErrorReporter& errorReporter, std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& scopes,
-    std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>>& expressionTypes,
-    std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>>& resolvedMethodSymbols,
-    std::unordered_set<antlr4::ParserRuleContext*>& expectingStringConversion,
+    ErrorReporter& errorReporter, const AnalysisResult& analysis,
     std::unordered_map<PrimitiveType::PrimitiveKind, std::shared_ptr<IRClass>>& primitiveWrappers,
-    std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>>& constructorMap)
-    : errorReporter(errorReporter), scopes(scopes), expressionTypes(expressionTypes),
-      resolvedMethodSymbols(resolvedMethodSymbols), expectingStringConversion(expectingStringConversion),
-      primitiveWrappers(primitiveWrappers), constructorMap(constructorMap) {}
-
-std::shared_ptr<Scope> BytecodeIRGeneratorListener::getCurrentScope(antlr4::ParserRuleContext* ctx) const {
-  auto it = scopes.find(ctx);
-  if (it != scopes.end()) {
-    return it->second;
-  }
-  // try to find the scope in the parent context
-  if (ctx->parent) {
-    return getCurrentScope(dynamic_cast<antlr4::ParserRuleContext*>(ctx->parent));
-  }
-  return nullptr;
+    ObjectArena& objects)
+    : errorReporter(errorReporter), nodeScopes(analysis.nodeScopes), expressionTypes(analysis.expressionTypes),
+      resolvedMethodSymbols(analysis.resolvedMethodSymbols),
+      expectingStringConversion(analysis.expectingStringConversion), nodeRoles(analysis.nodeRoles),
+      primitiveWrappers(primitiveWrappers), objects(objects), constructorMap(analysis.constructorMap) {}
+
+Scope* BytecodeIRGeneratorListener::getCurrentScope(antlr4::ParserRuleContext* ctx) const {
+  return nodeScopes.get(ctx);
 }
 
 std::string BytecodeIRGeneratorListener::generateLabel() { return "L" + std::to_string(labelCounter++); }
 
 const std::vector<std::shared_ptr<IRClass>>& BytecodeIRGeneratorListener::getClasses() const { return classes; }
 
-int BytecodeIRGeneratorListener::assignLocalIndex(const std::shared_ptr<VariableSymbol>& variable) {
+void BytecodeIRGeneratorListener::setClassHandler(ClassHandler handler) { classHandler = std::move(handler); }
+
+void BytecodeIRGeneratorListener::completeClass(const std::shared_ptr<IRClass>& irClass) {
+  // without a handler the class was kept when it was opened
+  if (classHandler) {
+    classHandler(irClass);
+  }
+}
+
+void BytecodeIRGeneratorListener::setMethodHandler(MethodHandler handler) { methodHandler = std::move(handler); }
+
+void BytecodeIRGeneratorListener::completeMethod(const std::shared_ptr<IRClass>& irClass, FunctionSymbol* method) {
+  if (methodHandler) {
+    methodHandler(irClass, method);
+  }
+}
+
+FunctionSymbol* BytecodeIRGeneratorListener::getJvmConstructor(const std::string& structName) {
+  auto existing = jvmConstructors.find(structName);
+  if (existing != jvmConstructors.end()) {
+    return existing->second;
+  }
+  auto analyzed = constructorMap.find(structName);
+  if (analyzed == constructorMap.end() || !analyzed->second) {
+    throw std::runtime_error("Constructor not found for struct: " + structName);
+  }
+  auto constructor = objects.create<FunctionSymbol>("<init>", analyzed->second->definedAtLine,
+                                                    analyzed->second->definedAtColumn, analyzed->second->scope);
+  constructor->isStructMethod = true;
+  constructor->isDefined = true;
+  constructor->parameters = analyzed->second->parameters;
+  // the struct type names the class to invoke <init> on, the signature makes it return void
+  constructor->returnTypes = analyzed->second->returnTypes;
+  constructor->seal();
+  jvmConstructors[structName] = constructor;
+  return constructor;
+}
+
+int BytecodeIRGeneratorListener::assignLocalIndex(VariableSymbol* variable) {
   if (variable->localIndex == -1) {
     variable->localIndex = currentLocalIndex++;
   }
   return variable->localIndex;
 }
 
-int BytecodeIRGeneratorListener::getLocalIndex(const std::string& variableName, std::shared_ptr<Scope> scope) {
+int BytecodeIRGeneratorListener::getLocalIndex(const std::string& variableName, Scope* scope) {
   auto symbol = scope->resolve(variableName);
   if (symbol && symbol->type == SymbolType::VARIABLE) {
-    auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(symbol);
+    auto varSymbol = dynamic_cast<VariableSymbol*>(symbol);
     return assignLocalIndex(varSymbol);
   }
   // should never reach here if semantic analysis is working properly
@@ -48,12 +87,12 @@ int BytecodeIRGeneratorListener::getLocalIndex(const std::string& variableName,
 }
 
 void BytecodeIRGeneratorListener::generateStringConversion(antlr4::ParserRuleContext* ctx) {
-  if (expectingStringConversion.count(ctx)) {
+  if (expectingStringConversion.contains(ctx)) {
     // get the type of the expression
-    auto type = expressionTypes[ctx];
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
-    auto pointerType = std::dynamic_pointer_cast<PointerType>(type);
-    auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(type);
+    auto type = expressionTypes.get(ctx);
+    auto primitiveType = typeCast<PrimitiveType>(type);
+    auto pointerType = typeCast<PointerType>(type);
+    auto userDefinedType = typeCast<UserDefinedType>(type);
 
     if (pointerType) {
       auto rawInstruction =
@@ -101,7 +140,9 @@ void BytecodeIRGeneratorListener::enterProgram(cgullParser::ProgramContext* ctx)
   if (scope) {
     auto mainClass = std::make_shared<IRClass>();
     mainClass->name = "Main";
-    classes.push_back(mainClass);
+    if (!classHandler) {
+      classes.push_back(mainClass);
+    }
     currentClassStack.push(mainClass);
   } else {
     throw std::runtime_error("No scope found for program context");
@@ -110,6 +151,7 @@ void BytecodeIRGeneratorListener::enterProgram(cgullParser::ProgramContext* ctx)
 
 void BytecodeIRGeneratorListener::exitProgram(cgullParser::ProgramContext* ctx) {
   if (!currentClassStack.empty()) {
+    completeClass(currentClassStack.top());
     currentClassStack.pop();
   }
 }
@@ -123,7 +165,7 @@ void BytecodeIRGeneratorListener::enterFunction_definition(cgullParser::Function
     std::string specialToken = ctx->FN_SPECIAL() ? ctx->FN_SPECIAL()->getText() : "";
     std::string identifier = specialToken + identifierName;
     auto functionSymbol = scope->resolve(identifier);
-    currentFunction = std::dynamic_pointer_cast<FunctionSymbol>(functionSymbol);
+    currentFunction = dynamic_cast<FunctionSymbol*>(functionSymbol);
     auto currentClass = currentClassStack.top();
     currentClass->methods.push_back(currentFunction);
 
@@ -156,6 +198,7 @@ void BytecodeIRGeneratorListener::enterFunction_definition(cgullParser::Function
 
 void BytecodeIRGeneratorListener::exitFunction_definition(cgullParser::Function_definitionContext* ctx) {
   if (currentFunction) {
+    completeMethod(currentClassStack.top(), currentFunction);
     currentFunction = nullptr;
   }
 }
@@ -165,7 +208,7 @@ void BytecodeIRGeneratorListener::enterParameter(cgullParser::ParameterContext*
   auto scope = getCurrentScope(ctx);
   if (scope) {
     auto parameterSymbol = scope->resolve(ctx->IDENTIFIER()->getText());
-    auto parameterVarSymbol = std::dynamic_pointer_cast<VariableSymbol>(parameterSymbol);
+    auto parameterVarSymbol = dynamic_cast<VariableSymbol*>(parameterSymbol);
     assignLocalIndex(parameterVarSymbol);
   } else {
     throw std::runtime_error("No scope found for parameter context");
@@ -181,7 +224,7 @@ void BytecodeIRGeneratorListener::enterFunction_call(cgullParser::Function_callC
     std::string identifier = specialToken + identifierName;
     // try to see if its a constructor first
     auto constructor = constructorMap.find(identifier);
-    std::shared_ptr<FunctionSymbol> functionSymbol;
+    FunctionSymbol* functionSymbol = nullptr;
     if (constructor != constructorMap.end()) {
       functionSymbol = constructor->second;
       // we need a new instruction with dup to create a new object, will be called later in exitFunction_call
@@ -191,11 +234,10 @@ void BytecodeIRGeneratorListener::enterFunction_call(cgullParser::Function_callC
       currentFunction->instructions.push_back(dupInstruction);
     } else if (lastFieldType) {
       // is part of a field access, check the struct scope instead
-      auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(lastFieldType);
-      functionSymbol =
-          std::dynamic_pointer_cast<FunctionSymbol>(userDefinedType->getTypeSymbol()->scope->resolve(identifier));
+      auto userDefinedType = typeCast<UserDefinedType>(lastFieldType);
+      functionSymbol = dynamic_cast<FunctionSymbol*>(userDefinedType->getTypeSymbol()->scope->resolve(identifier));
     } else {
-      functionSymbol = std::dynamic_pointer_cast<FunctionSymbol>(scope->resolve(identifier));
+      functionSymbol = dynamic_cast<FunctionSymbol*>(scope->resolve(identifier));
     }
     if (!functionSymbol) {
       throw std::runtime_error("Function not found: " + identifier);
@@ -223,17 +265,16 @@ void BytecodeIRGeneratorListener::exitFunction_call(cgullParser::Function_callCo
     std::string specialToken = ctx->FN_SPECIAL() ? ctx->FN_SPECIAL()->getText() : "";
     std::string identifier = specialToken + identifierName;
     auto constructor = constructorMap.find(identifier);
-    std::shared_ptr<FunctionSymbol> calledFunction;
+    FunctionSymbol* calledFunction = nullptr;
     if (constructor != constructorMap.end()) {
-      calledFunction = constructor->second;
+      calledFunction = getJvmConstructor(identifier);
     } else if (lastFieldType) {
       // is part of a field access, check the struct scope instead
-      auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(lastFieldType);
-      calledFunction =
-          std::dynamic_pointer_cast<FunctionSymbol>(userDefinedType->getTypeSymbol()->scope->resolve(identifier));
+      auto userDefinedType = typeCast<UserDefinedType>(lastFieldType);
+      calledFunction = dynamic_cast<FunctionSymbol*>(userDefinedType->getTypeSymbol()->scope->resolve(identifier));
     } else {
       // check scope as normal
-      calledFunction = std::dynamic_pointer_cast<FunctionSymbol>(scope->resolve(identifier));
+      calledFunction = dynamic_cast<FunctionSymbol*>(scope->resolve(identifier));
     }
     if (!calledFunction) {
       throw std::runtime_error("Function not found: " + identifier);
@@ -247,120 +288,76 @@ void BytecodeIRGeneratorListener::exitFunction_call(cgullParser::Function_callCo
 }
 
 void BytecodeIRGeneratorListener::enterExpression(cgullParser::ExpressionContext* ctx) {
-  auto parent = ctx->parent;
-  if (!parent)
-    return;
-  auto forStmt = dynamic_cast<cgullParser::For_statementContext*>(parent);
-  // first expression is the condition
-  if (forStmt && forStmt->expression(0) == ctx) {
-    auto it = forLabelsMap.find(forStmt);
-    if (it != forLabelsMap.end()) {
-      auto& labels = it->second;
-      // place label for the condition
-      auto labelInst = std::make_shared<IRRawInstruction>(labels.conditionLabel + ":");
+  NodeRole role = nodeRoles.get(ctx);
+  switch (role.kind) {
+  case NodeRole::Kind::FOR_CONDITION:
+  case NodeRole::Kind::FOR_UPDATE: {
+    auto* it = forLabelsMap.find(static_cast<antlr4::ParserRuleContext*>(ctx->parent));
+    if (it != nullptr) {
+      auto& labels = *it;
+      // place label for the condition or the update expr
+      const auto& label = role.kind == NodeRole::Kind::FOR_CONDITION ? labels.conditionLabel : labels.updateLabel;
+      auto labelInst = std::make_shared<IRRawInstruction>(label + ":");
       currentFunction->instructions.push_back(labelInst);
     }
+    break;
   }
-  if (forStmt && forStmt->expression(1) == ctx) {
-    auto it = forLabelsMap.find(forStmt);
-    if (it != forLabelsMap.end()) {
-      auto& labels = it->second;
-      // place label for the update expr
-      auto labelInst = std::make_shared<IRRawInstruction>(labels.updateLabel + ":");
-      currentFunction->instructions.push_back(labelInst);
-    }
+  case NodeRole::Kind::ARRAY_ELEMENT: {
+    // part of an array_expression, dup the array ref and place the index
+    auto rawInstruction = std::make_shared<IRRawInstruction>("dup");
+    currentFunction->instructions.push_back(rawInstruction);
+    auto indexInst = std::make_shared<IRRawInstruction>("ldc " + std::to_string(role.position));
+    currentFunction->instructions.push_back(indexInst);
+    break;
   }
-  // check if part of expression_list that is part of an array_expression, dup the array ref and place the index
-  auto expressionList = dynamic_cast<cgullParser::Expression_listContext*>(ctx->parent);
-  if (expressionList) {
-    auto arrayExpr = dynamic_cast<cgullParser::Array_expressionContext*>(expressionList->parent);
-    if (arrayExpr) {
-      auto rawInstruction = std::make_shared<IRRawInstruction>("dup");
-      currentFunction->instructions.push_back(rawInstruction);
-      // find the index of the expression in the expression list
-      for (size_t i = 0; i < expressionList->expression().size(); ++i) {
-        if (expressionList->expression(i) == ctx) {
-          auto indexInst = std::make_shared<IRRawInstruction>("ldc " + std::to_string(i));
-          currentFunction->instructions.push_back(indexInst);
-          break;
-        }
-      }
-    }
+  default:
+    break;
   }
 }
 
 void BytecodeIRGeneratorListener::exitExpression(cgullParser::ExpressionContext* ctx) {
   generateStringConversion(ctx);
 
-  // check if this expression is part of an if statement condition so we can place jumps
-  auto parent = ctx->parent;
-  if (!parent)
-    return;
-  auto ifStmt = dynamic_cast<cgullParser::If_statementContext*>(parent);
-  if (ifStmt) {
-    // only process the first condition
-    if (ifStmt->expression(0) == ctx) {
-      auto it = ifLabelsMap.find(ifStmt);
-      if (it != ifLabelsMap.end()) {
-        auto& labels = it->second;
-        // if condition is false, jump to the first elseif/else branch or end
-        std::string jumpTarget = labels.conditionLabels.size() > 1 ? labels.conditionLabels[1] : labels.endIfLabel;
-
-        auto jumpInst = std::make_shared<IRRawInstruction>("ifeq " + jumpTarget);
-        currentFunction->instructions.push_back(jumpInst);
-      }
-    }
-    // handle elseif conditions
-    else {
-      // find which elseif condition this is
-      for (size_t i = 0; i < ifStmt->ELSE_IF().size(); ++i) {
-        // +1 because index 0 is the main if condition
-        if (ifStmt->expression(i + 1) == ctx) {
-          auto it = ifLabelsMap.find(ifStmt);
-          if (it != ifLabelsMap.end()) {
-            auto& labels = it->second;
-
-            // if this elseif condition is false, jump to the next elseif/else branch or end
-            std::string jumpTarget;
-            if (i + 2 < labels.conditionLabels.size()) {
-              jumpTarget = labels.conditionLabels[i + 2];
-            } else {
-              jumpTarget = labels.endIfLabel;
-            }
-
-            auto jumpInst = std::make_shared<IRRawInstruction>("ifeq " + jumpTarget);
-            currentFunction->instructions.push_back(jumpInst);
-            break;
-          }
-        }
-      }
+  NodeRole role = nodeRoles.get(ctx);
+  auto parent = static_cast<antlr4::ParserRuleContext*>(ctx->parent);
+  switch (role.kind) {
+  case NodeRole::Kind::IF_CONDITION: {
+    // place the jump for an if or elseif condition
+    auto* it = ifLabelsMap.find(parent);
+    if (it != nullptr) {
+      auto& labels = *it;
+      // if the condition is false, jump to the next elseif/else branch or end
+      size_t next = role.position + 1;
+      std::string jumpTarget = next < labels.conditionLabels.size() ? labels.conditionLabels[next] : labels.endIfLabel;
+      auto jumpInst = std::make_shared<IRRawInstruction>("ifeq " + jumpTarget);
+      currentFunction->instructions.push_back(jumpInst);
     }
+    break;
   }
-  auto whileStmt = dynamic_cast<cgullParser::While_statementContext*>(parent);
-  if (whileStmt) {
+  case NodeRole::Kind::WHILE_CONDITION: {
     // place the jump to the end of the loop if the condition is false
-    auto it = whileLabelsMap.find(whileStmt);
-    if (it != whileLabelsMap.end()) {
-      auto& labels = it->second;
+    auto* it = whileLabelsMap.find(parent);
+    if (it != nullptr) {
+      auto& labels = *it;
       auto jumpInst = std::make_shared<IRRawInstruction>("ifeq " + labels.endLabel);
       currentFunction->instructions.push_back(jumpInst);
     }
+    break;
   }
-  auto untilStmt = dynamic_cast<cgullParser::Until_statementContext*>(parent);
-  if (untilStmt) {
-    auto it = untilLabelsMap.find(untilStmt);
-    if (it != untilLabelsMap.end()) {
-      auto& labels = it->second;
+  case NodeRole::Kind::UNTIL_CONDITION: {
+    auto* it = untilLabelsMap.find(parent);
+    if (it != nullptr) {
+      auto& labels = *it;
       // this is the expression after the branch block, jump to the top of the loop if the condition is false
       auto jumpInst = std::make_shared<IRRawInstruction>("ifeq " + labels.startLabel);
       currentFunction->instructions.push_back(jumpInst);
     }
+    break;
   }
-  auto forStmt = dynamic_cast<cgullParser::For_statementContext*>(parent);
-  if (forStmt && forStmt->expression(0) == ctx) {
-    auto it = forLabelsMap.find(forStmt);
-    if (it != forLabelsMap.end()) {
-      auto& labels = it->second;
+  case NodeRole::Kind::FOR_CONDITION: {
+    auto* it = forLabelsMap.find(parent);
+    if (it != nullptr) {
+      auto& labels = *it;
       // jump to the end of the loop if false, this is the condition, otherwise jump to the branch block
       auto jumpInst = std::make_shared<IRRawInstruction>("ifeq " + labels.endLabel);
       currentFunction->instructions.push_back(jumpInst);
@@ -368,11 +365,12 @@ void BytecodeIRGeneratorListener::exitExpression(cgullParser::ExpressionContext*
       auto jumpInst2 = std::make_shared<IRRawInstruction>("goto " + labels.startLabel);
       currentFunction->instructions.push_back(jumpInst2);
     }
+    break;
   }
-  if (forStmt && forStmt->expression(1) == ctx) {
-    auto it = forLabelsMap.find(forStmt);
-    if (it != forLabelsMap.end()) {
-      auto& labels = it->second;
+  case NodeRole::Kind::FOR_UPDATE: {
+    auto* it = forLabelsMap.find(parent);
+    if (it != nullptr) {
+      auto& labels = *it;
       // pop the value from the stack, we aren't using it
       auto popInst = std::make_shared<IRRawInstruction>("pop");
       currentFunction->instructions.push_back(popInst);
@@ -380,55 +378,45 @@ void BytecodeIRGeneratorListener::exitExpression(cgullParser::ExpressionContext*
       auto jumpInst = std::make_shared<IRRawInstruction>("goto " + labels.conditionLabel);
       currentFunction->instructions.push_back(jumpInst);
     }
+    break;
   }
-  // check if parent is index_expression and not the last expression in the index_expression, if so place an aaload
-  // instruction
-  auto indexExpr = dynamic_cast<cgullParser::Index_expressionContext*>(parent);
-  if (indexExpr && indexExpr->expression(indexExpr->expression().size() - 1) != ctx) {
+  case NodeRole::Kind::INDEX: {
+    // not the last expression of the index_expression, load the next array
     auto rawInstruction = std::make_shared<IRRawInstruction>("aaload");
     currentFunction->instructions.push_back(rawInstruction);
-  }
-  // if its the last expression and not used in an assignment, load based on type (e.g. iaload, aaload, etc.)
-  if (indexExpr && indexExpr->expression(indexExpr->expression().size() - 1) == ctx) {
-    // check if we're in an assignment context by walking up the parent chain
-    bool isAssignment = false;
-    bool isLeftSide = false;
-    auto current = ctx->parent;
-    while (current) {
-      if (auto assignmentCtx = dynamic_cast<cgullParser::Assignment_statementContext*>(current)) {
-        isAssignment = true;
-        // check if this index expression is the left side of the assignment
-        isLeftSide = assignmentCtx->index_expression() == indexExpr;
-        break;
-      }
-      current = current->parent;
-    }
-
-    if (!isAssignment || (!lastFieldType && !isLeftSide)) {
-      auto type = expressionTypes[indexExpr];
+    break;
+  }
+  case NodeRole::Kind::LAST_INDEX: {
+    // the last expression, if it isn't used in an assignment load based on type (e.g. iaload, aaload, etc.)
+    NodeRole indexRole = nodeRoles.get(parent);
+    bool isLeftSide = indexRole.kind == NodeRole::Kind::ASSIGNMENT_TARGET;
+    if (!indexRole.inAssignment || (!lastFieldType && !isLeftSide)) {
+      auto type = expressionTypes.get(parent);
       if (!type) {
-        throw std::runtime_error("Type not found for expression: " + indexExpr->getText());
+        throw std::runtime_error("Type not found for expression: " + parent->getText());
       }
       auto rawInstruction = std::make_shared<IRRawInstruction>(getArrayOperationInstruction(type, false));
       currentFunction->instructions.push_back(rawInstruction);
     }
+    break;
   }
-  // check if part of expression_list that is part of an array_expression, we will need to store based on type
-  auto expressionList = dynamic_cast<cgullParser::Expression_listContext*>(ctx->parent);
-  if (expressionList) {
-    auto arrayExpr = dynamic_cast<cgullParser::Array_expressionContext*>(expressionList->parent);
-    if (arrayExpr) {
-      auto arrayType = std::dynamic_pointer_cast<ArrayType>(expressionTypes[arrayExpr]);
-      if (!arrayType) {
-        throw std::runtime_error("Type not found for expression: " + arrayExpr->getText());
-      }
-      auto type = arrayType->getElementType();
-      if (!type) {
-        throw std::runtime_error("Type not found for expression: " + arrayExpr->getText());
-      }
-      auto rawInstruction = std::make_shared<IRRawInstruction>(getArrayOperationInstruction(type, true));
-      currentFunction->instructions.push_back(rawInstruction);
+  case NodeRole::Kind::ARRAY_ELEMENT: {
+    // part of an array_expression, store based on the element type
+    auto arrayExpr = static_cast<antlr4::ParserRuleContext*>(parent->parent);
+    auto arrayType = typeCast<ArrayType>(expressionTypes.get(arrayExpr));
+    if (!arrayType) {
+      throw std::runtime_error("Type not found for expression: " + arrayExpr->getText());
+    }
+    auto type = arrayType->getElementType();
+    if (!type) {
+      throw std::runtime_error("Type not found for expression: " + arrayExpr->getText());
     }
+    auto rawInstruction = std::make_shared<IRRawInstruction>(getArrayOperationInstruction(type, true));
+    currentFunction->instructions.push_back(rawInstruction);
+    break;
+  }
+  default:
+    break;
   }
 }
 
@@ -440,8 +428,8 @@ void BytecodeIRGeneratorListener::enterBase_expression(cgullParser::Base_express
 
   if (ctx->AND_OP() || ctx->OR_OP()) {
     // reserve and setup metadata for logical expressions
-    auto it = expressionLabelsMap.find(ctx);
-    if (it == expressionLabelsMap.end()) {
+    auto* it = expressionLabelsMap.find(ctx);
+    if (it == nullptr) {
       handleLogicalExpression(ctx);
     }
   }
@@ -450,9 +438,9 @@ void BytecodeIRGeneratorListener::enterBase_expression(cgullParser::Base_express
   if (ctx->literal()) {
     // check what type of literal it is from our expression types
     auto literal = ctx->literal();
-    auto type = expressionTypes[literal];
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
-    auto pointerType = std::dynamic_pointer_cast<PointerType>(type);
+    auto type = expressionTypes.get(literal);
+    auto primitiveType = typeCast<PrimitiveType>(type);
+    auto pointerType = typeCast<PointerType>(type);
 
     if (primitiveType) {
       PrimitiveType::PrimitiveKind primitiveKind = primitiveType->getPrimitiveKind();
@@ -512,8 +500,8 @@ void BytecodeIRGeneratorListener::enterBase_expression(cgullParser::Base_express
 
 void BytecodeIRGeneratorListener::exitBase_expression(cgullParser::Base_expressionContext* ctx) {
   // handle binary operations after both operands have been processed
-  auto type = expressionTypes[ctx];
-  auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
+  auto type = expressionTypes.get(ctx);
+  auto primitiveType = typeCast<PrimitiveType>(type);
   if (!primitiveType) {
     generateStringConversion(ctx);
     return;
@@ -603,10 +591,10 @@ void BytecodeIRGeneratorListener::exitBase_expression(cgullParser::Base_expressi
       // handle strings
       auto leftExpr = ctx->base_expression(0);
       auto rightExpr = ctx->base_expression(1);
-      auto leftType = expressionTypes[leftExpr];
-      auto rightType = expressionTypes[rightExpr];
-      auto leftPrimitiveType = std::dynamic_pointer_cast<PrimitiveType>(leftType);
-      auto rightPrimitiveType = std::dynamic_pointer_cast<PrimitiveType>(rightType);
+      auto leftType = expressionTypes.get(leftExpr);
+      auto rightType = expressionTypes.get(rightExpr);
+      auto leftPrimitiveType = typeCast<PrimitiveType>(leftType);
+      auto rightPrimitiveType = typeCast<PrimitiveType>(rightType);
 
       if (leftPrimitiveType && rightPrimitiveType &&
           (leftPrimitiveType->getPrimitiveKind() == PrimitiveType::PrimitiveKind::STRING ||
@@ -680,8 +668,7 @@ void BytecodeIRGeneratorListener::exitBase_expression(cgullParser::Base_expressi
         }
       } else if (leftType->getKind() == Type::TypeKind::USER_DEFINED ||
                  (leftType->getKind() == Type::TypeKind::POINTER &&
-                  std::dynamic_pointer_cast<PointerType>(leftType)->getPointedType()->getKind() ==
-                      Type::TypeKind::USER_DEFINED)) {
+                  typeCast<PointerType>(leftType)->getPointedType()->getKind() == Type::TypeKind::USER_DEFINED)) {
         // for user-defined types, we can only compare with nullptr using == and !=
         if (ctx->EQUAL_OP()) {
           auto rawInstruction = std::make_shared<IRRawInstruction>("if_acmpeq " + trueLabel);
@@ -712,13 +699,13 @@ void BytecodeIRGeneratorListener::exitBase_expression(cgullParser::Base_expressi
       currentFunction->instructions.push_back(endLabelInstruction);
     } else if (ctx->AND_OP()) {
       // retrieve the labels for this expression
-      auto it = expressionLabelsMap.find(ctx);
-      if (it == expressionLabelsMap.end()) {
+      auto* it = expressionLabelsMap.find(ctx);
+      if (it == nullptr) {
         handleLogicalExpression(ctx);
         it = expressionLabelsMap.find(ctx);
       }
 
-      ExpressionLabels& labels = it->second;
+      ExpressionLabels& labels = *it;
 
       // only place the exit label if we've processed the expression
       if (labels.processed) {
@@ -728,13 +715,13 @@ void BytecodeIRGeneratorListener::exitBase_expression(cgullParser::Base_expressi
 
     } else if (ctx->OR_OP()) {
       // retrieve the labels for this expression
-      auto it = expressionLabelsMap.find(ctx);
-      if (it == expressionLabelsMap.end()) {
+      auto* it = expressionLabelsMap.find(ctx);
+      if (it == nullptr) {
         handleLogicalExpression(ctx);
         it = expressionLabelsMap.find(ctx);
       }
 
-      ExpressionLabels& labels = it->second;
+      ExpressionLabels& labels = *it;
 
       // only place the exit label if we've processed the expression
       if (labels.processed) {
@@ -747,100 +734,97 @@ void BytecodeIRGeneratorListener::exitBase_expression(cgullParser::Base_expressi
 
   // handle if expressions
 
-  auto parent = ctx->parent;
-  if (!parent)
-    return;
-  auto ifExpr = dynamic_cast<cgullParser::If_expressionContext*>(parent);
-  if (ifExpr && ifExpr->base_expression(0) == ctx) {
+  NodeRole role = nodeRoles.get(ctx);
+  auto parent = static_cast<antlr4::ParserRuleContext*>(ctx->parent);
+  auto ifExpr = role.kind == NodeRole::Kind::IF_EXPRESSION_PART ? parent : nullptr;
+  if (ifExpr && role.position == 0) {
     // jump to the else expression if stack is false
-    auto it = ifExpressionLabelsMap.find(ifExpr);
-    if (it != ifExpressionLabelsMap.end()) {
-      auto& labels = it->second;
+    auto* it = ifExpressionLabelsMap.find(ifExpr);
+    if (it != nullptr) {
+      auto& labels = *it;
       auto jumpInst = std::make_shared<IRRawInstruction>("ifeq " + labels.conditionLabels[0]);
       currentFunction->instructions.push_back(jumpInst);
     }
-  } else if (ifExpr && ifExpr->base_expression(1) == ctx) {
+  } else if (ifExpr && role.position == 1) {
     // jump to the end of the if expression
-    auto it = ifExpressionLabelsMap.find(ifExpr);
-    if (it != ifExpressionLabelsMap.end()) {
-      auto& labels = it->second;
+    auto* it = ifExpressionLabelsMap.find(ifExpr);
+    if (it != nullptr) {
+      auto& labels = *it;
       auto jumpInst = std::make_shared<IRRawInstruction>("goto " + labels.endIfLabel);
       currentFunction->instructions.push_back(jumpInst);
       // place label for jumping to the else condition
       auto labelInst = std::make_shared<IRRawInstruction>(labels.conditionLabels[0] + ":");
       currentFunction->instructions.push_back(labelInst);
     }
-  } else if (ifExpr && ifExpr->base_expression(2) == ctx) {
+  } else if (ifExpr && role.position == 2) {
     // place label for jumping to the end of the if expression
-    auto it = ifExpressionLabelsMap.find(ifExpr);
-    if (it != ifExpressionLabelsMap.end()) {
-      auto& labels = it->second;
+    auto* it = ifExpressionLabelsMap.find(ifExpr);
+    if (it != nullptr) {
+      auto& labels = *it;
       auto labelInst = std::make_shared<IRRawInstruction>(labels.endIfLabel + ":");
       currentFunction->instructions.push_back(labelInst);
     }
   }
 
   // handle AND/OR parent relationships for short-circuiting
-  if (ctx->parent) {
-    auto parentCtx = dynamic_cast<cgullParser::Base_expressionContext*>(ctx->parent);
-    if (parentCtx) {
-      auto it = expressionLabelsMap.find(parentCtx);
-      if (it != expressionLabelsMap.end() && !it->second.processed) {
-        ExpressionLabels& labels = it->second;
-
-        if (parentCtx->AND_OP() && ctx == parentCtx->base_expression(0)) {
-          // left side of AND finished evaluating, if it was false jump to fallthrough
-          auto leftFalseJump = std::make_shared<IRRawInstruction>("ifeq " + labels.fallthroughLabel);
-          currentFunction->instructions.push_back(leftFalseJump);
-        } else if (parentCtx->OR_OP() && ctx == parentCtx->base_expression(0)) {
-          // left side of OR finished evaluating, if it was true jump to fallthrough (opposite of AND)
-          auto leftTrueJump = std::make_shared<IRRawInstruction>("ifne " + labels.fallthroughLabel);
-          currentFunction->instructions.push_back(leftTrueJump);
-        } else if (parentCtx->AND_OP() && ctx == parentCtx->base_expression(1)) {
-          // right side of AND finished evaluating, if it was false jump to fallthrough
-          auto rightFalseJump = std::make_shared<IRRawInstruction>("ifeq " + labels.fallthroughLabel);
-          currentFunction->instructions.push_back(rightFalseJump);
-
-          // push true since both operands are true
-          auto pushTrue = std::make_shared<IRRawInstruction>("iconst 1");
-          currentFunction->instructions.push_back(pushTrue);
-
-          // jump to the exit label (both operands are true)
-          auto jumpToExit = std::make_shared<IRRawInstruction>("goto " + labels.exitLabel);
-          currentFunction->instructions.push_back(jumpToExit);
-
-          // place the fallthrough label here (one of the operands was false)
-          auto fallthroughLabel = std::make_shared<IRRawInstruction>(labels.fallthroughLabel + ":");
-          currentFunction->instructions.push_back(fallthroughLabel);
-
-          // push false since one of the operands was false
-          auto pushFalse = std::make_shared<IRRawInstruction>("iconst 0");
-          currentFunction->instructions.push_back(pushFalse);
-
-          // mark this expression as processed to avoid duplicate label placement
-          labels.processed = true;
-        } else if (parentCtx->OR_OP() && ctx == parentCtx->base_expression(1)) {
-          // right side of OR finished evaluating, if it was true jump to fallthrough
-          auto rightTrueJump = std::make_shared<IRRawInstruction>("ifne " + labels.fallthroughLabel);
-          currentFunction->instructions.push_back(rightTrueJump);
-
-          // push false since both operands are false
-          auto pushFalse = std::make_shared<IRRawInstruction>("iconst 0");
-          currentFunction->instructions.push_back(pushFalse);
-
-          // jump to the exit label (both operands are false)
-          auto jumpToExit = std::make_shared<IRRawInstruction>("goto " + labels.exitLabel);
-          currentFunction->instructions.push_back(jumpToExit);
-
-          // place the fallthrough label here (one of the operands was true)
-          auto fallthroughLabel = std::make_shared<IRRawInstruction>(labels.fallthroughLabel + ":");
-          currentFunction->instructions.push_back(fallthroughLabel);
-          auto pushTrue = std::make_shared<IRRawInstruction>("iconst 1");
-          currentFunction->instructions.push_back(pushTrue);
-
-          // again, mark this expression as processed to avoid duplicate label placement
-          labels.processed = true;
-        }
+  if (role.kind == NodeRole::Kind::LOGICAL_OPERAND) {
+    auto parentCtx = static_cast<cgullParser::Base_expressionContext*>(parent);
+    auto* it = expressionLabelsMap.find(parentCtx);
+    if (it != nullptr && !it->processed) {
+      ExpressionLabels& labels = *it;
+
+      if (parentCtx->AND_OP() && role.position == 0) {
+        // left side of AND finished evaluating, if it was false jump to fallthrough
+        auto leftFalseJump = std::make_shared<IRRawInstruction>("ifeq " + labels.fallthroughLabel);
+        currentFunction->instructions.push_back(leftFalseJump);
+      } else if (parentCtx->OR_OP() && role.position == 0) {
+        // left side of OR finished evaluating, if it was true jump to fallthrough (opposite of AND)
+        auto leftTrueJump = std::make_shared<IRRawInstruction>("ifne " + labels.fallthroughLabel);
+        currentFunction->instructions.push_back(leftTrueJump);
+      } else if (parentCtx->AND_OP() && role.position == 1) {
+        // right side of AND finished evaluating, if it was false jump to fallthrough
+        auto rightFalseJump = std::make_shared<IRRawInstruction>("ifeq " + labels.fallthroughLabel);
+        currentFunction->instructions.push_back(rightFalseJump);
+
+        // push true since both operands are true
+        auto pushTrue = std::make_shared<IRRawInstruction>("iconst 1");
+        currentFunction->instructions.push_back(pushTrue);
+
+        // jump to the exit label (both operands are true)
+        auto jumpToExit = std::make_shared<IRRawInstruction>("goto " + labels.exitLabel);
+        currentFunction->instructions.push_back(jumpToExit);
+
+        // place the fallthrough label here (one of the operands was false)
+        auto fallthroughLabel = std::make_shared<IRRawInstruction>(labels.fallthroughLabel + ":");
+        currentFunction->instructions.push_back(fallthroughLabel);
+
+        // push false since one of the operands was false
+        auto pushFalse = std::make_shared<IRRawInstruction>("iconst 0");
+        currentFunction->instructions.push_back(pushFalse);
+
+        // mark this expression as processed to avoid duplicate label placement
+        labels.processed = true;
+      } else if (parentCtx->OR_OP() && role.position == 1) {
+        // right side of OR finished evaluating, if it was true jump to fallthrough
+        auto rightTrueJump = std::make_shared<IRRawInstruction>("ifne " + labels.fallthroughLabel);
+        currentFunction->instructions.push_back(rightTrueJump);
+
+        // push false since both operands are false
+        auto pushFalse = std::make_shared<IRRawInstruction>("iconst 0");
+        currentFunction->instructions.push_back(pushFalse);
+
+        // jump to the exit label (both operands are false)
+        auto jumpToExit = std::make_shared<IRRawInstruction>("goto " + labels.exitLabel);
+        currentFunction->instructions.push_back(jumpToExit);
+
+        // place the fallthrough label here (one of the operands was true)
+        auto fallthroughLabel = std::make_shared<IRRawInstruction>(labels.fallthroughLabel + ":");
+        currentFunction->instructions.push_back(fallthroughLabel);
+        auto pushTrue = std::make_shared<IRRawInstruction>("iconst 1");
+        currentFunction->instructions.push_back(pushTrue);
+
+        // again, mark this expression as processed to avoid duplicate label placement
+        labels.processed = true;
       }
     }
   }
@@ -849,8 +833,7 @@ void BytecodeIRGeneratorListener::exitBase_expression(cgullParser::Base_expressi
 void BytecodeIRGeneratorListener::enterVariable_declaration(cgullParser::Variable_declarationContext* ctx) {
   auto scope = getCurrentScope(ctx);
   if (scope) {
-    std::string identifier = ctx->IDENTIFIER()->getText();
-    auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(scope->resolve(identifier));
+    auto varSymbol = resolveVariable(scope, ctx->IDENTIFIER());
     // if we're not in a function, this is a struct variable
     if (!currentFunction) {
       auto structClass = currentClassStack.top();
@@ -866,7 +849,7 @@ void BytecodeIRGeneratorListener::enterVariable_declaration(cgullParser::Variabl
         auto currentClass = currentClassStack.top();
         if (ctx->expression()) {
           auto type = varSymbol->dataType;
-          auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
+          auto primitiveType = typeCast<PrimitiveType>(type);
           if (primitiveType) {
             switch (primitiveType->getPrimitiveKind()) {
             case PrimitiveType::PrimitiveKind::INT:
@@ -903,14 +886,14 @@ void BytecodeIRGeneratorListener::exitVariable_declaration(cgullParser::Variable
   if (ctx->expression()) {
     auto scope = getCurrentScope(ctx);
     std::string identifier = ctx->IDENTIFIER()->getText();
-    auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(scope->resolve(identifier));
+    auto varSymbol = resolveVariable(scope, ctx->IDENTIFIER());
 
     if (varSymbol) {
       auto type = varSymbol->dataType;
-      auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
-      auto pointerType = std::dynamic_pointer_cast<PointerType>(type);
-      auto arrayType = std::dynamic_pointer_cast<ArrayType>(type);
-      auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(type);
+      auto primitiveType = typeCast<PrimitiveType>(type);
+      auto pointerType = typeCast<PointerType>(type);
+      auto arrayType = typeCast<ArrayType>(type);
+      auto userDefinedType = typeCast<UserDefinedType>(type);
 
       // if this is a struct field with a default value, store it in the IRClass
       if (varSymbol->isStructMember && varSymbol->hasDefaultValue) {
@@ -962,8 +945,7 @@ void BytecodeIRGeneratorListener::exitVariable_declaration(cgullParser::Variable
 void BytecodeIRGeneratorListener::enterVariable(cgullParser::VariableContext* ctx) {
   if (ctx->IDENTIFIER()) {
     auto scope = getCurrentScope(ctx);
-    std::string identifier = ctx->IDENTIFIER()->getText();
-    auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(scope->resolve(identifier));
+    auto varSymbol = resolveVariable(scope, ctx->IDENTIFIER());
 
     if (varSymbol && varSymbol->isStructMember) {
       auto loadInstruction = std::make_shared<IRRawInstruction>("aload 0");
@@ -974,17 +956,16 @@ void BytecodeIRGeneratorListener::enterVariable(cgullParser::VariableContext* ct
 
 void BytecodeIRGeneratorListener::exitVariable(cgullParser::VariableContext* ctx) {
   // if we're evaluating a variable as a value (not as a target), load its value onto the stack
-  if (ctx->IDENTIFIER() && ctx->parent && !dynamic_cast<cgullParser::Assignment_statementContext*>(ctx->parent)) {
+  if (ctx->IDENTIFIER() && nodeRoles.get(ctx).kind != NodeRole::Kind::ASSIGNMENT_TARGET) {
     auto scope = getCurrentScope(ctx);
-    std::string identifier = ctx->IDENTIFIER()->getText();
-    auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(scope->resolve(identifier));
+    auto varSymbol = resolveVariable(scope, ctx->IDENTIFIER());
 
     if (varSymbol) {
       auto type = varSymbol->dataType;
-      auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
-      auto pointerType = std::dynamic_pointer_cast<PointerType>(type);
-      auto arrayType = std::dynamic_pointer_cast<ArrayType>(type);
-      auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(type);
+      auto primitiveType = typeCast<PrimitiveType>(type);
+      auto pointerType = typeCast<PointerType>(type);
+      auto arrayType = typeCast<ArrayType>(type);
+      auto userDefinedType = typeCast<UserDefinedType>(type);
 
       if (varSymbol->isStructMember) {
         std::string className = varSymbol->parentStructType->name;
@@ -1012,12 +993,15 @@ void BytecodeIRGeneratorListener::exitAssignment_statement(cgullParser::Assignme
   if (ctx->dereference_expression()) {
     auto scope = getCurrentScope(ctx);
     auto expression = ctx->expression();
-    auto expressionType = expressionTypes[expression];
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(expressionType);
+    auto expressionType = expressionTypes.get(expression);
+    auto primitiveType = typeCast<PrimitiveType>(expressionType);
     if (!primitiveType) {
       throw std::runtime_error("Unsupported assignment type: " + expressionType->toString());
     }
-    auto wrapperClass = PrimitiveWrapperGenerator::generateWrapperClass(primitiveType->getPrimitiveKind());
+    auto wrapperClass = primitiveWrappers[primitiveType->getPrimitiveKind()];
+    if (!wrapperClass) {
+      throw std::runtime_error("Primitive type " + primitiveType->toString() + " has no wrapper class");
+    }
     auto method = wrapperClass->getMethod("setValue");
     auto invokeInst =
         std::make_shared<IRRawInstruction>("invokevirtual " + wrapperClass->name + "." + method->getMangledName() +
@@ -1026,18 +1010,17 @@ void BytecodeIRGeneratorListener::exitAssignment_statement(cgullParser::Assignme
   } else if (ctx->variable() && ctx->expression()) {
     auto scope = getCurrentScope(ctx);
     auto variable = ctx->variable();
-    auto type = expressionTypes[variable];
+    auto type = expressionTypes.get(variable);
 
     if (variable->field_access()) {
       auto fieldAccess = variable->field_access();
       auto lastField = fieldAccess->field(fieldAccess->field().size() - 1);
       auto lastStruct = fieldAccess->field(fieldAccess->field().size() - 2);
-      auto structType = expressionTypes[lastStruct];
-      auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(structType);
+      auto structType = expressionTypes.get(lastStruct);
+      auto userDefinedType = typeCast<UserDefinedType>(structType);
       if (userDefinedType && lastField->IDENTIFIER()) {
         auto structSymbol = userDefinedType->getTypeSymbol();
-        auto fieldTypeSymbol =
-            std::dynamic_pointer_cast<VariableSymbol>(structSymbol->scope->resolve(lastField->IDENTIFIER()->getText()));
+        auto fieldTypeSymbol = resolveVariable(structSymbol->scope, lastField->IDENTIFIER());
         if (fieldTypeSymbol) {
           auto putFieldInst =
               std::make_shared<IRRawInstruction>("putfield " + structSymbol->name + "." + fieldTypeSymbol->name + " " +
@@ -1046,23 +1029,23 @@ void BytecodeIRGeneratorListener::exitAssignment_statement(cgullParser::Assignme
         }
       } else if (userDefinedType && lastField->index_expression()) {
         auto structSymbol = userDefinedType->getTypeSymbol();
-        auto fieldTypeSymbol = std::dynamic_pointer_cast<VariableSymbol>(
-            structSymbol->scope->resolve(lastField->index_expression()->indexable()->IDENTIFIER()->getText()));
+        auto fieldTypeSymbol =
+            resolveVariable(structSymbol->scope, lastField->index_expression()->indexable()->IDENTIFIER());
         if (fieldTypeSymbol) {
-          auto arrayType = std::dynamic_pointer_cast<ArrayType>(fieldTypeSymbol->dataType);
+          auto arrayType = typeCast<ArrayType>(fieldTypeSymbol->dataType);
           auto arrayOperationInstruction = getArrayOperationInstruction(arrayType->getElementType(), true);
           auto putFieldInst = std::make_shared<IRRawInstruction>(arrayOperationInstruction);
           currentFunction->instructions.push_back(putFieldInst);
         }
       }
     } else {
-      auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(scope->resolve(variable->IDENTIFIER()->getText()));
+      auto varSymbol = resolveVariable(scope, variable->IDENTIFIER());
       if (varSymbol) {
         auto type = varSymbol->dataType;
-        auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
-        auto pointerType = std::dynamic_pointer_cast<PointerType>(type);
-        auto arrayType = std::dynamic_pointer_cast<ArrayType>(type);
-        auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(type);
+        auto primitiveType = typeCast<PrimitiveType>(type);
+        auto pointerType = typeCast<PointerType>(type);
+        auto arrayType = typeCast<ArrayType>(type);
+        auto userDefinedType = typeCast<UserDefinedType>(type);
 
         if (varSymbol->isStructMember) {
           auto putFieldInst =
@@ -1105,7 +1088,7 @@ void BytecodeIRGeneratorListener::exitAssignment_statement(cgullParser::Assignme
     }
   } else if (ctx->index_expression()) {
     auto scope = getCurrentScope(ctx);
-    auto type = expressionTypes[ctx->index_expression()];
+    auto type = expressionTypes.get(ctx->index_expression());
     auto rawInstruction = std::make_shared<IRRawInstruction>(getArrayOperationInstruction(type, true));
     currentFunction->instructions.push_back(rawInstruction);
   }
@@ -1114,14 +1097,14 @@ void BytecodeIRGeneratorListener::exitAssignment_statement(cgullParser::Assignme
 void BytecodeIRGeneratorListener::exitReturn_statement(cgullParser::Return_statementContext* ctx) {
   std::shared_ptr<IRRawInstruction> returnInst;
   auto returnType = currentFunction->returnTypes[0];
-  auto voidType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID);
+  auto voidType = TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID);
   if (returnType->equals(voidType)) {
     returnInst = std::make_shared<IRRawInstruction>("return");
-  } else if (returnType->equals(std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::INT))) {
+  } else if (returnType->equals(TypeTable::primitive(PrimitiveType::PrimitiveKind::INT))) {
     returnInst = std::make_shared<IRRawInstruction>("ireturn");
-  } else if (returnType->equals(std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::FLOAT))) {
+  } else if (returnType->equals(TypeTable::primitive(PrimitiveType::PrimitiveKind::FLOAT))) {
     returnInst = std::make_shared<IRRawInstruction>("freturn");
-  } else if (returnType->equals(std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::BOOLEAN))) {
+  } else if (returnType->equals(TypeTable::primitive(PrimitiveType::PrimitiveKind::BOOLEAN))) {
     returnInst = std::make_shared<IRRawInstruction>("ireturn");
   } else {
     returnInst = std::make_shared<IRRawInstruction>("areturn");
@@ -1132,8 +1115,8 @@ void BytecodeIRGeneratorListener::exitReturn_statement(cgullParser::Return_state
 void BytecodeIRGeneratorListener::exitUnary_expression(cgullParser::Unary_expressionContext* ctx) {
   // expression result is already on the stack
   auto expressionCtx = ctx->expression();
-  auto expressionType = expressionTypes[expressionCtx];
-  auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(expressionType);
+  auto expressionType = expressionTypes.get(expressionCtx);
+  auto primitiveType = typeCast<PrimitiveType>(expressionType);
   if (!primitiveType) {
     return;
   }
@@ -1212,7 +1195,7 @@ void BytecodeIRGeneratorListener::exitUnary_expression(cgullParser::Unary_expres
         }
         auto scope = getCurrentScope(ctx);
         std::string identifier = ctx->expression()->getText();
-        auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(scope->resolve(identifier));
+        auto varSymbol = dynamic_cast<VariableSymbol*>(scope->resolve(identifier));
         // store the result back in the variable (duplicate the value on the stack)
         auto rawInstructionDup = std::make_shared<IRRawInstruction>(varSymbol->isStructMember ? "dup_x1" : "dup");
         currentFunction->instructions.push_back(rawInstructionDup);
@@ -1246,11 +1229,11 @@ void BytecodeIRGeneratorListener::exitPostfix_expression(cgullParser::Postfix_ex
   if (ctx->IDENTIFIER()) {
     auto scope = getCurrentScope(ctx);
     std::string identifier = ctx->IDENTIFIER()->getText();
-    auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(scope->resolve(identifier));
+    auto varSymbol = resolveVariable(scope, ctx->IDENTIFIER());
 
     if (varSymbol) {
       auto type = varSymbol->dataType;
-      auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
+      auto primitiveType = typeCast<PrimitiveType>(type);
       auto typeKind = primitiveType->getPrimitiveKind();
       if (primitiveType) {
         // load the value in question (it's an identifier, so its not on the stack)
@@ -1314,7 +1297,7 @@ void BytecodeIRGeneratorListener::exitPostfix_expression(cgullParser::Postfix_ex
   }
 }
 
-std::string BytecodeIRGeneratorListener::getLoadInstruction(const std::shared_ptr<PrimitiveType>& primitiveType) {
+std::string BytecodeIRGeneratorListener::getLoadInstruction(PrimitiveType* primitiveType) {
   switch (primitiveType->getPrimitiveKind()) {
   case PrimitiveType::PrimitiveKind::INT:
     return "iload";
@@ -1329,7 +1312,7 @@ std::string BytecodeIRGeneratorListener::getLoadInstruction(const std::shared_pt
   }
 }
 
-std::string BytecodeIRGeneratorListener::getStoreInstruction(const std::shared_ptr<PrimitiveType>& primitiveType) {
+std::string BytecodeIRGeneratorListener::getStoreInstruction(PrimitiveType* primitiveType) {
   switch (primitiveType->getPrimitiveKind()) {
   case PrimitiveType::PrimitiveKind::INT:
     return "istore";
@@ -1375,32 +1358,29 @@ void BytecodeIRGeneratorListener::enterIf_expression(cgullParser::If_expressionC
 }
 
 void BytecodeIRGeneratorListener::exitBranch_block(cgullParser::Branch_blockContext* ctx) {
-  auto parentCtx = ctx->parent;
-  if (!parentCtx)
-    return;
+  NodeRole role = nodeRoles.get(ctx);
+  auto parentCtx = static_cast<antlr4::ParserRuleContext*>(ctx->parent);
 
   // handle loop labels first before break labels
 
-  auto whileStmt = dynamic_cast<cgullParser::While_statementContext*>(parentCtx);
-  if (whileStmt) {
-    auto it = whileLabelsMap.find(whileStmt);
-    if (it != whileLabelsMap.end()) {
-      auto& labels = it->second;
+  if (role.kind == NodeRole::Kind::WHILE_BODY) {
+    auto* it = whileLabelsMap.find(parentCtx);
+    if (it != nullptr) {
+      auto& labels = *it;
       // jump to the top of the loop
       auto jumpInst = std::make_shared<IRRawInstruction>("goto " + labels.startLabel);
       currentFunction->instructions.push_back(jumpInst);
       // place the label for the end of the loop
       auto endLabelInst = std::make_shared<IRRawInstruction>(labels.endLabel + ":");
       currentFunction->instructions.push_back(endLabelInst);
-      whileLabelsMap.erase(whileStmt);
+      whileLabelsMap.erase(parentCtx);
     }
   }
 
-  auto infiniteLoopStmt = dynamic_cast<cgullParser::Infinite_loop_statementContext*>(parentCtx);
-  if (infiniteLoopStmt) {
-    auto it = infiniteLoopLabelsMap.find(infiniteLoopStmt);
-    if (it != infiniteLoopLabelsMap.end()) {
-      auto& labels = it->second;
+  if (role.kind == NodeRole::Kind::INFINITE_LOOP_BODY) {
+    auto* it = infiniteLoopLabelsMap.find(parentCtx);
+    if (it != nullptr) {
+      auto& labels = *it;
       // jump to the top of the loop
       auto jumpInst = std::make_shared<IRRawInstruction>("goto " + labels.startLabel);
       currentFunction->instructions.push_back(jumpInst);
@@ -1408,11 +1388,10 @@ void BytecodeIRGeneratorListener::exitBranch_block(cgullParser::Branch_blockCont
     }
   }
 
-  auto forStmt = dynamic_cast<cgullParser::For_statementContext*>(parentCtx);
-  if (forStmt) {
-    auto it = forLabelsMap.find(forStmt);
-    if (it != forLabelsMap.end()) {
-      auto& labels = it->second;
+  if (role.kind == NodeRole::Kind::FOR_BODY) {
+    auto* it = forLabelsMap.find(parentCtx);
+    if (it != nullptr) {
+      auto& labels = *it;
       // jump to the update expr at the end of the loop
       auto jumpInst = std::make_shared<IRRawInstruction>("goto " + labels.updateLabel);
       currentFunction->instructions.push_back(jumpInst);
@@ -1426,10 +1405,7 @@ void BytecodeIRGeneratorListener::exitBranch_block(cgullParser::Branch_blockCont
 
   // handle break labels
 
-  if (dynamic_cast<cgullParser::Until_statementContext*>(parentCtx) ||
-      dynamic_cast<cgullParser::While_statementContext*>(parentCtx) ||
-      dynamic_cast<cgullParser::For_statementContext*>(parentCtx) ||
-      dynamic_cast<cgullParser::Infinite_loop_statementContext*>(parentCtx)) {
+  if (role.isLoopBody()) {
     if (!breakLabels.empty()) {
       auto breakLabel = breakLabels.top();
       breakLabels.pop();
@@ -1437,32 +1413,25 @@ void BytecodeIRGeneratorListener::exitBranch_block(cgullParser::Branch_blockCont
       auto labelInst = std::make_shared<IRRawInstruction>(breakLabel + ":");
       currentFunction->instructions.push_back(labelInst);
     }
-  } else if (auto ifStmt = dynamic_cast<cgullParser::If_statementContext*>(parentCtx)) {
+  } else if (role.kind == NodeRole::Kind::IF_BRANCH) {
     // branch is part of an if statement, handle jumps
-    auto it = ifLabelsMap.find(ifStmt);
-    if (it != ifLabelsMap.end()) {
-      auto& labels = it->second;
+    auto* it = ifLabelsMap.find(parentCtx);
+    if (it != nullptr) {
+      auto& labels = *it;
 
       // after a branch block, jump to the end of the if statement
       auto jumpInst = std::make_shared<IRRawInstruction>("goto " + labels.endIfLabel);
       currentFunction->instructions.push_back(jumpInst);
 
-      // find which branch block this is
-      size_t branchIndex = 0;
-      for (size_t i = 0; i < ifStmt->branch_block().size(); ++i) {
-        if (ifStmt->branch_block(i) == ctx) {
-          branchIndex = i;
-          break;
-        }
-      }
-
       // add the label for the next branch if this is not the last branch
+      size_t branchIndex = role.position;
       if (branchIndex + 1 < labels.conditionLabels.size()) {
         auto labelInst = std::make_shared<IRRawInstruction>(labels.conditionLabels[branchIndex + 1] + ":");
         currentFunction->instructions.push_back(labelInst);
       }
 
       // add end label if this *is* the last branch block
+      auto ifStmt = static_cast<cgullParser::If_statementContext*>(parentCtx);
       if (branchIndex == ifStmt->branch_block().size() - 1) {
         auto endLabelInst = std::make_shared<IRRawInstruction>(labels.endIfLabel + ":");
         currentFunction->instructions.push_back(endLabelInst);
@@ -1473,42 +1442,26 @@ void BytecodeIRGeneratorListener::exitBranch_block(cgullParser::Branch_blockCont
 }
 
 void BytecodeIRGeneratorListener::enterBranch_block(cgullParser::Branch_blockContext* ctx) {
-  // if this branch block is part of a loop, push a new break label
-  auto parentCtx = ctx->parent;
-  if (!parentCtx)
-    return;
+  NodeRole role = nodeRoles.get(ctx);
+  auto parentCtx = static_cast<antlr4::ParserRuleContext*>(ctx->parent);
 
-  if (dynamic_cast<cgullParser::Loop_statementContext*>(parentCtx) ||
-      dynamic_cast<cgullParser::Until_statementContext*>(parentCtx) ||
-      dynamic_cast<cgullParser::While_statementContext*>(parentCtx) ||
-      dynamic_cast<cgullParser::For_statementContext*>(parentCtx) ||
-      dynamic_cast<cgullParser::Infinite_loop_statementContext*>(parentCtx)) {
+  // if this branch block is part of a loop, push a new break label
+  if (role.isLoopBody()) {
     breakLabels.push(generateLabel());
-  } else if (auto ifStmt = dynamic_cast<cgullParser::If_statementContext*>(parentCtx)) {
-    size_t branchIndex = 0;
-    for (size_t i = 0; i < ifStmt->branch_block().size(); ++i) {
-      if (ifStmt->branch_block(i) == ctx) {
-        branchIndex = i;
-        break;
-      }
-    }
-
+  } else if (role.kind == NodeRole::Kind::IF_BRANCH && role.position == 0) {
     // if this is the first branch block, add its label
-    if (branchIndex == 0) {
-      auto it = ifLabelsMap.find(ifStmt);
-      if (it != ifLabelsMap.end()) {
-        auto& labels = it->second;
-        auto labelInst = std::make_shared<IRRawInstruction>(labels.conditionLabels[0] + ":");
-        currentFunction->instructions.push_back(labelInst);
-      }
+    auto* it = ifLabelsMap.find(parentCtx);
+    if (it != nullptr) {
+      auto& labels = *it;
+      auto labelInst = std::make_shared<IRRawInstruction>(labels.conditionLabels[0] + ":");
+      currentFunction->instructions.push_back(labelInst);
     }
   }
 
-  auto forStmt = dynamic_cast<cgullParser::For_statementContext*>(parentCtx);
-  if (forStmt) {
-    auto it = forLabelsMap.find(forStmt);
-    if (it != forLabelsMap.end()) {
-      auto& labels = it->second;
+  if (role.kind == NodeRole::Kind::FOR_BODY) {
+    auto* it = forLabelsMap.find(parentCtx);
+    if (it != nullptr) {
+      auto& labels = *it;
       // place label for the start of the block
       auto labelInst = std::make_shared<IRRawInstruction>(labels.startLabel + ":");
       currentFunction->instructions.push_back(labelInst);
@@ -1609,22 +1562,21 @@ void BytecodeIRGeneratorListener::handleLogicalExpression(cgullParser::Base_expr
 }
 
 void BytecodeIRGeneratorListener::exitCast_expression(cgullParser::Cast_expressionContext* ctx) {
-  auto castType = std::dynamic_pointer_cast<PrimitiveType>(
-      TypeCheckingListener::resolvePrimitiveType(ctx->primitive_type()->getText()));
-  std::shared_ptr<Type> currentType;
+  auto castType = typeCast<PrimitiveType>(TypeCheckingListener::resolvePrimitiveType(ctx->primitive_type()));
+  Type* currentType = nullptr;
 
   // if its an expression, it will already be resolved on the stack
   // if its an identifier, we need to load the value from the variable
   if (ctx->IDENTIFIER()) {
     // load the value from the variable
     auto scope = getCurrentScope(ctx);
-    auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(scope->resolve(ctx->IDENTIFIER()->getText()));
+    auto varSymbol = resolveVariable(scope, ctx->IDENTIFIER());
     currentType = varSymbol->dataType;
-    if (auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(currentType)) {
+    if (auto primitiveType = typeCast<PrimitiveType>(currentType)) {
       auto loadInst = std::make_shared<IRRawInstruction>(getLoadInstruction(primitiveType) + " " +
                                                          std::to_string(varSymbol->localIndex));
       currentFunction->instructions.push_back(loadInst);
-    } else if (auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(currentType)) {
+    } else if (auto userDefinedType = typeCast<UserDefinedType>(currentType)) {
       if (varSymbol->isStructMember) {
         auto aloadInst = std::make_shared<IRRawInstruction>("aload 0");
         currentFunction->instructions.push_back(aloadInst);
@@ -1642,11 +1594,11 @@ void BytecodeIRGeneratorListener::exitCast_expression(cgullParser::Cast_expressi
       currentFunction->instructions.push_back(loadInst);
     }
   } else {
-    currentType = expressionTypes[ctx->expression()];
+    currentType = expressionTypes.get(ctx->expression());
   }
 
   // pointer to int conversion
-  if (auto pointerType = std::dynamic_pointer_cast<PointerType>(currentType)) {
+  if (auto pointerType = typeCast<PointerType>(currentType)) {
     if (castType && castType->getPrimitiveKind() == PrimitiveType::PrimitiveKind::INT) {
       auto rawInstruction =
           std::make_shared<IRRawInstruction>("invokestatic java/lang/System.identityHashCode(java/lang/Object)I");
@@ -1656,7 +1608,7 @@ void BytecodeIRGeneratorListener::exitCast_expression(cgullParser::Cast_expressi
   }
 
   // user defined type conversions
-  if (auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(currentType)) {
+  if (auto userDefinedType = typeCast<UserDefinedType>(currentType)) {
     if (castType && castType->getPrimitiveKind() == PrimitiveType::PrimitiveKind::STRING) {
       auto rawInstruction = std::make_shared<IRRawInstruction>(
           "invokevirtual " + userDefinedType->getTypeSymbol()->name + ".$toString_() java/lang/String");
@@ -1666,15 +1618,14 @@ void BytecodeIRGeneratorListener::exitCast_expression(cgullParser::Cast_expressi
   }
 
   // primitive conversions
-  if (auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(currentType)) {
+  if (auto primitiveType = typeCast<PrimitiveType>(currentType)) {
     convertPrimitiveToPrimitive(primitiveType, castType);
   } else {
     throw std::runtime_error("Unsupported cast from " + currentType->toString() + " to " + castType->toString());
   }
 }
 
-void BytecodeIRGeneratorListener::convertPrimitiveToPrimitive(const std::shared_ptr<PrimitiveType>& fromType,
-                                                              const std::shared_ptr<PrimitiveType>& toType) {
+void BytecodeIRGeneratorListener::convertPrimitiveToPrimitive(PrimitiveType* fromType, PrimitiveType* toType) {
   if (fromType->getPrimitiveKind() == PrimitiveType::PrimitiveKind::INT ||
       fromType->getPrimitiveKind() == PrimitiveType::PrimitiveKind::BOOLEAN) {
     switch (toType->getPrimitiveKind()) {
@@ -1750,9 +1701,8 @@ void BytecodeIRGeneratorListener::convertPrimitiveToPrimitive(const std::shared_
 void BytecodeIRGeneratorListener::enterAllocate_primitive(cgullParser::Allocate_primitiveContext* ctx) {
   // place creation of the object first, as the expression will be a parameter
   if (ctx->primitive_type()) {
-    std::string typeName = ctx->primitive_type()->getText();
-    auto baseType = TypeCheckingListener::resolvePrimitiveType(typeName);
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(baseType);
+    auto baseType = TypeCheckingListener::resolvePrimitiveType(ctx->primitive_type());
+    auto primitiveType = typeCast<PrimitiveType>(baseType);
     auto newInst = std::make_shared<IRRawInstruction>(
         "new " + PrimitiveWrapperGenerator::getClassName(primitiveType->getPrimitiveKind()));
     currentFunction->instructions.push_back(newInst);
@@ -1764,9 +1714,8 @@ void BytecodeIRGeneratorListener::enterAllocate_primitive(cgullParser::Allocate_
 
 void BytecodeIRGeneratorListener::exitAllocate_primitive(cgullParser::Allocate_primitiveContext* ctx) {
   if (ctx->primitive_type()) {
-    std::string typeName = ctx->primitive_type()->getText();
-    auto baseType = TypeCheckingListener::resolvePrimitiveType(typeName);
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(baseType);
+    auto baseType = TypeCheckingListener::resolvePrimitiveType(ctx->primitive_type());
+    auto primitiveType = typeCast<PrimitiveType>(baseType);
 
     if (primitiveType) {
       std::string refClassName = PrimitiveWrapperGenerator::getClassName(primitiveType->getPrimitiveKind());
@@ -1776,7 +1725,7 @@ void BytecodeIRGeneratorListener::exitAllocate_primitive(cgullParser::Allocate_p
           std::make_shared<IRRawInstruction>("invokespecial " + refClassName + ".<init>(" + paramType + ")V");
       currentFunction->instructions.push_back(initInst);
     } else {
-      throw std::runtime_error("Invalid primitive type in allocation: " + typeName);
+      throw std::runtime_error("Invalid primitive type in allocation: " + ctx->primitive_type()->getText());
     }
   }
 }
@@ -1785,13 +1734,13 @@ void BytecodeIRGeneratorListener::exitDereferenceable(cgullParser::Dereferenceab
   // figure out the type of the dereferenceable
   auto scope = getCurrentScope(ctx);
   // type checked, so we can assume that this deref SHOULD become this type
-  auto derefType = expressionTypes[dynamic_cast<antlr4::ParserRuleContext*>(ctx->parent)];
+  auto derefType = expressionTypes.get(dynamic_cast<antlr4::ParserRuleContext*>(ctx->parent));
   if (!derefType) {
     return;
   }
   // identifiers need their object loaded onto the stack
   if (ctx->IDENTIFIER()) {
-    auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(scope->resolve(ctx->IDENTIFIER()->getText()));
+    auto varSymbol = resolveVariable(scope, ctx->IDENTIFIER());
     auto loadInst = std::make_shared<IRRawInstruction>("aload " + std::to_string(varSymbol->localIndex));
     currentFunction->instructions.push_back(loadInst);
   }
@@ -1802,14 +1751,13 @@ void BytecodeIRGeneratorListener::exitDereferenceable(cgullParser::Dereferenceab
 }
 
 void BytecodeIRGeneratorListener::enterDereference_expression(cgullParser::Dereference_expressionContext* ctx) {
-  auto parent = ctx->parent;
-  if (parent && dynamic_cast<cgullParser::Assignment_statementContext*>(parent)) {
+  if (nodeRoles.get(ctx).kind == NodeRole::Kind::ASSIGNMENT_TARGET) {
     dereferenceAssignment = true;
   }
 }
 
 void BytecodeIRGeneratorListener::exitAllocate_array(cgullParser::Allocate_arrayContext* ctx) {
-  auto arrayType = std::dynamic_pointer_cast<ArrayType>(expressionTypes[ctx]);
+  auto arrayType = typeCast<ArrayType>(expressionTypes.get(ctx));
   if (!arrayType) {
     throw std::runtime_error("Invalid array type in allocation: " + ctx->type()->getText());
   }
@@ -1818,7 +1766,7 @@ void BytecodeIRGeneratorListener::exitAllocate_array(cgullParser::Allocate_array
   if (ctx->expression().size() > 0) {
     // all dimension sizes are on the stack
     std::string typeString = BytecodeCompiler::typeToJVMType(arrayType);
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(baseType);
+    auto primitiveType = typeCast<PrimitiveType>(baseType);
     auto newInst = std::make_shared<IRRawInstruction>("multianewarray " + typeString + " " +
                                                       std::to_string(ctx->expression().size()));
     currentFunction->instructions.push_back(newInst);
@@ -1826,7 +1774,7 @@ void BytecodeIRGeneratorListener::exitAllocate_array(cgullParser::Allocate_array
 }
 
 void BytecodeIRGeneratorListener::enterArray_expression(cgullParser::Array_expressionContext* ctx) {
-  auto arrayType = std::dynamic_pointer_cast<ArrayType>(expressionTypes[ctx]);
+  auto arrayType = typeCast<ArrayType>(expressionTypes.get(ctx));
   if (!arrayType) {
     throw std::runtime_error("Invalid array type in allocation: " + ctx->getText());
   }
@@ -1844,13 +1792,13 @@ void BytecodeIRGeneratorListener::enterIndexable(cgullParser::IndexableContext*
   // load identifier based on resolved scope and type
   auto scope = getCurrentScope(ctx);
   std::string identifier = ctx->IDENTIFIER()->getText();
-  auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(scope->resolve(identifier));
+  auto varSymbol = resolveVariable(scope, ctx->IDENTIFIER());
 
   if (varSymbol) {
     auto type = varSymbol->dataType;
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
-    auto pointerType = std::dynamic_pointer_cast<PointerType>(type);
-    auto arrayType = std::dynamic_pointer_cast<ArrayType>(type);
+    auto primitiveType = typeCast<PrimitiveType>(type);
+    auto pointerType = typeCast<PointerType>(type);
+    auto arrayType = typeCast<ArrayType>(type);
 
     if (varSymbol->isStructMember) {
       auto loadThis = std::make_shared<IRRawInstruction>("aload 0");
@@ -1878,24 +1826,16 @@ void BytecodeIRGeneratorListener::enterStruct_definition(cgullParser::Struct_def
   auto structClass = std::make_shared<IRClass>();
   structClass->name = structName;
   currentClassStack.push(structClass);
-  classes.push_back(structClass);
+  if (!classHandler) {
+    classes.push_back(structClass);
+  }
 }
 
 void BytecodeIRGeneratorListener::exitStruct_definition(cgullParser::Struct_definitionContext* ctx) {
   // generate the constructor method with all the public fields
   auto structClass = currentClassStack.top();
-  auto constructor = constructorMap[structClass->name];
-  if (!constructor) {
-    throw std::runtime_error("Constructor not found for struct: " + structClass->name);
-  }
-  constructor->name = "<init>";
-  std::vector<std::shared_ptr<VariableSymbol>> parameters;
-  for (auto variable : structClass->variables) {
-    if (!variable->isPrivate) {
-      parameters.push_back(variable);
-    }
-  }
-  constructor->parameters = parameters;
+  // takes the public fields, in the order they are declared
+  auto constructor = getJvmConstructor(structClass->name);
 
   // initialize the object
   auto initInst = std::make_shared<IRRawInstruction>("aload 0");
@@ -1905,14 +1845,14 @@ void BytecodeIRGeneratorListener::exitStruct_definition(cgullParser::Struct_defi
 
   // create the instructions to putfield for each variable
   for (int i = 0; i < structClass->variables.size(); i++) {
-    auto variable = std::dynamic_pointer_cast<VariableSymbol>(structClass->variables[i]);
+    auto variable = dynamic_cast<VariableSymbol*>(structClass->variables[i]);
     if (!variable->isPrivate) {
       // load in the object
       auto thisInst = std::make_shared<IRRawInstruction>("aload 0");
       constructor->instructions.push_back(thisInst);
       // load based on type
       if (variable->dataType->getKind() == Type::TypeKind::PRIMITIVE) {
-        auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(variable->dataType);
+        auto primitiveType = typeCast<PrimitiveType>(variable->dataType);
         auto loadInst =
             std::make_shared<IRRawInstruction>(getLoadInstruction(primitiveType) + " " + std::to_string(i + 1));
         constructor->instructions.push_back(loadInst);
@@ -1927,13 +1867,13 @@ void BytecodeIRGeneratorListener::exitStruct_definition(cgullParser::Struct_defi
     }
   }
   constructor->instructions.push_back(std::make_shared<IRRawInstruction>("return"));
-  // return void
-  constructor->returnTypes.push_back(std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
   structClass->methods.push_back(constructor);
+  completeMethod(structClass, constructor);
 
   if (!currentClassStack.empty()) {
     currentClassStack.pop();
   }
+  completeClass(structClass);
 }
 
 void BytecodeIRGeneratorListener::enterField_access(cgullParser::Field_accessContext* ctx) {
@@ -1955,9 +1895,8 @@ void BytecodeIRGeneratorListener::exitField_access(cgullParser::Field_accessCont
 void BytecodeIRGeneratorListener::enterField(cgullParser::FieldContext* ctx) {
   // generate getfield for index_expressions on structs
   if (ctx->index_expression() && lastFieldType) {
-    auto structSymbol = std::dynamic_pointer_cast<UserDefinedType>(lastFieldType)->getTypeSymbol();
-    auto fieldSymbol = std::dynamic_pointer_cast<VariableSymbol>(
-        structSymbol->scope->resolve(ctx->index_expression()->indexable()->IDENTIFIER()->getText()));
+    auto structSymbol = typeCast<UserDefinedType>(lastFieldType)->getTypeSymbol();
+    auto fieldSymbol = resolveVariable(structSymbol->scope, ctx->index_expression()->indexable()->IDENTIFIER());
     if (!fieldSymbol) {
       throw std::runtime_error("Field not found: " + ctx->index_expression()->indexable()->IDENTIFIER()->getText());
     }
@@ -1975,7 +1914,7 @@ void BytecodeIRGeneratorListener::exitField(cgullParser::FieldContext* ctx) {
     if (ctx->IDENTIFIER()) {
       auto scope = getCurrentScope(ctx);
       std::string identifier = ctx->IDENTIFIER()->getText();
-      auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(scope->resolve(identifier));
+      auto varSymbol = resolveVariable(scope, ctx->IDENTIFIER());
       // if its a member access, we need to get field instead of aload
       if (varSymbol->isStructMember) {
         auto aloadInst = std::make_shared<IRRawInstruction>("aload 0");
@@ -1990,11 +1929,11 @@ void BytecodeIRGeneratorListener::exitField(cgullParser::FieldContext* ctx) {
       }
       lastFieldType = varSymbol->dataType;
     } else if (ctx->index_expression()) {
-      lastFieldType = expressionTypes[ctx->index_expression()];
+      lastFieldType = expressionTypes.get(ctx->index_expression());
     } else if (ctx->function_call()) {
-      lastFieldType = resolvedMethodSymbols[ctx->function_call()]->returnTypes[0];
+      lastFieldType = resolvedMethodSymbols.get(ctx->function_call())->returnTypes[0];
     } else {
-      lastFieldType = expressionTypes[ctx->expression()];
+      lastFieldType = expressionTypes.get(ctx->expression());
     }
     // if this context should be dereferenced, do so
     if (isDereferenceContexts[ctx]) {
@@ -2003,7 +1942,7 @@ void BytecodeIRGeneratorListener::exitField(cgullParser::FieldContext* ctx) {
     return;
   }
   // take appropriate action based on last field type loaded...
-  auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(lastFieldType);
+  auto userDefinedType = typeCast<UserDefinedType>(lastFieldType);
   auto assignmentContext = dynamic_cast<cgullParser::Assignment_statementContext*>(ctx->parent->parent->parent);
   auto parentFieldAccess = dynamic_cast<cgullParser::Field_accessContext*>(ctx->parent);
   if (assignmentContext && parentFieldAccess) {
@@ -2017,18 +1956,17 @@ void BytecodeIRGeneratorListener::exitField(cgullParser::FieldContext* ctx) {
     auto structSymbol = userDefinedType->getTypeSymbol();
     if (ctx->function_call()) {
       // method call handled in exitFunction_call
-      lastFieldType = resolvedMethodSymbols[ctx->function_call()]->returnTypes[0];
+      lastFieldType = resolvedMethodSymbols.get(ctx->function_call())->returnTypes[0];
     } else if (ctx->index_expression()) {
       auto lastField = parentFieldAccess->field(parentFieldAccess->field().size() - 1);
       if (!(ctx == lastField)) {
         auto loadInst = std::make_shared<IRRawInstruction>(getArrayOperationInstruction(lastFieldType, false));
         currentFunction->instructions.push_back(loadInst);
       }
-      lastFieldType = expressionTypes[ctx->index_expression()];
+      lastFieldType = expressionTypes.get(ctx->index_expression());
     } else {
       // handle field access
-      auto fieldSymbol =
-          std::dynamic_pointer_cast<VariableSymbol>(structSymbol->scope->resolve(ctx->IDENTIFIER()->getText()));
+      auto fieldSymbol = resolveVariable(structSymbol->scope, ctx->IDENTIFIER());
       if (!fieldSymbol) {
         throw std::runtime_error("Field not found: " + ctx->IDENTIFIER()->getText());
       }
@@ -2046,29 +1984,29 @@ void BytecodeIRGeneratorListener::exitField(cgullParser::FieldContext* ctx) {
   }
 }
 
-std::string BytecodeIRGeneratorListener::getArrayOperationInstruction(const std::shared_ptr<Type>& type, bool isStore) {
-  auto arrayType = std::dynamic_pointer_cast<ArrayType>(type);
-  auto pointerType = std::dynamic_pointer_cast<PointerType>(type);
-  auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
-  auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(type);
-
-  if (arrayType || pointerType || userDefinedType) {
+std::string BytecodeIRGeneratorListener::getArrayOperationInstruction(Type* type, bool isStore) {
+  switch (type->getKind()) {
+  case Type::TypeKind::ARRAY:
+  case Type::TypeKind::POINTER:
+  case Type::TypeKind::USER_DEFINED:
     return isStore ? "aastore" : "aaload";
-  } else if (primitiveType) {
-    auto primitiveKind = primitiveType->getPrimitiveKind();
+  case Type::TypeKind::PRIMITIVE: {
+    auto primitiveKind = static_cast<PrimitiveType*>(type)->getPrimitiveKind();
     std::string prefix = primitiveKind == PrimitiveType::PrimitiveKind::INT         ? "i"
                          : (primitiveKind == PrimitiveType::PrimitiveKind::FLOAT)   ? "f"
                          : (primitiveKind == PrimitiveType::PrimitiveKind::BOOLEAN) ? "b"
                                                                                     : "a";
     return prefix + (isStore ? "astore" : "aload");
   }
-  throw std::runtime_error("Unsupported type for array operation: " + type->toString());
+  default:
+    throw std::runtime_error("Unsupported type for array operation: " + type->toString());
+  }
 }
 
 void BytecodeIRGeneratorListener::generateDereference(antlr4::ParserRuleContext* ctx) {
-  auto derefType = expressionTypes[ctx];
+  auto derefType = expressionTypes.get(ctx);
   if (derefType->getKind() == Type::TypeKind::PRIMITIVE) {
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(derefType);
+    auto primitiveType = typeCast<PrimitiveType>(derefType);
     auto irClass = primitiveWrappers[primitiveType->getPrimitiveKind()];
     if (!irClass) {
       throw std::runtime_error("Primitive type " + primitiveType->toString() + " has no wrapper class");
@@ -1,23 +1,34 @@
 #ifndef BYTECODE_IR_GENERATOR_LISTENER_H
 #define BYTECODE_IR_GENERATOR_LISTENER_H
 
+#include "../analysis_result.h"
+#include "../arena.h"
 #include "../errors/error_reporter.h"
 #include "../instructions/ir_class.h"
 #include "../symbols/symbol.h"
 #include "cgullBaseListener.h"
+#include <functional>
 
 class BytecodeIRGeneratorListener : public cgullBaseListener {
 public:
+  // the analysis tables are read in place, never copied
+  // the symbols codegen creates (the JVM constructors) go into objects, which has to outlive the generated classes
   BytecodeIRGeneratorListener(
-      ErrorReporter& errorReporter, std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& scopes,
-      std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>>& expressionTypes,
-      std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>>& resolvedMethodSymbols,
-      std::unordered_set<antlr4::ParserRuleContext*>& expectingStringConversion,
+      ErrorReporter& errorReporter, const AnalysisResult& analysis,
       std::unordered_map<PrimitiveType::PrimitiveKind, std::shared_ptr<IRClass>>& primitiveWrappers,
-      std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>>& constructorMap);
+      ObjectArena& objects);
 
   const std::vector<std::shared_ptr<IRClass>>& getClasses() const;
 
+  // with a handler, every class is handed to it as soon as its IR is complete instead of being kept for getClasses
+  // set before the walk
+  using ClassHandler = std::function<void(const std::shared_ptr<IRClass>&)>;
+  void setClassHandler(ClassHandler handler);
+  // with a method handler, every method is handed to it, with its class, as soon as its IR is complete. its class is
+  // handed to the class handler after all of its methods
+  using MethodHandler = std::function<void(const std::shared_ptr<IRClass>&, FunctionSymbol*)>;
+  void setMethodHandler(MethodHandler handler);
+
 private:
   struct IfLabels {
     std::string endIfLabel;
@@ -41,46 +52,62 @@ private:
   };
 
   ErrorReporter& errorReporter;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& scopes;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>> expressionTypes;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>> resolvedMethodSymbols;
-  std::unordered_set<antlr4::ParserRuleContext*> expectingStringConversion;
+  // the innermost scope of every node
+  const NodeTable<Scope*>& nodeScopes;
+  const NodeTable<Type*>& expressionTypes;
+  const NodeTable<FunctionSymbol*>& resolvedMethodSymbols;
+  const NodeSet& expectingStringConversion;
+  // what each node is to its parent, instead of casting the parent to find out
+  const NodeTable<NodeRole>& nodeRoles;
   std::unordered_map<PrimitiveType::PrimitiveKind, std::shared_ptr<IRClass>>& primitiveWrappers;
   std::vector<std::shared_ptr<IRClass>> classes;
   std::stack<std::shared_ptr<IRClass>> currentClassStack;
-  std::shared_ptr<FunctionSymbol> currentFunction;
+  ClassHandler classHandler;
+  MethodHandler methodHandler;
+  ObjectArena& objects;
+  FunctionSymbol* currentFunction = nullptr;
   int currentLocalIndex = 0;
   bool dereferenceAssignment = false;
-  std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>>& constructorMap;
+  // the analyzed constructors, by struct name. they are never changed, each struct gets a JVM constructor of its own
+  const std::unordered_map<std::string, FunctionSymbol*>& constructorMap;
+  std::unordered_map<std::string, FunctionSymbol*> jvmConstructors;
 
   int labelCounter = 0;
   std::stack<std::string> breakLabels;
-  std::unordered_map<cgullParser::If_statementContext*, IfLabels> ifLabelsMap;
-  std::unordered_map<cgullParser::If_expressionContext*, IfLabels> ifExpressionLabelsMap;
-  std::unordered_map<cgullParser::Until_statementContext*, SimpleLoopLabels> untilLabelsMap;
-  std::unordered_map<cgullParser::While_statementContext*, SimpleLoopLabels> whileLabelsMap;
-  std::unordered_map<cgullParser::For_statementContext*, ForLoopLabels> forLabelsMap;
-  std::unordered_map<cgullParser::Infinite_loop_statementContext*, SimpleLoopLabels> infiniteLoopLabelsMap;
-  std::unordered_map<cgullParser::Base_expressionContext*, ExpressionLabels> expressionLabelsMap;
-  std::unordered_map<cgullParser::Base_expressionContext*, cgullParser::Base_expressionContext*> parentExpressionMap;
+  // keyed by the if, loop and logical expression nodes
+  NodeTable<IfLabels> ifLabelsMap;
+  NodeTable<IfLabels> ifExpressionLabelsMap;
+  NodeTable<SimpleLoopLabels> untilLabelsMap;
+  NodeTable<SimpleLoopLabels> whileLabelsMap;
+  NodeTable<ForLoopLabels> forLabelsMap;
+  NodeTable<SimpleLoopLabels> infiniteLoopLabelsMap;
+  NodeTable<ExpressionLabels> expressionLabelsMap;
+  NodeTable<cgullParser::Base_expressionContext*> parentExpressionMap;
 
   // store temporary context for field access
-  std::shared_ptr<Type> lastFieldType = nullptr;
-  std::unordered_map<antlr4::ParserRuleContext*, bool> isDereferenceContexts;
+  Type* lastFieldType = nullptr;
+  NodeTable<bool> isDereferenceContexts;
 
-  std::shared_ptr<Scope> getCurrentScope(antlr4::ParserRuleContext* ctx) const;
+  // one lookup in nodeScopes
+  Scope* getCurrentScope(antlr4::ParserRuleContext* ctx) const;
   std::string generateLabel();
-
-  int assignLocalIndex(const std::shared_ptr<VariableSymbol>& variable);
-  int getLocalIndex(const std::string& variableName, std::shared_ptr<Scope> scope);
+  // hands the class to the handler if there is one
+  void completeClass(const std::shared_ptr<IRClass>& irClass);
+  // hands the method to the method handler if there is one
+  void completeMethod(const std::shared_ptr<IRClass>& irClass, FunctionSymbol* method);
+  // the <init> of a struct: the analyzed constructor's parameters, returning void to the JVM. its signature is known
+  // before the struct's code is generated, so calls to it can be emitted anywhere
+  FunctionSymbol* getJvmConstructor(const std::string& structName);
+
+  int assignLocalIndex(VariableSymbol* variable);
+  int getLocalIndex(const std::string& variableName, Scope* scope);
   void generateStringConversion(antlr4::ParserRuleContext* ctx);
-  std::string getLoadInstruction(const std::shared_ptr<PrimitiveType>& primitiveType);
-  std::string getStoreInstruction(const std::shared_ptr<PrimitiveType>& primitiveType);
-  std::string getArrayOperationInstruction(const std::shared_ptr<Type>& type, bool isStore);
+  std::string getLoadInstruction(PrimitiveType* primitiveType);
+  std::string getStoreInstruction(PrimitiveType* primitiveType);
+  std::string getArrayOperationInstruction(Type* type, bool isStore);
   void generateDereference(antlr4::ParserRuleContext* ctx);
   void handleLogicalExpression(cgullParser::Base_expressionContext* ctx);
-  void convertPrimitiveToPrimitive(const std::shared_ptr<PrimitiveType>& fromType,
-                                   const std::shared_ptr<PrimitiveType>& toType);
+  void convertPrimitiveToPrimitive(PrimitiveType* fromType, PrimitiveType* toType);
 
   virtual void enterProgram(cgullParser::ProgramContext* ctx) override;
   virtual void exitProgram(cgullParser::ProgramContext* ctx) override;
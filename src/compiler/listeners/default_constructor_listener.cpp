@@ -1,43 +1,44 @@
 #include "default_constructor_listener.h"
+#include "../input/arena_token_factory.h"
 
-DefaultConstructorListener::DefaultConstructorListener(
-    ErrorReporter& errorReporter, const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& scopes)
-    : errorReporter(errorReporter), scopes(scopes) {}
+DefaultConstructorListener::DefaultConstructorListener(ErrorReporter& errorReporter, const NodeTable<Scope*>& scopes,
+                                                       ObjectArena& objects)
+    : errorReporter(errorReporter), scopes(scopes), objects(objects) {}
 
-std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>> DefaultConstructorListener::getConstructorMap() {
-  return constructorMap;
+std::unordered_map<std::string, FunctionSymbol*> DefaultConstructorListener::takeConstructorMap() {
+  return std::move(constructorMap);
 }
 
 void DefaultConstructorListener::enterStruct_definition(cgullParser::Struct_definitionContext* ctx) {
-  auto structScope = scopes.at(ctx);
-  auto structSymbol = std::dynamic_pointer_cast<TypeSymbol>(structScope->resolve(ctx->IDENTIFIER()->getText()));
+  auto structScope = scopes.get(ctx);
+  auto structSymbol = dynamic_cast<TypeSymbol*>(
+      structScope->resolve(identifierAtom(ctx->IDENTIFIER(), structScope->getAtoms())));
   if (!structSymbol) {
     errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(), "unresolved reference to struct");
     return;
   }
 
-  auto constructorSymbol = std::make_shared<FunctionSymbol>(structSymbol->name, ctx->getStart()->getLine(),
-                                                            ctx->getStart()->getCharPositionInLine(), structScope);
+  auto constructorSymbol = objects.create<FunctionSymbol>(structSymbol->name, ctx->getStart()->getLine(),
+                                                          ctx->getStart()->getCharPositionInLine(), structScope);
 
   constructorSymbol->isStructMethod = true;
   // get all the member fields of the struct
-  std::vector<std::shared_ptr<VariableSymbol>> memberFields;
+  std::vector<VariableSymbol*> memberFields;
   for (const auto& member : structScope->symbols) {
-    auto memberSymbol = std::dynamic_pointer_cast<VariableSymbol>(member.second);
+    auto memberSymbol = dynamic_cast<VariableSymbol*>(member.second);
     if (memberSymbol && !memberSymbol->isPrivate) {
       memberFields.push_back(memberSymbol);
     }
   }
   // sort the member fields by their line number
-  std::sort(memberFields.begin(), memberFields.end(),
-            [](const std::shared_ptr<Symbol>& a, const std::shared_ptr<Symbol>& b) {
+  std::sort(memberFields.begin(), memberFields.end(), [](Symbol* a, Symbol* b) {
               return a->definedAtLine < b->definedAtLine;
             });
   // add the member fields as parameters to the constructor
   for (const auto& field : memberFields) {
     auto paramSymbol =
-        std::make_shared<VariableSymbol>(field->name, field->definedAtLine, field->definedAtColumn, structScope);
+        objects.create<VariableSymbol>(field->name, field->definedAtLine, field->definedAtColumn, structScope);
     paramSymbol->dataType = field->dataType;
     if (field->isDefined) {
       paramSymbol->hasDefaultValue = true;
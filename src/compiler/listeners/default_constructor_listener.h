@@ -1,21 +1,24 @@
 #ifndef DEFAULT_CONSTRUCTOR_LISTENER_H
 #define DEFAULT_CONSTRUCTOR_LISTENER_H
 
+#include "../arena.h"
 #include "../errors/error_reporter.h"
+#include "../node_table.h"
 #include "../symbols/symbol.h"
 #include <cgullBaseListener.h>
 
 class DefaultConstructorListener : public cgullBaseListener {
 public:
-  DefaultConstructorListener(ErrorReporter& errorReporter,
-                             const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& scopes);
+  DefaultConstructorListener(ErrorReporter& errorReporter, const NodeTable<Scope*>& scopes, ObjectArena& objects);
 
-  std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>> getConstructorMap();
+  // moved out, so it can only be taken once
+  std::unordered_map<std::string, FunctionSymbol*> takeConstructorMap();
 
 private:
   ErrorReporter& errorReporter;
-  const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& scopes;
-  std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>> constructorMap;
+  const NodeTable<Scope*>& scopes;
+  ObjectArena& objects;
+  std::unordered_map<std::string, FunctionSymbol*> constructorMap;
 
   void enterStruct_definition(cgullParser::Struct_definitionContext* ctx) override;
 };
@@ -0,0 +1,44 @@
+#include "multi_listener_walker.h"
+
+MultiListenerWalker::MultiListenerWalker(std::vector<antlr4::tree::ParseTreeListener*> listeners, size_t maxDepth)
+    : listeners(std::move(listeners)), maxDepth(maxDepth) {}
+
+void MultiListenerWalker::walk(antlr4::tree::ParseTree* tree) { walk(tree, 0); }
+
+void MultiListenerWalker::walk(antlr4::tree::ParseTree* tree, size_t depth) {
+  nodesVisited++;
+  // same events in the same order as antlr4::tree::ParseTreeWalker
+  if (auto* errorNode = dynamic_cast<antlr4::tree::ErrorNode*>(tree)) {
+    for (auto* listener : listeners) {
+      listener->visitErrorNode(errorNode);
+    }
+    return;
+  }
+  if (auto* terminal = dynamic_cast<antlr4::tree::TerminalNode*>(tree)) {
+    for (auto* listener : listeners) {
+      listener->visitTerminal(terminal);
+    }
+    return;
+  }
+
+  auto* ctx = static_cast<antlr4::ParserRuleContext*>(tree);
+  for (auto* listener : listeners) {
+    listener->enterEveryRule(ctx);
+    ctx->enterRule(listener);
+  }
+  if (depth < maxDepth) {
+    for (auto* child : ctx->children) {
+      if (skip) {
+        auto* childCtx = dynamic_cast<antlr4::ParserRuleContext*>(child);
+        if (childCtx != nullptr && skip(childCtx)) {
+          continue;
+        }
+      }
+      walk(child, depth + 1);
+    }
+  }
+  for (auto* listener : listeners) {
+    ctx->exitRule(listener);
+    listener->exitEveryRule(ctx);
+  }
+}
@@ -0,0 +1,38 @@
+#ifndef MULTI_LISTENER_WALKER_H
+#define MULTI_LISTENER_WALKER_H
+
+#include <antlr4-runtime.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// walks a parse tree once for several listeners, like running ParseTreeWalker for each of them but touching every
+// node only once. each node is entered (and later exited) by the listeners in the order they were given, so every
+// listener still sees exactly the events of a walk of its own. only listeners that don't depend on each other's
+// results for the rest of the tree can share a walk
+//
+// maxDepth stops the walk that many levels below the root, for listeners that only handle nodes near the top
+class MultiListenerWalker {
+public:
+  explicit MultiListenerWalker(std::vector<antlr4::tree::ParseTreeListener*> listeners,
+                               size_t maxDepth = SIZE_MAX);
+
+  // asked before every rule node below the root, a node it returns true for is left out with everything below it,
+  // for subtrees that are walked separately
+  void setSkip(std::function<bool(antlr4::ParserRuleContext*)> skip) { this->skip = std::move(skip); }
+
+  void walk(antlr4::tree::ParseTree* tree);
+
+  // nodes visited by every walk so far, each counted once however many listeners it had
+  uint64_t getNodesVisited() const { return nodesVisited; }
+
+private:
+  std::vector<antlr4::tree::ParseTreeListener*> listeners;
+  size_t maxDepth;
+  std::function<bool(antlr4::ParserRuleContext*)> skip;
+  uint64_t nodesVisited = 0;
+
+  void walk(antlr4::tree::ParseTree* tree, size_t depth);
+};
+
+#endif // MULTI_LISTENER_WALKER_H
@@ -1,19 +1,20 @@
 #include "special_methods_listener.h"
 #include "../symbols/symbol.h"
 #include "../symbols/type.h"
+#include "../symbols/type_table.h"
 
-SpecialMethodsListener::SpecialMethodsListener(
-    ErrorReporter& errorReporter, const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& scopes)
-    : errorReporter(errorReporter), scopes(scopes) {}
+SpecialMethodsListener::SpecialMethodsListener(ErrorReporter& errorReporter, const NodeTable<Scope*>& scopes,
+                                               ObjectArena& objects)
+    : errorReporter(errorReporter), scopes(scopes), objects(objects) {}
 
 void SpecialMethodsListener::enterStruct_definition(cgullParser::Struct_definitionContext* ctx) {
   // update scope
-  auto scopeIt = scopes.find(ctx);
-  if (scopeIt == scopes.end()) {
+  const auto* scope = scopes.find(ctx);
+  if (scope == nullptr) {
     return;
   }
 
-  std::shared_ptr<Scope> structScope = scopeIt->second;
+  Scope* structScope = *scope;
   std::string structName = ctx->IDENTIFIER()->getSymbol()->getText();
   int line = ctx->IDENTIFIER()->getSymbol()->getLine();
   int column = ctx->IDENTIFIER()->getSymbol()->getCharPositionInLine();
@@ -23,8 +24,8 @@ void SpecialMethodsListener::enterStruct_definition(cgullParser::Struct_definiti
   validateToStringMethod(structScope, structName, line, column);
 }
 
-void SpecialMethodsListener::validateToStringMethod(const std::shared_ptr<Scope>& structScope,
-                                                    const std::string& structName, int line, int column) {
+void SpecialMethodsListener::validateToStringMethod(Scope* structScope, const std::string& structName, int line,
+                                                    int column) {
   auto toStringSymbol = structScope->resolve("$toString_");
 
   if (!toStringSymbol) {
@@ -39,7 +40,7 @@ void SpecialMethodsListener::validateToStringMethod(const std::shared_ptr<Scope>
     return;
   }
 
-  auto funcSymbol = std::dynamic_pointer_cast<FunctionSymbol>(toStringSymbol);
+  auto funcSymbol = dynamic_cast<FunctionSymbol*>(toStringSymbol);
   if (funcSymbol->parameters.size() != 0) {
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, line, column,
                               "$toString in struct " + structName + " must take no parameters");
@@ -52,7 +53,7 @@ void SpecialMethodsListener::validateToStringMethod(const std::shared_ptr<Scope>
   }
 
   auto returnType = funcSymbol->returnTypes[0];
-  auto primitiveReturnType = std::dynamic_pointer_cast<PrimitiveType>(returnType);
+  auto primitiveReturnType = typeCast<PrimitiveType>(returnType);
 
   if (!primitiveReturnType || primitiveReturnType->getPrimitiveKind() != PrimitiveType::PrimitiveKind::STRING) {
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, line, column,
@@ -60,28 +61,28 @@ void SpecialMethodsListener::validateToStringMethod(const std::shared_ptr<Scope>
   }
 }
 
-void SpecialMethodsListener::validateNoUnsupportedSpecialMethods(const std::shared_ptr<Scope>& structScope,
-                                                                 const std::string& structName, int line, int column) {
+void SpecialMethodsListener::validateNoUnsupportedSpecialMethods(Scope* structScope, const std::string& structName,
+                                                                 int line, int column) {
   // check all symbols in the struct scope
-  for (const auto& [name, symbol] : structScope->symbols) {
+  for (const auto& [atom, symbol] : structScope->symbols) {
+    std::string_view name = structScope->getName(atom);
     // if it starts with $ and is not one of our supported special methods
     if (name.size() > 0 && name[0] == '$' && name != "$toString_") {
       errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, line, column,
-                                "unsupported special method '" + name + "' in struct " + structName);
+                                "unsupported special method '" + std::string(name) + "' in struct " + structName);
       return;
     }
   }
 }
 
-void SpecialMethodsListener::addDefaultToStringMethod(const std::shared_ptr<Scope>& structScope,
-                                                      const std::string& structName) {
+void SpecialMethodsListener::addDefaultToStringMethod(Scope* structScope, const std::string& structName) {
   // Create function symbol for $toString
-  auto toStringSymbol = std::make_shared<FunctionSymbol>("$toString", 0, 0, structScope);
+  auto toStringSymbol = objects.create<FunctionSymbol>("$toString", 0, 0, structScope);
   toStringSymbol->type = SymbolType::FUNCTION;
   toStringSymbol->isDefined = true;
 
   // set return type to string
-  auto stringType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::STRING);
+  auto stringType = TypeTable::primitive(PrimitiveType::PrimitiveKind::STRING);
   toStringSymbol->returnTypes.push_back(stringType);
 
   // add to scope
@@ -1,36 +1,49 @@
 #include "symbol_collection_listener.h"
 #include "../errors/error_reporter.h"
+#include "../input/arena_token_factory.h"
 #include <memory>
 
-SymbolCollectionListener::SymbolCollectionListener(ErrorReporter& errorReporter, std::shared_ptr<Scope> existingScope)
-    : errorReporter(errorReporter) {
+namespace {
+
+// the optional '*' of a type, looked up by token type so no text is built
+bool hasPointerSuffix(cgullParser::TypeContext* typeCtx) {
+  for (auto child : typeCtx->children) {
+    auto terminal = dynamic_cast<antlr4::tree::TerminalNode*>(child);
+    if (terminal && terminal->getSymbol()->getType() == cgullParser::MULT_OP) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+SymbolCollectionListener::SymbolCollectionListener(ErrorReporter& errorReporter, const FlatAst& ast,
+                                                   ObjectArena& objects, TypeTable& types, Scope* existingScope)
+    : errorReporter(errorReporter), ast(ast), objects(objects), types(types) {
   if (existingScope) {
     currentScope = existingScope;
   } else {
-    currentScope = std::make_shared<Scope>(nullptr);
+    currentScope = objects.create<Scope>(nullptr);
   }
   globalScope = currentScope;
   scopes[nullptr] = globalScope;
 }
 
-std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>> SymbolCollectionListener::getScopeMapping() {
-  return scopes;
-}
-
-std::shared_ptr<Scope> SymbolCollectionListener::getCurrentScope() { return currentScope; }
+Scope* SymbolCollectionListener::getCurrentScope() { return currentScope; }
 
 /* rules that define symbols */
 
-std::shared_ptr<VariableSymbol> SymbolCollectionListener::createAndRegisterVariableSymbol(
+VariableSymbol* SymbolCollectionListener::createAndRegisterVariableSymbol(
     const std::string& identifier, cgullParser::TypeContext* typeCtx, bool isConst, int line, int column) {
 
-  auto varSymbol = std::make_shared<VariableSymbol>(identifier, line, column, currentScope);
+  auto varSymbol = objects.create<VariableSymbol>(identifier, line, column, currentScope);
 
-  std::shared_ptr<Type> resolvedType = resolveType(typeCtx);
+  Type* resolvedType = resolveType(typeCtx);
 
   if (!resolvedType) {
     errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, line, column, "unresolved type " + typeCtx->getText());
-    resolvedType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID);
+    resolvedType = TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID);
   }
 
   varSymbol->dataType = resolvedType;
@@ -59,7 +72,8 @@ void SymbolCollectionListener::enterVariable_declaration(cgullParser::Variable_d
 void SymbolCollectionListener::exitVariable_declaration(cgullParser::Variable_declarationContext* ctx) {
   // mark as defined if assigned an expression, or if its a struct definition as these must be defined
   auto [inStruct, structType] = isStructScope(currentScope);
-  auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(currentScope->resolve(ctx->IDENTIFIER()->getText()));
+  auto varSymbol = dynamic_cast<VariableSymbol*>(
+      currentScope->resolve(identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms())));
   varSymbol->isStructMember = inStruct;
   varSymbol->parentStructType = structType;
   if (ctx->expression() || inStruct) {
@@ -94,27 +108,42 @@ void SymbolCollectionListener::exitTop_level_struct_statement(cgullParser::Top_l
 /* rules that involve entering a new scope (and potentially a symbol) */
 
 void SymbolCollectionListener::enterProgram(cgullParser::ProgramContext* ctx) {
-  auto programScope = std::make_shared<Scope>(currentScope);
+  auto programScope = objects.create<Scope>(currentScope);
   programScope->parent = currentScope;
   currentScope = programScope;
   scopes[ctx] = currentScope;
+  currentScope->definingContext = ctx;
+}
+void SymbolCollectionListener::exitProgram(cgullParser::ProgramContext* ctx) {
+  currentScope = currentScope->parent;
+  recordNodeScopes();
+}
+
+void SymbolCollectionListener::recordNodeScopes() {
+  // ids are preorder, so a node's parent has its scope by the time the node is reached
+  nodeScopes = NodeTable<Scope*>();
+  nodeScopes[nullptr] = globalScope;
+  for (size_t id = 1; id < ast.size(); id++) {
+    const auto* scope = scopes.findId(id);
+    nodeScopes.atId(id) = scope ? *scope : nodeScopes.getId(ast.node(id).parent);
+  }
 }
-void SymbolCollectionListener::exitProgram(cgullParser::ProgramContext* ctx) { currentScope = currentScope->parent; }
 
 void SymbolCollectionListener::enterStruct_definition(cgullParser::Struct_definitionContext* ctx) {
-  auto structScope = std::make_shared<Scope>(currentScope);
+  auto structScope = objects.create<Scope>(currentScope);
   structScope->parent = currentScope;
   currentScope = structScope;
   scopes[ctx] = currentScope;
+  currentScope->definingContext = ctx;
 
   std::string identifier = ctx->IDENTIFIER()->getSymbol()->getText();
   int line = ctx->IDENTIFIER()->getSymbol()->getLine();
   int column = ctx->IDENTIFIER()->getSymbol()->getCharPositionInLine();
-  auto structSymbol = std::make_shared<TypeSymbol>(identifier, line, column, currentScope);
+  auto structSymbol = objects.create<TypeSymbol>(identifier, line, column, currentScope);
   structSymbol->memberScope = currentScope;
   structSymbol->type = SymbolType::STRUCT;
 
-  auto structType = std::make_shared<UserDefinedType>(structSymbol);
+  auto structType = types.userDefined(structSymbol);
   structSymbol->typeRepresentation = structType;
 
   if (!currentScope->parent->add(structSymbol)) {
@@ -131,17 +160,18 @@ void SymbolCollectionListener::exitStruct_definition(cgullParser::Struct_definit
 }
 
 void SymbolCollectionListener::enterFunction_definition(cgullParser::Function_definitionContext* ctx) {
-  auto functionScope = std::make_shared<Scope>(currentScope);
+  auto functionScope = objects.create<Scope>(currentScope);
   functionScope->parent = currentScope;
   currentScope = functionScope;
   scopes[ctx] = currentScope;
+  currentScope->definingContext = ctx;
 
   std::string identifierName = ctx->IDENTIFIER()->getSymbol()->getText();
   std::string specialToken = ctx->FN_SPECIAL() ? ctx->FN_SPECIAL()->getText() : "";
   std::string identifier = specialToken + identifierName;
   int line = ctx->IDENTIFIER()->getSymbol()->getLine();
   int column = ctx->IDENTIFIER()->getSymbol()->getCharPositionInLine();
-  auto functionSymbol = std::make_shared<FunctionSymbol>(identifier, line, column, currentScope);
+  auto functionSymbol = objects.create<FunctionSymbol>(identifier, line, column, currentScope);
   functionSymbol->type = SymbolType::FUNCTION;
   functionSymbol->isPrivate = inPrivateScope;
   functionSymbol->isDefined = true; // for recursion
@@ -167,7 +197,7 @@ void SymbolCollectionListener::enterFunction_definition(cgullParser::Function_de
   // add "this" as a local variable if it's a struct method, not as a parameter
   if (isStructMethod && structSymbol) {
     // create the "this" variable (but not as a parameter)
-    auto thisVar = std::make_shared<VariableSymbol>("this", line, column, currentScope);
+    auto thisVar = objects.create<VariableSymbol>("this", line, column, currentScope);
     thisVar->dataType = structSymbol->typeRepresentation;
     thisVar->definedAtLine = line;
     thisVar->definedAtColumn = column;
@@ -184,10 +214,10 @@ void SymbolCollectionListener::enterFunction_definition(cgullParser::Function_de
     } else {
       errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, line, column,
                                 "unresolved type " + ctx->type()->getText());
-      functionSymbol->returnTypes.push_back(std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+      functionSymbol->returnTypes.push_back(TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     }
   } else {
-    functionSymbol->returnTypes.push_back(std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    functionSymbol->returnTypes.push_back(TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
   }
 
   // Use addFunction instead of add to properly register for overload resolution
@@ -204,50 +234,55 @@ void SymbolCollectionListener::exitFunction_definition(cgullParser::Function_def
 }
 
 void SymbolCollectionListener::enterWhile_statement(cgullParser::While_statementContext* ctx) {
-  auto whileScope = std::make_shared<Scope>(currentScope);
+  auto whileScope = objects.create<Scope>(currentScope);
   whileScope->parent = currentScope;
   currentScope = whileScope;
   scopes[ctx] = currentScope;
+  currentScope->definingContext = ctx;
 }
 void SymbolCollectionListener::exitWhile_statement(cgullParser::While_statementContext* ctx) {
   currentScope = currentScope->parent;
 }
 
 void SymbolCollectionListener::enterUntil_statement(cgullParser::Until_statementContext* ctx) {
-  auto untilScope = std::make_shared<Scope>(currentScope);
+  auto untilScope = objects.create<Scope>(currentScope);
   untilScope->parent = currentScope;
   currentScope = untilScope;
   scopes[ctx] = currentScope;
+  currentScope->definingContext = ctx;
 }
 void SymbolCollectionListener::exitUntil_statement(cgullParser::Until_statementContext* ctx) {
   currentScope = currentScope->parent;
 }
 
 void SymbolCollectionListener::enterFor_statement(cgullParser::For_statementContext* ctx) {
-  auto forScope = std::make_shared<Scope>(currentScope);
+  auto forScope = objects.create<Scope>(currentScope);
   forScope->parent = currentScope;
   currentScope = forScope;
   scopes[ctx] = currentScope;
+  currentScope->definingContext = ctx;
 }
 void SymbolCollectionListener::exitFor_statement(cgullParser::For_statementContext* ctx) {
   currentScope = currentScope->parent;
 }
 
 void SymbolCollectionListener::enterInfinite_loop_statement(cgullParser::Infinite_loop_statementContext* ctx) {
-  auto infiniteLoopScope = std::make_shared<Scope>(currentScope);
+  auto infiniteLoopScope = objects.create<Scope>(currentScope);
   infiniteLoopScope->parent = currentScope;
   currentScope = infiniteLoopScope;
   scopes[ctx] = currentScope;
+  currentScope->definingContext = ctx;
 }
 void SymbolCollectionListener::exitInfinite_loop_statement(cgullParser::Infinite_loop_statementContext* ctx) {
   currentScope = currentScope->parent;
 }
 
 void SymbolCollectionListener::enterBranch_block(cgullParser::Branch_blockContext* ctx) {
-  auto branchScope = std::make_shared<Scope>(currentScope);
+  auto branchScope = objects.create<Scope>(currentScope);
   branchScope->parent = currentScope;
   currentScope = branchScope;
   scopes[ctx] = currentScope;
+  currentScope->definingContext = ctx;
 }
 void SymbolCollectionListener::exitBranch_block(cgullParser::Branch_blockContext* ctx) {
   currentScope = currentScope->parent;
@@ -259,11 +294,11 @@ void SymbolCollectionListener::enterIndexable(cgullParser::IndexableContext* ctx
   // check that any identifiers inside the indexable are defined
   for (auto child : ctx->children) {
     if (auto varCtx = dynamic_cast<cgullParser::VariableContext*>(child)) {
-      std::string identifier = varCtx->IDENTIFIER()->getSymbol()->getText();
-      auto varSymbol = currentScope->resolve(identifier);
+      auto varSymbol = currentScope->resolve(identifierAtom(varCtx->IDENTIFIER(), currentScope->getAtoms()));
       if (!varSymbol) {
         errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, varCtx->getStart()->getLine(),
-                                  varCtx->getStart()->getCharPositionInLine(), "unresolved variable " + identifier);
+                                  varCtx->getStart()->getCharPositionInLine(),
+                                  "unresolved variable " + varCtx->IDENTIFIER()->getText());
       }
     }
   }
@@ -273,11 +308,11 @@ void SymbolCollectionListener::enterDereferenceable(cgullParser::Dereferenceable
   // check that any identifiers inside the dereferenceable are defined
   for (auto child : ctx->children) {
     if (auto varCtx = dynamic_cast<cgullParser::VariableContext*>(child)) {
-      std::string identifier = varCtx->IDENTIFIER()->getSymbol()->getText();
-      auto varSymbol = currentScope->resolve(identifier);
+      auto varSymbol = currentScope->resolve(identifierAtom(varCtx->IDENTIFIER(), currentScope->getAtoms()));
       if (!varSymbol) {
         errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, varCtx->getStart()->getLine(),
-                                  varCtx->getStart()->getCharPositionInLine(), "unresolved variable " + identifier);
+                                  varCtx->getStart()->getCharPositionInLine(),
+                                  "unresolved variable " + varCtx->IDENTIFIER()->getText());
       }
     }
   }
@@ -287,11 +322,11 @@ void SymbolCollectionListener::enterFunction_call(cgullParser::Function_callCont
   // check that any identifiers inside the function call are defined
   for (auto child : ctx->children) {
     if (auto varCtx = dynamic_cast<cgullParser::VariableContext*>(child)) {
-      std::string identifier = varCtx->IDENTIFIER()->getSymbol()->getText();
-      auto varSymbol = currentScope->resolve(identifier);
+      auto varSymbol = currentScope->resolve(identifierAtom(varCtx->IDENTIFIER(), currentScope->getAtoms()));
       if (!varSymbol) {
         errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, varCtx->getStart()->getLine(),
-                                  varCtx->getStart()->getCharPositionInLine(), "unresolved variable " + identifier);
+                                  varCtx->getStart()->getCharPositionInLine(),
+                                  "unresolved variable " + varCtx->IDENTIFIER()->getText());
       }
     }
   }
@@ -301,11 +336,11 @@ void SymbolCollectionListener::enterCast_expression(cgullParser::Cast_expression
   // check that any identifiers inside the cast expression are defined
   for (auto child : ctx->children) {
     if (auto varCtx = dynamic_cast<cgullParser::VariableContext*>(child)) {
-      std::string identifier = varCtx->IDENTIFIER()->getSymbol()->getText();
-      auto varSymbol = currentScope->resolve(identifier);
+      auto varSymbol = currentScope->resolve(identifierAtom(varCtx->IDENTIFIER(), currentScope->getAtoms()));
       if (!varSymbol) {
         errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, varCtx->getStart()->getLine(),
-                                  varCtx->getStart()->getCharPositionInLine(), "unresolved variable " + identifier);
+                                  varCtx->getStart()->getCharPositionInLine(),
+                                  "unresolved variable " + varCtx->IDENTIFIER()->getText());
       }
     }
   }
@@ -315,11 +350,11 @@ void SymbolCollectionListener::enterPostfix_expression(cgullParser::Postfix_expr
   // check that any identifiers inside the postfix expression are defined
   for (auto child : ctx->children) {
     if (auto varCtx = dynamic_cast<cgullParser::VariableContext*>(child)) {
-      std::string identifier = varCtx->IDENTIFIER()->getSymbol()->getText();
-      auto varSymbol = currentScope->resolve(identifier);
+      auto varSymbol = currentScope->resolve(identifierAtom(varCtx->IDENTIFIER(), currentScope->getAtoms()));
       if (!varSymbol) {
         errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, varCtx->getStart()->getLine(),
-                                  varCtx->getStart()->getCharPositionInLine(), "unresolved variable " + identifier);
+                                  varCtx->getStart()->getCharPositionInLine(),
+                                  "unresolved variable " + varCtx->IDENTIFIER()->getText());
       }
     }
   }
@@ -328,26 +363,25 @@ void SymbolCollectionListener::enterPostfix_expression(cgullParser::Postfix_expr
 void SymbolCollectionListener::enterVariable(cgullParser::VariableContext* ctx) {
   // check that any identifiers inside the variable are resolved
   if (ctx->IDENTIFIER()) {
-    std::string identifier = ctx->IDENTIFIER()->getSymbol()->getText();
-    auto varSymbol = currentScope->resolve(identifier);
+    auto varSymbol = currentScope->resolve(identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms()));
     if (!varSymbol) {
       errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
-                                ctx->getStart()->getCharPositionInLine(), "unresolved variable " + identifier);
+                                ctx->getStart()->getCharPositionInLine(),
+                                "unresolved variable " + ctx->IDENTIFIER()->getText());
     }
   }
 }
 
 /* helpers */
 
-std::shared_ptr<Type> SymbolCollectionListener::resolveType(cgullParser::TypeContext* typeCtx) {
-  std::shared_ptr<Type> baseType = nullptr;
+Type* SymbolCollectionListener::resolveType(cgullParser::TypeContext* typeCtx) {
+  Type* baseType = nullptr;
   if (typeCtx->primitive_type()) {
-    std::string primitiveTypeName = typeCtx->primitive_type()->getText();
-    baseType = resolvePrimitiveType(primitiveTypeName);
+    baseType = resolvePrimitiveType(typeCtx->primitive_type());
   } else if (typeCtx->user_defined_type()) {
-    std::string typeName = typeCtx->user_defined_type()->getText();
-    auto resolvedTypeSymbol = currentScope->resolve(typeName);
-    if (auto typeSymbol = std::dynamic_pointer_cast<TypeSymbol>(resolvedTypeSymbol)) {
+    auto resolvedTypeSymbol =
+        currentScope->resolve(identifierAtom(typeCtx->user_defined_type()->IDENTIFIER(), currentScope->getAtoms()));
+    if (auto typeSymbol = dynamic_cast<TypeSymbol*>(resolvedTypeSymbol)) {
       baseType = typeSymbol->typeRepresentation;
     }
   }
@@ -357,49 +391,47 @@ std::shared_ptr<Type> SymbolCollectionListener::resolveType(cgullParser::TypeCon
   }
 
   // handle pointers
-  for (auto child : typeCtx->children) {
-    if (child->getText() == "*") {
-      baseType = std::make_shared<PointerType>(baseType);
-    }
+  if (hasPointerSuffix(typeCtx)) {
+    baseType = types.pointerTo(baseType);
   }
 
   if (typeCtx->array_suffix().size() > 0) {
     for (auto suffix : typeCtx->array_suffix()) {
-      baseType = std::make_shared<ArrayType>(baseType);
+      baseType = types.arrayOf(baseType);
     }
   }
   return baseType;
 }
 
-std::shared_ptr<Type> SymbolCollectionListener::resolvePrimitiveType(const std::string& typeName) {
-  if (typeName == "int")
-    return std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::INT);
-  if (typeName == "float")
-    return std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::FLOAT);
-  if (typeName == "bool")
-    return std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::BOOLEAN);
-  if (typeName == "string")
-    return std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::STRING);
-  if (typeName == "void")
-    return std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID);
-
-  return nullptr;
-}
-
-std::pair<bool, std::shared_ptr<TypeSymbol>> SymbolCollectionListener::isStructScope(std::shared_ptr<Scope> scope) {
-  for (const auto& [ctx, mappedScope] : scopes) {
-    if (mappedScope == scope && dynamic_cast<cgullParser::Struct_definitionContext*>(ctx)) {
-      auto structCtx = dynamic_cast<cgullParser::Struct_definitionContext*>(ctx);
-      std::string structName = structCtx->IDENTIFIER()->getSymbol()->getText();
-
-      if (scope->parent) {
-        auto structSymbol = scope->parent->resolve(structName);
-        if (structSymbol && structSymbol->type == SymbolType::STRUCT) {
-          return {true, std::dynamic_pointer_cast<TypeSymbol>(structSymbol)};
-        }
-      }
-      return {true, nullptr};
+Type* SymbolCollectionListener::resolvePrimitiveType(cgullParser::Primitive_typeContext* primitiveCtx) {
+  switch (primitiveCtx->getStart()->getType()) {
+  case cgullParser::INT_TYPE:
+    return TypeTable::primitive(PrimitiveType::PrimitiveKind::INT);
+  case cgullParser::FLOAT_TYPE:
+    return TypeTable::primitive(PrimitiveType::PrimitiveKind::FLOAT);
+  case cgullParser::BOOLEAN_TYPE:
+    return TypeTable::primitive(PrimitiveType::PrimitiveKind::BOOLEAN);
+  case cgullParser::STRING_TYPE:
+    return TypeTable::primitive(PrimitiveType::PrimitiveKind::STRING);
+  case cgullParser::VOID_TYPE:
+    return TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID);
+  default:
+    return nullptr;
+  }
+}
+
+std::pair<bool, TypeSymbol*> SymbolCollectionListener::isStructScope(Scope* scope) {
+  // the node that opened the scope, the global scope has none
+  size_t id = scope != nullptr ? NodeIndex::idOf(scope->definingContext) : 0;
+  if (id == 0 || ast.kind(id) != cgullParser::RuleStruct_definition) {
+    return {false, nullptr};
+  }
+
+  if (scope->parent) {
+    auto structSymbol = scope->parent->resolve(ast.node(id).identifier);
+    if (structSymbol && structSymbol->type == SymbolType::STRUCT) {
+      return {true, dynamic_cast<TypeSymbol*>(structSymbol)};
     }
   }
-  return {false, nullptr};
+  return {true, nullptr};
 }
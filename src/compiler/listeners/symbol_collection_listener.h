@@ -2,17 +2,27 @@
 #define SYMBOL_COLLECTION_LISTENER_H
 
 #include "../errors/error_reporter.h"
+#include "../flat_ast.h"
+#include "../node_table.h"
 #include "../symbols/symbol.h"
+#include "../symbols/type_table.h"
 #include <cgullBaseListener.h>
 #include <string>
 #include <unordered_map>
 
 class SymbolCollectionListener : public cgullBaseListener {
 public:
-  SymbolCollectionListener(ErrorReporter& errorReporter, std::shared_ptr<Scope> existingScope = nullptr);
-
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>> getScopeMapping();
-  std::shared_ptr<Scope> getCurrentScope();
+  // ast has to be lowered from the tree this listener walks
+  // scopes and symbols are created in objects
+  SymbolCollectionListener(ErrorReporter& errorReporter, const FlatAst& ast, ObjectArena& objects,
+                           TypeTable& types, Scope* existingScope = nullptr);
+
+  // the scopes opened by nodes (functions, blocks, structs), moved out like the node scopes
+  NodeTable<Scope*> takeScopeMapping() { return std::move(scopes); }
+  // the innermost scope of every node, its own or the nearest ancestor's, filled in once the program is walked
+  // moved out, so it can only be taken once
+  NodeTable<Scope*> takeNodeScopes() { return std::move(nodeScopes); }
+  Scope* getCurrentScope();
 
   /* strictly symbol related */
   virtual void enterVariable_declaration(cgullParser::Variable_declarationContext* ctx) override;
@@ -65,18 +75,23 @@ public:
   virtual void enterVariable(cgullParser::VariableContext* ctx) override;
 
 private:
-  std::shared_ptr<Scope> currentScope;
-  std::shared_ptr<Scope> globalScope;
+  Scope* currentScope = nullptr;
+  Scope* globalScope = nullptr;
   ErrorReporter& errorReporter;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>> scopes;
+  const FlatAst& ast;
+  ObjectArena& objects;
+  TypeTable& types;
+  NodeTable<Scope*> scopes;
+  NodeTable<Scope*> nodeScopes;
   bool inPrivateScope = false;
 
-  std::shared_ptr<Type> resolveType(cgullParser::TypeContext* typeCtx);
-  std::shared_ptr<Type> resolvePrimitiveType(const std::string& typeName);
-  std::shared_ptr<VariableSymbol> createAndRegisterVariableSymbol(const std::string& identifier,
-                                                                  cgullParser::TypeContext* typeCtx, bool isConst,
-                                                                  int line, int column);
-  std::pair<bool, std::shared_ptr<TypeSymbol>> isStructScope(std::shared_ptr<Scope> scope);
+  void recordNodeScopes();
+
+  Type* resolveType(cgullParser::TypeContext* typeCtx);
+  Type* resolvePrimitiveType(cgullParser::Primitive_typeContext* primitiveCtx);
+  VariableSymbol* createAndRegisterVariableSymbol(const std::string& identifier, cgullParser::TypeContext* typeCtx,
+                                                  bool isConst, int line, int column);
+  std::pair<bool, TypeSymbol*> isStructScope(Scope* scope);
 };
 
 #endif // SYMBOL_COLLECTION_LISTENER_H
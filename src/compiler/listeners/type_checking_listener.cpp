@@ -1,42 +1,67 @@
 #include "type_checking_listener.h"
+#include "../input/arena_token_factory.h"
+#include "../input/native_lexer.h"
 #include "cgullParser.h"
 #include <memory>
 
-TypeCheckingListener::TypeCheckingListener(
-    ErrorReporter& errorReporter, const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& scopes,
-    std::shared_ptr<Scope> globalScope)
-    : errorReporter(errorReporter), scopes(scopes), globalScope(globalScope), currentScope(globalScope) {}
+namespace {
 
-std::shared_ptr<Type> TypeCheckingListener::getExpressionType(antlr4::ParserRuleContext* ctx) const {
-  auto it = expressionTypes.find(ctx);
-  if (it != expressionTypes.end()) {
-    return it->second;
+// the optional '*' of a type, looked up by token type so no text is built
+bool hasPointerSuffix(cgullParser::TypeContext* typeCtx) {
+  for (auto child : typeCtx->children) {
+    auto terminal = dynamic_cast<antlr4::tree::TerminalNode*>(child);
+    if (terminal && terminal->getSymbol()->getType() == cgullParser::MULT_OP) {
+      return true;
+    }
   }
-  return nullptr;
+  return false;
 }
 
-std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>> TypeCheckingListener::getExpressionTypes() const {
-  return expressionTypes;
+// the called name as written, only built for error messages
+std::string calledName(cgullParser::Function_callContext* ctx) {
+  std::string name = ctx->IDENTIFIER()->getText();
+  return ctx->FN_SPECIAL() ? ctx->FN_SPECIAL()->getText() + name : name;
 }
 
-std::unordered_set<antlr4::ParserRuleContext*> TypeCheckingListener::getExpectingStringConversion() const {
-  return expectingStringConversion;
+} // namespace
+
+TypeCheckingListener::TypeCheckingListener(ErrorReporter& errorReporter, const NodeTable<Scope*>& nodeScopes,
+                                           TypeTable& types, Scope* globalScope, size_t firstNodeId)
+    : errorReporter(errorReporter), nodeScopes(nodeScopes), types(types), globalScope(globalScope),
+      currentScope(globalScope), expressionTypes(firstNodeId), resolvedMethodSymbols(firstNodeId),
+      expectingStringConversion(firstNodeId), fieldAccessContexts(firstNodeId), isDereferenceContexts(firstNodeId) {}
+
+void TypeCheckingListener::merge(const TypeCheckingListener& functionChecker) {
+  expressionTypes.merge(functionChecker.expressionTypes);
+  resolvedMethodSymbols.merge(functionChecker.resolvedMethodSymbols);
+  expectingStringConversion.merge(functionChecker.expectingStringConversion);
 }
 
-std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>>
-TypeCheckingListener::getResolvedMethodSymbols() const {
-  return resolvedMethodSymbols;
+Type* TypeCheckingListener::getExpressionType(antlr4::ParserRuleContext* ctx) const {
+  return expressionTypes.get(ctx);
 }
 
-void TypeCheckingListener::setExpressionType(antlr4::ParserRuleContext* ctx, std::shared_ptr<Type> type) {
+NodeTable<Type*> TypeCheckingListener::takeExpressionTypes() {
+  return std::move(expressionTypes);
+}
+
+NodeSet TypeCheckingListener::takeExpectingStringConversion() {
+  return std::move(expectingStringConversion);
+}
+
+NodeTable<FunctionSymbol*> TypeCheckingListener::takeResolvedMethodSymbols() {
+  return std::move(resolvedMethodSymbols);
+}
+
+void TypeCheckingListener::setExpressionType(antlr4::ParserRuleContext* ctx, Type* type) {
   expressionTypes[ctx] = type;
 }
 
-void TypeCheckingListener::enterEveryRule(antlr4::ParserRuleContext* ctx) {
-  auto scopeIt = scopes.find(ctx);
-  if (scopeIt != scopes.end()) {
-    currentScope = scopeIt->second;
-  }
+void TypeCheckingListener::enterEveryRule(antlr4::ParserRuleContext* ctx) { currentScope = nodeScopes.get(ctx); }
+
+void TypeCheckingListener::exitEveryRule(antlr4::ParserRuleContext* ctx) {
+  // back in the parent, which may be in an outer scope than the child just left
+  currentScope = nodeScopes.get(static_cast<antlr4::ParserRuleContext*>(ctx->parent));
 }
 
 void TypeCheckingListener::enterFunction_definition(cgullParser::Function_definitionContext* ctx) {
@@ -44,10 +69,8 @@ void TypeCheckingListener::enterFunction_definition(cgullParser::Function_defini
 
   // find the function symbol and get its return types
   if (ctx->IDENTIFIER()) {
-    std::string functionName = ctx->IDENTIFIER()->getSymbol()->getText();
-
     // extract parameter types from the parameter list to find the correct overload
-    std::vector<std::shared_ptr<Type>> paramTypes;
+    std::vector<Type*> paramTypes;
     if (ctx->parameter_list()) {
       for (auto paramCtx : ctx->parameter_list()->parameter()) {
         auto paramType = resolveType(paramCtx->type());
@@ -55,15 +78,16 @@ void TypeCheckingListener::enterFunction_definition(cgullParser::Function_defini
           paramTypes.push_back(paramType);
         } else {
           // if we can't resolve a parameter type, use void as placeholder
-          paramTypes.push_back(std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+          paramTypes.push_back(TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
         }
       }
     }
+    // special functions are stored under their prefixed name, which no token carries
+    Atom functionAtom = identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms());
     if (ctx->FN_SPECIAL()) {
-      functionName = ctx->FN_SPECIAL()->getText() + functionName;
+      functionAtom = currentScope->getAtoms().special(functionAtom);
     }
-    auto funcSymbol =
-        std::dynamic_pointer_cast<FunctionSymbol>(currentScope->resolveFunctionCall(functionName, paramTypes));
+    auto funcSymbol = currentScope->resolveFunctionCall(functionAtom, paramTypes);
 
     if (funcSymbol) {
       currentFunctionReturnTypes = funcSymbol->returnTypes;
@@ -79,9 +103,8 @@ void TypeCheckingListener::exitReturn_statement(cgullParser::Return_statementCon
   if (!ctx->expression()) {
     // check if function expects no return values (void)
     if (currentFunctionReturnTypes.empty() ||
-        (currentFunctionReturnTypes.size() == 1 &&
-         std::dynamic_pointer_cast<PrimitiveType>(currentFunctionReturnTypes[0]) &&
-         std::dynamic_pointer_cast<PrimitiveType>(currentFunctionReturnTypes[0])->getPrimitiveKind() ==
+        (currentFunctionReturnTypes.size() == 1 && typeCast<PrimitiveType>(currentFunctionReturnTypes[0]) &&
+         typeCast<PrimitiveType>(currentFunctionReturnTypes[0])->getPrimitiveKind() ==
              PrimitiveType::PrimitiveKind::VOID)) {
       return;
     } else {
@@ -115,15 +138,14 @@ void TypeCheckingListener::exitReturn_statement(cgullParser::Return_statementCon
   }
 }
 
-std::shared_ptr<Type> TypeCheckingListener::resolveType(cgullParser::TypeContext* typeCtx) {
-  std::shared_ptr<Type> baseType = nullptr;
+Type* TypeCheckingListener::resolveType(cgullParser::TypeContext* typeCtx) {
+  Type* baseType = nullptr;
   if (typeCtx->primitive_type()) {
-    std::string primitiveTypeName = typeCtx->primitive_type()->getText();
-    baseType = resolvePrimitiveType(primitiveTypeName);
+    baseType = resolvePrimitiveType(typeCtx->primitive_type());
   } else if (typeCtx->user_defined_type()) {
-    std::string typeName = typeCtx->user_defined_type()->getText();
-    auto resolvedTypeSymbol = currentScope->resolve(typeName);
-    if (auto typeSymbol = std::dynamic_pointer_cast<TypeSymbol>(resolvedTypeSymbol)) {
+    auto resolvedTypeSymbol =
+        currentScope->resolve(identifierAtom(typeCtx->user_defined_type()->IDENTIFIER(), currentScope->getAtoms()));
+    if (auto typeSymbol = dynamic_cast<TypeSymbol*>(resolvedTypeSymbol)) {
       baseType = typeSymbol->typeRepresentation;
     }
   }
@@ -132,43 +154,43 @@ std::shared_ptr<Type> TypeCheckingListener::resolveType(cgullParser::TypeContext
     return nullptr;
   }
 
-  for (auto child : typeCtx->children) {
-    if (child->getText() == "*") {
-      baseType = std::make_shared<PointerType>(baseType);
-    }
+  if (hasPointerSuffix(typeCtx)) {
+    baseType = types.pointerTo(baseType);
   }
 
   if (typeCtx->array_suffix().size() > 0) {
     for (auto suffix : typeCtx->array_suffix()) {
-      baseType = std::make_shared<ArrayType>(baseType);
+      baseType = types.arrayOf(baseType);
     }
   }
 
   return baseType;
 }
 
-std::shared_ptr<Type> TypeCheckingListener::resolvePrimitiveType(const std::string& typeName) {
-  if (typeName == "int")
-    return std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::INT);
-  if (typeName == "float")
-    return std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::FLOAT);
-  if (typeName == "bool")
-    return std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::BOOLEAN);
-  if (typeName == "string")
-    return std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::STRING);
-  if (typeName == "void")
-    return std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID);
-
-  return nullptr;
+Type* TypeCheckingListener::resolvePrimitiveType(cgullParser::Primitive_typeContext* primitiveCtx) {
+  switch (primitiveCtx->getStart()->getType()) {
+  case cgullParser::INT_TYPE:
+    return TypeTable::primitive(PrimitiveType::PrimitiveKind::INT);
+  case cgullParser::FLOAT_TYPE:
+    return TypeTable::primitive(PrimitiveType::PrimitiveKind::FLOAT);
+  case cgullParser::BOOLEAN_TYPE:
+    return TypeTable::primitive(PrimitiveType::PrimitiveKind::BOOLEAN);
+  case cgullParser::STRING_TYPE:
+    return TypeTable::primitive(PrimitiveType::PrimitiveKind::STRING);
+  case cgullParser::VOID_TYPE:
+    return TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID);
+  default:
+    return nullptr;
+  }
 }
 
-bool TypeCheckingListener::hasToStringMethod(const std::shared_ptr<Type>& type) {
+bool TypeCheckingListener::hasToStringMethod(Type* type) {
   // handle primitive types and non-user-defined types
   if (!type || type->getKind() != Type::TypeKind::USER_DEFINED) {
     return false;
   }
 
-  auto userType = std::dynamic_pointer_cast<UserDefinedType>(type);
+  auto userType = typeCast<UserDefinedType>(type);
   if (!userType || !userType->getTypeSymbol() || !userType->getTypeSymbol()->memberScope) {
     return false;
   }
@@ -178,27 +200,27 @@ bool TypeCheckingListener::hasToStringMethod(const std::shared_ptr<Type>& type)
     return false;
   }
 
-  auto funcSymbol = std::dynamic_pointer_cast<FunctionSymbol>(toStringSymbol);
+  auto funcSymbol = dynamic_cast<FunctionSymbol*>(toStringSymbol);
   if (funcSymbol->returnTypes.size() != 1) {
     return false;
   }
   auto returnType = funcSymbol->returnTypes[0];
-  auto primitiveReturnType = std::dynamic_pointer_cast<PrimitiveType>(returnType);
+  auto primitiveReturnType = typeCast<PrimitiveType>(returnType);
   return primitiveReturnType && primitiveReturnType->getPrimitiveKind() == PrimitiveType::PrimitiveKind::STRING;
 }
 
-bool TypeCheckingListener::canConvertToString(const std::shared_ptr<Type>& type) {
+bool TypeCheckingListener::canConvertToString(Type* type) {
   if (!type) {
     return false;
   }
   // pointers can be converted to string, it'll just be the address
-  auto pointerType = std::dynamic_pointer_cast<PointerType>(type);
+  auto pointerType = typeCast<PointerType>(type);
   if (pointerType) {
     return true;
   }
 
   // any primitive type can be converted to string
-  auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(type);
+  auto primitiveType = typeCast<PrimitiveType>(type);
   if (primitiveType) {
     return true;
   }
@@ -207,9 +229,7 @@ bool TypeCheckingListener::canConvertToString(const std::shared_ptr<Type>& type)
   return hasToStringMethod(type);
 }
 
-bool TypeCheckingListener::areTypesCompatible(const std::shared_ptr<Type>& sourceType,
-                                              const std::shared_ptr<Type>& targetType,
-                                              antlr4::ParserRuleContext* sourceCtx,
+bool TypeCheckingListener::areTypesCompatible(Type* sourceType, Type* targetType, antlr4::ParserRuleContext* sourceCtx,
                                               antlr4::ParserRuleContext* targetCtx) {
   // same types are always compatible
   if (sourceType->equals(targetType)) {
@@ -217,7 +237,7 @@ bool TypeCheckingListener::areTypesCompatible(const std::shared_ptr<Type>& sourc
   }
 
   // check if target is string and source has a $toString method
-  auto targetPrimitive = std::dynamic_pointer_cast<PrimitiveType>(targetType);
+  auto targetPrimitive = typeCast<PrimitiveType>(targetType);
   if (targetPrimitive && targetPrimitive->getPrimitiveKind() == PrimitiveType::PrimitiveKind::STRING &&
       canConvertToString(sourceType)) {
     expectingStringConversion.insert(static_cast<antlr4::ParserRuleContext*>(targetCtx));
@@ -225,14 +245,14 @@ bool TypeCheckingListener::areTypesCompatible(const std::shared_ptr<Type>& sourc
   }
 
   // check pointer types
-  auto sourcePointer = std::dynamic_pointer_cast<PointerType>(sourceType);
-  auto targetPointer = std::dynamic_pointer_cast<PointerType>(targetType);
+  auto sourcePointer = typeCast<PointerType>(sourceType);
+  auto targetPointer = typeCast<PointerType>(targetType);
   if (sourcePointer && targetPointer) {
     // allow null pointer (void*) assignment to any pointer
     auto sourcePointedType = sourcePointer->getPointedType();
     auto targetPointedType = targetPointer->getPointedType();
 
-    auto sourceVoidType = std::dynamic_pointer_cast<PrimitiveType>(sourcePointedType);
+    auto sourceVoidType = typeCast<PrimitiveType>(sourcePointedType);
     if (sourceVoidType && sourceVoidType->getPrimitiveKind() == PrimitiveType::PrimitiveKind::VOID) {
       return true;
     }
@@ -244,7 +264,7 @@ bool TypeCheckingListener::areTypesCompatible(const std::shared_ptr<Type>& sourc
   // allow nullptr (void*) to be assigned to any user-defined type since they are references
   if (sourcePointer) {
     auto sourcePointedType = sourcePointer->getPointedType();
-    auto sourceVoidType = std::dynamic_pointer_cast<PrimitiveType>(sourcePointedType);
+    auto sourceVoidType = typeCast<PrimitiveType>(sourcePointedType);
     if (sourceVoidType && sourceVoidType->getPrimitiveKind() == PrimitiveType::PrimitiveKind::VOID) {
       if (targetType->getKind() == Type::TypeKind::USER_DEFINED) {
         return true;
@@ -255,67 +275,66 @@ bool TypeCheckingListener::areTypesCompatible(const std::shared_ptr<Type>& sourc
   return false;
 }
 
-std::shared_ptr<Type> TypeCheckingListener::getFieldType(const std::shared_ptr<Type>& baseType,
-                                                         const std::string& fieldName) {
+Type* TypeCheckingListener::getFieldType(Type* baseType, Atom fieldName) {
   if (!baseType) {
     return nullptr;
   }
 
   // if it's a pointer type, we cannot access its fields directly
-  if (auto pointerType = std::dynamic_pointer_cast<PointerType>(baseType)) {
+  if (auto pointerType = typeCast<PointerType>(baseType)) {
     return nullptr;
   }
 
-  if (auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(baseType)) {
+  if (auto userDefinedType = typeCast<UserDefinedType>(baseType)) {
     auto structSymbol = userDefinedType->getTypeSymbol();
     if (structSymbol && structSymbol->memberScope) {
       auto fieldSymbol = structSymbol->memberScope->resolve(fieldName);
-      if (auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(fieldSymbol)) {
+      if (auto varSymbol = dynamic_cast<VariableSymbol*>(fieldSymbol)) {
         return varSymbol->dataType;
       }
     }
   }
 
-  if (auto pointerType = std::dynamic_pointer_cast<PointerType>(baseType)) {
+  if (auto pointerType = typeCast<PointerType>(baseType)) {
     return getFieldType(pointerType->getPointedType(), fieldName);
   }
 
-  if (auto arrayType = std::dynamic_pointer_cast<ArrayType>(baseType)) {
+  if (auto arrayType = typeCast<ArrayType>(baseType)) {
     return arrayType->getElementType();
   }
 
   return nullptr;
 }
 
-std::shared_ptr<Type> TypeCheckingListener::getElementType(const std::shared_ptr<Type>& arrayType) {
+Type* TypeCheckingListener::getElementType(Type* arrayType) {
   if (!arrayType) {
     return nullptr;
   }
 
-  if (auto pointerType = std::dynamic_pointer_cast<PointerType>(arrayType)) {
+  if (auto pointerType = typeCast<PointerType>(arrayType)) {
     return pointerType->getPointedType();
   }
   return nullptr;
 }
 
-std::vector<std::shared_ptr<Type>>
+std::vector<Type*>
 TypeCheckingListener::collectArgumentTypes(cgullParser::Expression_listContext* exprList) {
-  std::vector<std::shared_ptr<Type>> argumentTypes;
+  std::vector<Type*> argumentTypes;
   if (exprList && exprList->expression().size() > 0) {
     for (auto expr : exprList->expression()) {
       auto exprType = getExpressionType(expr);
       if (exprType) {
         argumentTypes.push_back(exprType);
       } else {
-        argumentTypes.push_back(std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+        argumentTypes.push_back(TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
       }
     }
   }
   return argumentTypes;
 }
 
-void TypeCheckingListener::checkArgumentCompatibility(const std::vector<std::shared_ptr<Type>>& argumentTypes,
-                                                      const std::vector<std::shared_ptr<Type>>& parameterTypes,
+void TypeCheckingListener::checkArgumentCompatibility(const std::vector<Type*>& argumentTypes,
+                                                      const std::vector<Type*>& parameterTypes,
                                                       cgullParser::Expression_listContext* exprList,
                                                       const std::string& functionName, int line, int pos) {
 
@@ -342,12 +361,12 @@ void TypeCheckingListener::checkArgumentCompatibility(const std::vector<std::sha
 }
 
 void TypeCheckingListener::setFunctionCallReturnType(cgullParser::Function_callContext* ctx,
-                                                     const std::vector<std::shared_ptr<Type>>& returnTypes) {
+                                                     const std::vector<Type*>& returnTypes) {
 
   if (returnTypes.size() == 1) {
     setExpressionType(ctx, returnTypes[0]);
   } else {
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
   }
 }
 
@@ -358,48 +377,50 @@ void TypeCheckingListener::exitFunction_call(cgullParser::Function_callContext*
     return;
   }
 
-  std::string identifierName = ctx->IDENTIFIER()->getSymbol()->getText();
-  std::string specialToken = ctx->FN_SPECIAL() ? ctx->FN_SPECIAL()->getText() : "";
-  std::string functionName = specialToken + identifierName;
+  Atom functionAtom = identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms());
+  if (ctx->FN_SPECIAL()) {
+    functionAtom = currentScope->getAtoms().special(functionAtom);
+  }
   auto argumentTypes = collectArgumentTypes(ctx->expression_list());
 
   // method call in a field access context
   auto fieldAccessCtx = dynamic_cast<cgullParser::Field_accessContext*>(ctx->parent->parent);
   if (fieldAccessCtx) {
-    auto fieldAccessIt = fieldAccessContexts.find(fieldAccessCtx);
-    if (fieldAccessIt == fieldAccessContexts.end() || fieldAccessIt->second.empty()) {
+    auto* fieldAccessStack = fieldAccessContexts.find(fieldAccessCtx);
+    if (fieldAccessStack == nullptr || fieldAccessStack->empty()) {
       errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                                 ctx->getStart()->getCharPositionInLine(), "Cannot resolve type for field access");
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
       return;
     }
 
-    auto baseType = fieldAccessIt->second.top();
+    auto baseType = fieldAccessStack->top();
     if (!baseType) {
       errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                                 ctx->getStart()->getCharPositionInLine(), "Base type is null for method call");
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
       return;
     }
 
-    if (auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(baseType)) {
+    if (auto primitiveType = typeCast<PrimitiveType>(baseType)) {
       errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                                 ctx->getStart()->getCharPositionInLine(),
-                                "Cannot call method '" + functionName + "' on primitive type " + baseType->toString());
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+                                "Cannot call method '" + calledName(ctx) + "' on primitive type " +
+                                    baseType->toString());
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
       return;
     }
 
-    auto userDefinedType = std::dynamic_pointer_cast<UserDefinedType>(baseType);
+    auto userDefinedType = typeCast<UserDefinedType>(baseType);
     if (userDefinedType && userDefinedType->getTypeSymbol() && userDefinedType->getTypeSymbol()->memberScope) {
-      auto funcSymbol = userDefinedType->getTypeSymbol()->memberScope->resolveFunctionCall(functionName, argumentTypes);
+      auto funcSymbol = userDefinedType->getTypeSymbol()->memberScope->resolveFunctionCall(functionAtom, argumentTypes);
       if (funcSymbol) {
-        std::vector<std::shared_ptr<Type>> paramTypes;
+        std::vector<Type*> paramTypes;
         for (auto& param : funcSymbol->parameters) {
           paramTypes.push_back(param->dataType);
         }
 
-        checkArgumentCompatibility(argumentTypes, paramTypes, ctx->expression_list(), functionName,
+        checkArgumentCompatibility(argumentTypes, paramTypes, ctx->expression_list(), funcSymbol->name,
                                    ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine());
 
         setFunctionCallReturnType(ctx, funcSymbol->returnTypes);
@@ -407,35 +428,34 @@ void TypeCheckingListener::exitFunction_call(cgullParser::Function_callContext*
       } else {
         errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                                   ctx->getStart()->getCharPositionInLine(),
-                                  "Method '" + functionName + "' not found in type " + baseType->toString());
-        setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+                                  "Method '" + calledName(ctx) + "' not found in type " + baseType->toString());
+        setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
       }
     } else {
       errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                                 ctx->getStart()->getCharPositionInLine(),
                                 "Type " + baseType->toString() + " does not support method calls");
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     }
     return;
   }
 
-  auto funcSymbol =
-      std::dynamic_pointer_cast<FunctionSymbol>(currentScope->resolveFunctionCall(functionName, argumentTypes));
+  auto funcSymbol = dynamic_cast<FunctionSymbol*>(currentScope->resolveFunctionCall(functionAtom, argumentTypes));
 
   if (!funcSymbol) {
     errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(),
-                              "No matching function found for call to '" + functionName + "'");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+                              "No matching function found for call to '" + calledName(ctx) + "'");
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
-  std::vector<std::shared_ptr<Type>> paramTypes;
+  std::vector<Type*> paramTypes;
   for (auto& param : funcSymbol->parameters) {
     paramTypes.push_back(param->dataType);
   }
 
-  checkArgumentCompatibility(argumentTypes, paramTypes, ctx->expression_list(), functionName,
+  checkArgumentCompatibility(argumentTypes, paramTypes, ctx->expression_list(), funcSymbol->name,
                              ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine());
 
   setFunctionCallReturnType(ctx, funcSymbol->returnTypes);
@@ -443,12 +463,11 @@ void TypeCheckingListener::exitFunction_call(cgullParser::Function_callContext*
 
 void TypeCheckingListener::exitVariable(cgullParser::VariableContext* ctx) {
   if (ctx->IDENTIFIER()) {
-    std::string identifier = ctx->IDENTIFIER()->getSymbol()->getText();
-    auto varSymbol = currentScope->resolve(identifier);
-    if (auto variableSymbol = std::dynamic_pointer_cast<VariableSymbol>(varSymbol)) {
+    auto varSymbol = currentScope->resolve(identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms()));
+    if (auto variableSymbol = dynamic_cast<VariableSymbol*>(varSymbol)) {
       setExpressionType(ctx, variableSymbol->dataType);
     } else {
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     }
   } else if (ctx->field_access()) {
     auto fieldType = getExpressionType(ctx->field_access());
@@ -457,19 +476,19 @@ void TypeCheckingListener::exitVariable(cgullParser::VariableContext* ctx) {
 }
 
 void TypeCheckingListener::exitLiteral(cgullParser::LiteralContext* ctx) {
-  std::shared_ptr<Type> literalType;
+  Type* literalType = nullptr;
 
   if (ctx->NUMBER_LITERAL() || ctx->HEX_LITERAL() || ctx->BINARY_LITERAL()) {
-    literalType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::INT);
+    literalType = TypeTable::primitive(PrimitiveType::PrimitiveKind::INT);
   } else if (ctx->DECIMAL_LITERAL()) {
-    literalType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::FLOAT);
+    literalType = TypeTable::primitive(PrimitiveType::PrimitiveKind::FLOAT);
   } else if (ctx->STRING_LITERAL()) {
-    literalType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::STRING);
+    literalType = TypeTable::primitive(PrimitiveType::PrimitiveKind::STRING);
   } else if (ctx->BOOLEAN_TRUE() || ctx->BOOLEAN_FALSE()) {
-    literalType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::BOOLEAN);
+    literalType = TypeTable::primitive(PrimitiveType::PrimitiveKind::BOOLEAN);
   } else if (ctx->NULLPTR_LITERAL()) {
-    auto voidType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID);
-    literalType = std::make_shared<PointerType>(voidType);
+    auto voidType = TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID);
+    literalType = types.pointerTo(voidType);
   }
 
   setExpressionType(ctx, literalType);
@@ -477,17 +496,15 @@ void TypeCheckingListener::exitLiteral(cgullParser::LiteralContext* ctx) {
 
 void TypeCheckingListener::enterField_access(cgullParser::Field_accessContext* ctx) {
   std::vector<bool> isDereference;
+  // '->' has no named token, its type is looked up once
+  static const size_t arrowType = NativeLexer::literalType("'->'");
   for (auto expr : ctx->access_operator()) {
-    if (expr->getText() == "->") {
-      isDereference.push_back(true);
-    } else {
-      isDereference.push_back(false);
-    }
+    isDereference.push_back(expr->getStart()->getType() == arrowType);
   }
   for (int i = 0; i < isDereference.size(); i++) {
     isDereferenceContexts[ctx->field(i)] = isDereference[i];
   }
-  fieldAccessContexts[ctx] = std::stack<std::shared_ptr<Type>>();
+  fieldAccessContexts[ctx] = std::stack<Type*>();
 }
 
 void TypeCheckingListener::exitField_access(cgullParser::Field_accessContext* ctx) {
@@ -503,39 +520,38 @@ void TypeCheckingListener::exitField_access(cgullParser::Field_accessContext* ct
 
 void TypeCheckingListener::exitField(cgullParser::FieldContext* ctx) {
   // get the parent context's access stack
-  std::shared_ptr<Type> fieldType;
+  Type* fieldType = nullptr;
   auto parentCtx = dynamic_cast<cgullParser::Field_accessContext*>(ctx->parent);
 
   if (!parentCtx) {
     errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(), "Field not part of field access");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
-  auto fieldAccessIt = fieldAccessContexts.find(parentCtx);
-  if (fieldAccessIt == fieldAccessContexts.end()) {
+  auto* fieldAccessStack = fieldAccessContexts.find(parentCtx);
+  if (fieldAccessStack == nullptr) {
     errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(), "Field access context not found");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
-  auto& parentAccessStack = fieldAccessIt->second;
+  auto& parentAccessStack = *fieldAccessStack;
 
   // if there are no elements in the stack, we are at the base of the field access and we can just push the result type
   // without caring about a struct scope
   if (parentAccessStack.empty()) {
     antlr4::ParserRuleContext* baseCtx;
-    std::shared_ptr<Type> baseType;
+    Type* baseType = nullptr;
     if (ctx->function_call()) {
       baseCtx = ctx->function_call();
       baseType = getExpressionType(ctx->function_call());
     } else if (ctx->IDENTIFIER()) {
       baseCtx = ctx;
-      auto fieldName = ctx->IDENTIFIER()->getSymbol()->getText();
-      auto varSymbol = currentScope->resolve(fieldName);
-      auto variableSymbol = std::dynamic_pointer_cast<VariableSymbol>(varSymbol);
+      auto varSymbol = currentScope->resolve(identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms()));
+      auto variableSymbol = dynamic_cast<VariableSymbol*>(varSymbol);
       if (variableSymbol) {
         baseType = variableSymbol->dataType;
       } else {
@@ -570,12 +586,12 @@ void TypeCheckingListener::exitField(cgullParser::FieldContext* ctx) {
     } else if (ctx->index_expression()) {
       fieldType = getExpressionType(ctx->index_expression());
     } else if (ctx->IDENTIFIER()) {
-      auto fieldName = ctx->IDENTIFIER()->getSymbol()->getText();
-      fieldType = getFieldType(parentAccessStack.top(), fieldName);
+      fieldType = getFieldType(parentAccessStack.top(), identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms()));
       if (!fieldType) {
-        errorReporter.reportError(
-            ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(),
-            "Cannot resolve field '" + fieldName + "' in type " + parentAccessStack.top()->toString());
+        errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
+                                  ctx->getStart()->getCharPositionInLine(),
+                                  "Cannot resolve field '" + ctx->IDENTIFIER()->getText() + "' in type " +
+                                      parentAccessStack.top()->toString());
         return;
       }
     } else {
@@ -585,11 +601,9 @@ void TypeCheckingListener::exitField(cgullParser::FieldContext* ctx) {
     }
   }
   // check if we're meant to dereference the field access
-  auto isDereferenceIt = isDereferenceContexts.find(ctx);
-  if (isDereferenceIt != isDereferenceContexts.end()) {
-    auto isDereference = isDereferenceIt->second;
-    if (isDereference) {
-      auto pointerType = std::dynamic_pointer_cast<PointerType>(fieldType);
+  if (const bool* isDereference = isDereferenceContexts.find(ctx)) {
+    if (*isDereference) {
+      auto pointerType = typeCast<PointerType>(fieldType);
       if (!pointerType) {
         errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                                   ctx->getStart()->getCharPositionInLine(),
@@ -604,22 +618,22 @@ void TypeCheckingListener::exitField(cgullParser::FieldContext* ctx) {
 }
 
 void TypeCheckingListener::exitIndex_expression(cgullParser::Index_expressionContext* ctx) {
-  std::shared_ptr<Type> indexType;
+  Type* indexType = nullptr;
   for (auto expr : ctx->expression()) {
     indexType = getExpressionType(expr);
     if (!indexType) {
       errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                                 ctx->getStart()->getCharPositionInLine(), "Cannot resolve type for index expression");
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
       return;
     }
     // check if the index is a valid integer type
-    if (!std::dynamic_pointer_cast<PrimitiveType>(indexType) ||
-        std::dynamic_pointer_cast<PrimitiveType>(indexType)->getPrimitiveKind() != PrimitiveType::PrimitiveKind::INT) {
+    if (!typeCast<PrimitiveType>(indexType) ||
+        typeCast<PrimitiveType>(indexType)->getPrimitiveKind() != PrimitiveType::PrimitiveKind::INT) {
       errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                                 ctx->getStart()->getCharPositionInLine(),
                                 "Index type mismatch: expected int but got " + indexType->toString());
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
       return;
     }
   }
@@ -629,20 +643,20 @@ void TypeCheckingListener::exitIndex_expression(cgullParser::Index_expressionCon
     errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(),
                               "Cannot resolve base type for index expression");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
-  if (auto arrayType = std::dynamic_pointer_cast<ArrayType>(baseType)) {
+  if (auto arrayType = typeCast<ArrayType>(baseType)) {
     // for each expression, access the array type of the current dimension
-    std::shared_ptr<Type> currentType = arrayType;
+    Type* currentType = arrayType;
     for (auto expr : ctx->expression()) {
-      auto nextArrayType = std::dynamic_pointer_cast<ArrayType>(currentType);
+      auto nextArrayType = typeCast<ArrayType>(currentType);
       if (!nextArrayType) {
         errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                                   ctx->getStart()->getCharPositionInLine(),
                                   "Cannot index type " + currentType->toString() + " (not an array type)");
-        setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+        setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
         return;
       }
       currentType = nextArrayType->getElementType();
@@ -656,7 +670,7 @@ void TypeCheckingListener::exitIndex_expression(cgullParser::Index_expressionCon
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(),
                               "Cannot index type " + baseType->toString() + " (not an array type)");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
@@ -670,22 +684,22 @@ void TypeCheckingListener::exitIndexable(cgullParser::IndexableContext* ctx) {
     auto parentFieldAccessCtx =
         grandparentCtx ? dynamic_cast<cgullParser::Field_accessContext*>(grandparentCtx->parent) : nullptr;
     if (parentFieldAccessCtx && parentFieldAccessCtx->field(0) != grandparentCtx) {
-      auto fieldAccessIt = fieldAccessContexts.find(parentFieldAccessCtx);
-      if (fieldAccessIt != fieldAccessContexts.end()) {
+      if (auto* fieldAccessStack = fieldAccessContexts.find(parentFieldAccessCtx)) {
         // see if this identifier is a field of the struct
-        auto fieldName = ctx->IDENTIFIER()->getSymbol()->getText();
-        auto fieldType = getFieldType(fieldAccessIt->second.top(), fieldName);
+        auto fieldType =
+            getFieldType(fieldAccessStack->top(), identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms()));
         if (fieldType) {
           setExpressionType(ctx, fieldType);
         } else {
-          errorReporter.reportError(
-              ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(),
-              "Cannot resolve field '" + fieldName + "' in type " + fieldAccessIt->second.top()->toString());
+          errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
+                                    ctx->getStart()->getCharPositionInLine(),
+                                    "Cannot resolve field '" + ctx->IDENTIFIER()->getText() + "' in type " +
+                                        fieldAccessStack->top()->toString());
         }
       }
     } else {
-      auto varSymbol = currentScope->resolve(ctx->IDENTIFIER()->getSymbol()->getText());
-      if (auto variableSymbol = std::dynamic_pointer_cast<VariableSymbol>(varSymbol)) {
+      auto varSymbol = currentScope->resolve(identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms()));
+      if (auto variableSymbol = dynamic_cast<VariableSymbol*>(varSymbol)) {
         setExpressionType(ctx, variableSymbol->dataType);
       } else {
         errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
@@ -701,7 +715,7 @@ void TypeCheckingListener::exitAssignment_statement(cgullParser::Assignment_stat
   if (!ctx->expression())
     return;
 
-  std::shared_ptr<Type> targetType = nullptr;
+  Type* targetType = nullptr;
 
   // track what kind of assignment target we have for error messages
   std::string targetDescription;
@@ -750,13 +764,12 @@ void TypeCheckingListener::exitAssignment_statement(cgullParser::Assignment_stat
 
   // can't assign to const
   if (ctx->variable() && ctx->variable()->IDENTIFIER()) {
-    auto varName = ctx->variable()->IDENTIFIER()->getSymbol()->getText();
-    auto varSymbol = currentScope->resolve(varName);
-    if (auto variableSymbol = std::dynamic_pointer_cast<VariableSymbol>(varSymbol)) {
+    auto varSymbol = currentScope->resolve(identifierAtom(ctx->variable()->IDENTIFIER(), currentScope->getAtoms()));
+    if (auto variableSymbol = dynamic_cast<VariableSymbol*>(varSymbol)) {
       if (variableSymbol->isConstant) {
         errorReporter.reportError(ErrorType::ASSIGNMENT_TO_CONST, ctx->getStart()->getLine(),
                                   ctx->getStart()->getCharPositionInLine(),
-                                  "Cannot assign to const variable '" + varName + "'");
+                                  "Cannot assign to const variable '" + ctx->variable()->IDENTIFIER()->getText() + "'");
       }
     }
   }
@@ -788,15 +801,13 @@ void TypeCheckingListener::exitVariable_declaration(cgullParser::Variable_declar
 }
 
 void TypeCheckingListener::exitCast_expression(cgullParser::Cast_expressionContext* ctx) {
-  std::shared_ptr<Type> targetType;
+  Type* targetType = nullptr;
 
   if (ctx->primitive_type()) {
-    std::string typeName = ctx->primitive_type()->getText();
-    targetType = resolvePrimitiveType(typeName);
+    targetType = resolvePrimitiveType(ctx->primitive_type());
   } else if (ctx->IDENTIFIER()) {
-    std::string typeName = ctx->IDENTIFIER()->getSymbol()->getText();
-    auto resolvedTypeSymbol = currentScope->resolve(typeName);
-    if (auto typeSymbol = std::dynamic_pointer_cast<TypeSymbol>(resolvedTypeSymbol)) {
+    auto resolvedTypeSymbol = currentScope->resolve(identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms()));
+    if (auto typeSymbol = dynamic_cast<TypeSymbol*>(resolvedTypeSymbol)) {
       targetType = typeSymbol->typeRepresentation;
     }
   }
@@ -804,17 +815,16 @@ void TypeCheckingListener::exitCast_expression(cgullParser::Cast_expressionConte
   if (!targetType) {
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(), "Invalid target type for cast");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
-  std::shared_ptr<Type> sourceType;
+  Type* sourceType = nullptr;
   if (ctx->expression()) {
     sourceType = getExpressionType(ctx->expression());
   } else if (ctx->IDENTIFIER()) {
-    std::string varName = ctx->IDENTIFIER()->getSymbol()->getText();
-    auto varSymbol = currentScope->resolve(varName);
-    if (auto variableSymbol = std::dynamic_pointer_cast<VariableSymbol>(varSymbol)) {
+    auto varSymbol = currentScope->resolve(identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms()));
+    if (auto variableSymbol = dynamic_cast<VariableSymbol*>(varSymbol)) {
       sourceType = variableSymbol->dataType;
     }
   }
@@ -831,17 +841,17 @@ void TypeCheckingListener::exitCast_expression(cgullParser::Cast_expressionConte
 
 void TypeCheckingListener::exitDereference_expression(cgullParser::Dereference_expressionContext* ctx) {
   if (!ctx->dereferenceable()) {
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
   // when dereferencing, we need to properly get the base identifier type
-  std::shared_ptr<Type> baseType = nullptr;
+  Type* baseType = nullptr;
 
   if (ctx->dereferenceable()->IDENTIFIER()) {
-    std::string varName = ctx->dereferenceable()->IDENTIFIER()->getSymbol()->getText();
-    auto varSymbol = currentScope->resolve(varName);
-    if (auto variableSymbol = std::dynamic_pointer_cast<VariableSymbol>(varSymbol)) {
+    auto varSymbol =
+        currentScope->resolve(identifierAtom(ctx->dereferenceable()->IDENTIFIER(), currentScope->getAtoms()));
+    if (auto variableSymbol = dynamic_cast<VariableSymbol*>(varSymbol)) {
       baseType = variableSymbol->dataType;
     }
   } else {
@@ -851,16 +861,16 @@ void TypeCheckingListener::exitDereference_expression(cgullParser::Dereference_e
   if (!baseType) {
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(), "Cannot determine base type for dereference");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
-  auto pointerType = std::dynamic_pointer_cast<PointerType>(baseType);
+  auto pointerType = typeCast<PointerType>(baseType);
   if (!pointerType) {
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(),
                               "Cannot dereference non-pointer type " + baseType->toString());
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
@@ -869,8 +879,8 @@ void TypeCheckingListener::exitDereference_expression(cgullParser::Dereference_e
 
 void TypeCheckingListener::exitDereferenceable(cgullParser::DereferenceableContext* ctx) {
   if (ctx->IDENTIFIER()) {
-    auto varSymbol = currentScope->resolve(ctx->IDENTIFIER()->getSymbol()->getText());
-    if (auto variableSymbol = std::dynamic_pointer_cast<VariableSymbol>(varSymbol)) {
+    auto varSymbol = currentScope->resolve(identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms()));
+    if (auto variableSymbol = dynamic_cast<VariableSymbol*>(varSymbol)) {
       setExpressionType(ctx, variableSymbol->dataType);
     } else {
       errorReporter.reportError(ErrorType::UNRESOLVED_REFERENCE, ctx->getStart()->getLine(),
@@ -891,7 +901,7 @@ void TypeCheckingListener::exitArray_expression(cgullParser::Array_expressionCon
   if (!ctx->expression_list() || ctx->expression_list()->expression().empty()) {
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(), "Empty array expression");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
@@ -902,7 +912,7 @@ void TypeCheckingListener::exitArray_expression(cgullParser::Array_expressionCon
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, firstExpr->getStart()->getLine(),
                               firstExpr->getStart()->getCharPositionInLine(),
                               "Cannot determine type for array element");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
@@ -915,18 +925,18 @@ void TypeCheckingListener::exitArray_expression(cgullParser::Array_expressionCon
         if (!nestedType || !areTypesCompatible(nestedType, elementType, nestedExpr, ctx)) {
           errorReporter.reportError(ErrorType::TYPE_MISMATCH, expr->getStart()->getLine(),
                                     expr->getStart()->getCharPositionInLine(), "Nested array type mismatch");
-          setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+          setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
           return;
         }
       } else {
         errorReporter.reportError(ErrorType::TYPE_MISMATCH, expr->getStart()->getLine(),
                                   expr->getStart()->getCharPositionInLine(), "Expected nested array expression");
-        setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+        setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
         return;
       }
     }
     // wrap the element type in an additional array type
-    setExpressionType(ctx, std::make_shared<ArrayType>(elementType));
+    setExpressionType(ctx, types.arrayOf(elementType));
   } else {
     // check if all elements are of the same type
     for (auto expr : ctx->expression_list()->expression()) {
@@ -934,50 +944,50 @@ void TypeCheckingListener::exitArray_expression(cgullParser::Array_expressionCon
       if (!elemType) {
         errorReporter.reportError(ErrorType::TYPE_MISMATCH, expr->getStart()->getLine(),
                                   expr->getStart()->getCharPositionInLine(), "Cannot determine type for array element");
-        setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+        setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
         return;
       }
       if (!areTypesCompatible(elemType, elementType, expr, ctx)) {
         errorReporter.reportError(
             ErrorType::TYPE_MISMATCH, expr->getStart()->getLine(), expr->getStart()->getCharPositionInLine(),
             "Array element type mismatch: expected " + elementType->toString() + ", got " + elemType->toString());
-        setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+        setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
         return;
       }
     }
-    setExpressionType(ctx, std::make_shared<ArrayType>(elementType));
+    setExpressionType(ctx, types.arrayOf(elementType));
   }
 }
 
-std::shared_ptr<Type> TypeCheckingListener::getArrayBaseType(const std::shared_ptr<Type>& type) {
+Type* TypeCheckingListener::getArrayBaseType(Type* type) {
   if (!type)
     return nullptr;
 
-  if (auto arrayType = std::dynamic_pointer_cast<ArrayType>(type)) {
+  if (auto arrayType = typeCast<ArrayType>(type)) {
     return getArrayBaseType(arrayType->getElementType());
   }
   return type;
 }
 
-int TypeCheckingListener::getArrayDimensions(const std::shared_ptr<Type>& type) {
+int TypeCheckingListener::getArrayDimensions(Type* type) {
   if (!type)
     return 0;
 
-  if (auto arrayType = std::dynamic_pointer_cast<ArrayType>(type)) {
+  if (auto arrayType = typeCast<ArrayType>(type)) {
     return 1 + getArrayDimensions(arrayType->getElementType());
   }
   return 0;
 }
 
-bool TypeCheckingListener::checkArrayExpressionType(cgullParser::Array_expressionContext* ctx,
-                                                    const std::shared_ptr<Type>& expectedType, int currentDimension) {
+bool TypeCheckingListener::checkArrayExpressionType(cgullParser::Array_expressionContext* ctx, Type* expectedType,
+                                                    int currentDimension) {
   if (!ctx->expression_list()) {
     return false;
   }
 
   // get the expected element type for this dimension
-  std::shared_ptr<Type> expectedElementType;
-  if (auto arrayType = std::dynamic_pointer_cast<ArrayType>(expectedType)) {
+  Type* expectedElementType = nullptr;
+  if (auto arrayType = typeCast<ArrayType>(expectedType)) {
     expectedElementType = arrayType->getElementType();
   } else {
     expectedElementType = expectedType;
@@ -1044,30 +1054,33 @@ void TypeCheckingListener::exitBase_expression(cgullParser::Base_expressionConte
     auto right = getExpressionType(ctx->base_expression(1));
 
     if (!left || !right) {
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
       return;
     }
 
-    std::string op = ctx->children[1]->getText();
+    // the operator is the terminal between the operands, compared by token type so no text is built
+    size_t op = static_cast<antlr4::tree::TerminalNode*>(ctx->children[1])->getSymbol()->getType();
 
-    if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%" || op == "&" || op == "|" || op == "^" ||
-        op == "<<" || op == ">>") {
+    if (op == cgullParser::PLUS_OP || op == cgullParser::MINUS_OP || op == cgullParser::MULT_OP ||
+        op == cgullParser::DIV_OP || op == cgullParser::MOD_OP || op == cgullParser::BITWISE_AND_OP ||
+        op == cgullParser::BITWISE_OR_OP || op == cgullParser::BITWISE_XOR_OP ||
+        op == cgullParser::BITWISE_LEFT_SHIFT_OP || op == cgullParser::BITWISE_RIGHT_SHIFT_OP) {
 
       // handle string concatenation with the + operator
-      if (op == "+") {
+      if (op == cgullParser::PLUS_OP) {
         // check if either operand is a string
         bool leftCanConvert = false;
         bool rightCanConvert = false;
 
-        auto leftPrimitive = std::dynamic_pointer_cast<PrimitiveType>(left);
-        auto leftUserDefined = std::dynamic_pointer_cast<UserDefinedType>(left);
+        auto leftPrimitive = typeCast<PrimitiveType>(left);
+        auto leftUserDefined = typeCast<UserDefinedType>(left);
         if (leftPrimitive && leftPrimitive->getPrimitiveKind() == PrimitiveType::PrimitiveKind::STRING ||
             leftUserDefined && hasToStringMethod(leftUserDefined->getTypeSymbol()->typeRepresentation)) {
           leftCanConvert = true;
         }
 
-        auto rightPrimitive = std::dynamic_pointer_cast<PrimitiveType>(right);
-        auto rightUserDefined = std::dynamic_pointer_cast<UserDefinedType>(right);
+        auto rightPrimitive = typeCast<PrimitiveType>(right);
+        auto rightUserDefined = typeCast<UserDefinedType>(right);
         if (rightPrimitive && rightPrimitive->getPrimitiveKind() == PrimitiveType::PrimitiveKind::STRING ||
             rightUserDefined && hasToStringMethod(rightUserDefined->getTypeSymbol()->typeRepresentation)) {
           rightCanConvert = true;
@@ -1098,34 +1111,34 @@ void TypeCheckingListener::exitBase_expression(cgullParser::Base_expressionConte
             if (rightUserDefined) {
               expectingStringConversion.insert(ctx->base_expression(1));
             }
-            setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::STRING));
+            setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::STRING));
             return;
           }
         }
       }
 
       // handle numeric operations
-      bool leftIsNumeric = std::dynamic_pointer_cast<PrimitiveType>(left) != nullptr &&
-                           std::dynamic_pointer_cast<PrimitiveType>(left)->isNumeric();
-      bool rightIsNumeric = std::dynamic_pointer_cast<PrimitiveType>(right) != nullptr &&
-                            std::dynamic_pointer_cast<PrimitiveType>(right)->isNumeric();
+      bool leftIsNumeric = typeCast<PrimitiveType>(left) != nullptr && typeCast<PrimitiveType>(left)->isNumeric();
+      bool rightIsNumeric = typeCast<PrimitiveType>(right) != nullptr && typeCast<PrimitiveType>(right)->isNumeric();
 
       if (!leftIsNumeric || !rightIsNumeric) {
         errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                                   ctx->getStart()->getCharPositionInLine(),
-                                  "Operator '" + op + "' requires numeric operands");
-        setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::INT));
+                                  "Operator '" + ctx->children[1]->getText() + "' requires numeric operands");
+        setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::INT));
         return;
       }
 
       setExpressionType(ctx, left);
-    } else if (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=") {
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::BOOLEAN));
-    } else if (op == "&&" || op == "||") {
-      auto leftBool = std::dynamic_pointer_cast<PrimitiveType>(left);
-      auto leftPointer = std::dynamic_pointer_cast<PointerType>(left);
-      auto rightBool = std::dynamic_pointer_cast<PrimitiveType>(right);
-      auto rightPointer = std::dynamic_pointer_cast<PointerType>(right);
+    } else if (op == cgullParser::EQUAL_OP || op == cgullParser::NOT_EQUAL_OP || op == cgullParser::LESS_OP ||
+               op == cgullParser::GREATER_OP || op == cgullParser::LESS_EQUAL_OP ||
+               op == cgullParser::GREATER_EQUAL_OP) {
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::BOOLEAN));
+    } else if (op == cgullParser::AND_OP || op == cgullParser::OR_OP) {
+      auto leftBool = typeCast<PrimitiveType>(left);
+      auto leftPointer = typeCast<PointerType>(left);
+      auto rightBool = typeCast<PrimitiveType>(right);
+      auto rightPointer = typeCast<PointerType>(right);
 
       // allow pointers in logical operations (treating them as boolean)
       bool leftIsValid =
@@ -1136,15 +1149,16 @@ void TypeCheckingListener::exitBase_expression(cgullParser::Base_expressionConte
       if (!leftIsValid || !rightIsValid) {
         errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                                   ctx->getStart()->getCharPositionInLine(),
-                                  "Logical operator '" + op + "' requires boolean operands or pointers");
+                                  "Logical operator '" + ctx->children[1]->getText() +
+                                      "' requires boolean operands or pointers");
       }
 
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::BOOLEAN));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::BOOLEAN));
     }
   } else if (ctx->if_expression()) {
     setExpressionType(ctx, getExpressionType(ctx->if_expression()));
   } else {
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
   }
 }
 
@@ -1152,7 +1166,7 @@ void TypeCheckingListener::exitExpression(cgullParser::ExpressionContext* ctx) {
   if (ctx->base_expression()) {
     setExpressionType(ctx, getExpressionType(ctx->base_expression()));
   } else {
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
   }
 }
 
@@ -1166,28 +1180,26 @@ void TypeCheckingListener::exitAllocate_expression(cgullParser::Allocate_express
 
 void TypeCheckingListener::exitAllocate_primitive(cgullParser::Allocate_primitiveContext* ctx) {
   if (ctx->primitive_type()) {
-    std::string typeName = ctx->primitive_type()->getText();
-    auto baseType = resolvePrimitiveType(typeName);
+    auto baseType = resolvePrimitiveType(ctx->primitive_type());
     if (baseType) {
-      setExpressionType(ctx, std::make_shared<PointerType>(baseType));
+      setExpressionType(ctx, types.pointerTo(baseType));
     } else {
       errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                                 ctx->getStart()->getCharPositionInLine(), "Invalid primitive type in allocation");
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     }
   }
 }
 
 void TypeCheckingListener::exitAllocate_array(cgullParser::Allocate_arrayContext* ctx) {
   // get the base type of the array (without array dimensions)
-  std::shared_ptr<Type> baseType = nullptr;
+  Type* baseType = nullptr;
   if (ctx->type()->primitive_type()) {
-    std::string primitiveTypeName = ctx->type()->primitive_type()->getText();
-    baseType = resolvePrimitiveType(primitiveTypeName);
+    baseType = resolvePrimitiveType(ctx->type()->primitive_type());
   } else if (ctx->type()->user_defined_type()) {
-    std::string typeName = ctx->type()->user_defined_type()->getText();
-    auto resolvedTypeSymbol = currentScope->resolve(typeName);
-    if (auto typeSymbol = std::dynamic_pointer_cast<TypeSymbol>(resolvedTypeSymbol)) {
+    auto resolvedTypeSymbol =
+        currentScope->resolve(identifierAtom(ctx->type()->user_defined_type()->IDENTIFIER(), currentScope->getAtoms()));
+    if (auto typeSymbol = dynamic_cast<TypeSymbol*>(resolvedTypeSymbol)) {
       baseType = typeSymbol->typeRepresentation;
     }
   }
@@ -1195,14 +1207,12 @@ void TypeCheckingListener::exitAllocate_array(cgullParser::Allocate_arrayContext
   if (!baseType) {
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(), "Invalid type in array allocation");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
-  for (auto child : ctx->type()->children) {
-    if (child->getText() == "*") {
-      baseType = std::make_shared<PointerType>(baseType);
-    }
+  if (hasPointerSuffix(ctx->type())) {
+    baseType = types.pointerTo(baseType);
   }
 
   // add array dimensions based on the number of expressions
@@ -1210,14 +1220,14 @@ void TypeCheckingListener::exitAllocate_array(cgullParser::Allocate_arrayContext
     // ensure integer size for each dimension
     for (auto expr : ctx->expression()) {
       auto size = getExpressionType(expr);
-      if (!size || !std::dynamic_pointer_cast<PrimitiveType>(size)->isInteger()) {
+      if (!size || !typeCast<PrimitiveType>(size)->isInteger()) {
         errorReporter.reportError(ErrorType::TYPE_MISMATCH, expr->getStart()->getLine(),
                                   expr->getStart()->getCharPositionInLine(), "Array size must be an integer");
-        setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+        setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
         return;
       }
       // add an array dimension for each size expression
-      baseType = std::make_shared<ArrayType>(baseType);
+      baseType = types.arrayOf(baseType);
     }
   } else if (ctx->array_expression()) {
     // for array expressions, we need to determine the dimensions from the expression
@@ -1225,7 +1235,7 @@ void TypeCheckingListener::exitAllocate_array(cgullParser::Allocate_arrayContext
     if (!arrayType) {
       errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                                 ctx->getStart()->getCharPositionInLine(), "Cannot determine type of array expression");
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
       return;
     }
     baseType = arrayType;
@@ -1242,7 +1252,7 @@ void TypeCheckingListener::exitUnary_expression(cgullParser::Unary_expressionCon
 
   // handle +, -, !, ++, --, and ~ operator cases
   if (!ctx->expression()) {
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
@@ -1251,32 +1261,32 @@ void TypeCheckingListener::exitUnary_expression(cgullParser::Unary_expressionCon
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(),
                               "Cannot determine type of operand in unary expression");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
   // handle unary +, -
   if (ctx->PLUS_OP() || ctx->MINUS_OP()) {
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(operandType);
+    auto primitiveType = typeCast<PrimitiveType>(operandType);
     if (!primitiveType || !primitiveType->isNumeric() ||
         primitiveType->getPrimitiveKind() == PrimitiveType::PrimitiveKind::BOOLEAN) {
       errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                                 ctx->getStart()->getCharPositionInLine(),
                                 "Unary operator " + std::string(1, ctx->getText()[0]) +
                                     " requires numeric non-boolean operand, got " + operandType->toString());
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::INT));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::INT));
     } else {
       setExpressionType(ctx, operandType);
     }
   }
   // handle logical NOT (!)
   else if (ctx->NOT_OP()) {
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(operandType);
-    auto pointerType = std::dynamic_pointer_cast<PointerType>(operandType);
+    auto primitiveType = typeCast<PrimitiveType>(operandType);
+    auto pointerType = typeCast<PointerType>(operandType);
 
     // allow logical NOT on pointers (for null checks)
     if (pointerType) {
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::BOOLEAN));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::BOOLEAN));
       return;
     }
 
@@ -1285,23 +1295,23 @@ void TypeCheckingListener::exitUnary_expression(cgullParser::Unary_expressionCon
                                 ctx->getStart()->getCharPositionInLine(),
                                 "Logical NOT operator requires boolean operand, got " + operandType->toString());
     }
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::BOOLEAN));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::BOOLEAN));
   }
   // handle bitwise NOT (~)
   else if (ctx->BITWISE_NOT_OP()) {
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(operandType);
+    auto primitiveType = typeCast<PrimitiveType>(operandType);
     if (!primitiveType || !primitiveType->isInteger()) {
       errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                                 ctx->getStart()->getCharPositionInLine(),
                                 "Bitwise NOT operator requires integer operand, got " + operandType->toString());
-      setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::INT));
+      setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::INT));
     } else {
       setExpressionType(ctx, operandType);
     }
   }
   // handle increment/decrement operators (++, --)
   else if (ctx->INCREMENT_OP() || ctx->DECREMENT_OP()) {
-    auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(operandType);
+    auto primitiveType = typeCast<PrimitiveType>(operandType);
     if (!primitiveType || !primitiveType->isNumeric() ||
         primitiveType->getPrimitiveKind() == PrimitiveType::PrimitiveKind::BOOLEAN) {
       errorReporter.reportError(
@@ -1313,13 +1323,12 @@ void TypeCheckingListener::exitUnary_expression(cgullParser::Unary_expressionCon
 }
 
 void TypeCheckingListener::exitPostfix_expression(cgullParser::Postfix_expressionContext* ctx) {
-  std::shared_ptr<Type> baseType = nullptr;
+  Type* baseType = nullptr;
 
   // determine the base type of the expression
   if (ctx->IDENTIFIER()) {
-    std::string identifier = ctx->IDENTIFIER()->getSymbol()->getText();
-    auto varSymbol = currentScope->resolve(identifier);
-    if (auto variableSymbol = std::dynamic_pointer_cast<VariableSymbol>(varSymbol)) {
+    auto varSymbol = currentScope->resolve(identifierAtom(ctx->IDENTIFIER(), currentScope->getAtoms()));
+    if (auto variableSymbol = dynamic_cast<VariableSymbol*>(varSymbol)) {
       baseType = variableSymbol->dataType;
     }
   } else if (ctx->function_call()) {
@@ -1334,12 +1343,12 @@ void TypeCheckingListener::exitPostfix_expression(cgullParser::Postfix_expressio
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(),
                               "Cannot determine base type for postfix operation");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
   // check if the type is numeric for increment/decrement operations
-  auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(baseType);
+  auto primitiveType = typeCast<PrimitiveType>(baseType);
   if (!primitiveType || !primitiveType->isNumeric()) {
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(),
@@ -1353,7 +1362,7 @@ void TypeCheckingListener::exitUnary_statement(cgullParser::Unary_statementConte
   if (ctx->unary_expression()) {
     setExpressionType(ctx, getExpressionType(ctx->unary_expression()));
   } else {
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
   }
 }
 
@@ -1363,13 +1372,13 @@ void TypeCheckingListener::exitIf_expression(cgullParser::If_expressionContext*
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->base_expression(0)->getStart()->getLine(),
                               ctx->base_expression(0)->getStart()->getCharPositionInLine(),
                               "Cannot determine type of condition in if expression");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
   // verify condition is boolean or a pointer (which can be used in boolean contexts)
-  auto primCondition = std::dynamic_pointer_cast<PrimitiveType>(conditionType);
-  auto pointerType = std::dynamic_pointer_cast<PointerType>(conditionType);
+  auto primCondition = typeCast<PrimitiveType>(conditionType);
+  auto pointerType = typeCast<PointerType>(conditionType);
 
   // allow pointers in if expressions (non-null is true, null is false)
   if (!pointerType && (!primCondition || primCondition->getPrimitiveKind() != PrimitiveType::PrimitiveKind::BOOLEAN)) {
@@ -1385,7 +1394,7 @@ void TypeCheckingListener::exitIf_expression(cgullParser::If_expressionContext*
     errorReporter.reportError(ErrorType::TYPE_MISMATCH, ctx->getStart()->getLine(),
                               ctx->getStart()->getCharPositionInLine(),
                               "Cannot determine types in branches of if expression");
-    setExpressionType(ctx, std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+    setExpressionType(ctx, TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
     return;
   }
 
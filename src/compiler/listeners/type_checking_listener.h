@@ -2,59 +2,66 @@
 #define TYPE_CHECKING_LISTENER_H
 
 #include "../errors/error_reporter.h"
+#include "../node_table.h"
 #include "../symbols/symbol.h"
 #include "../symbols/type.h"
+#include "../symbols/type_table.h"
 #include <cgullBaseListener.h>
 #include <unordered_map>
 
 class TypeCheckingListener : public cgullBaseListener {
 public:
-  TypeCheckingListener(ErrorReporter& errorReporter,
-                       const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& scopes,
-                       std::shared_ptr<Scope> globalScope);
+  // nodeScopes has the innermost scope of every node, see SymbolCollectionListener::takeNodeScopes
+  // a listener checking a single function is given the id of its function_definition, its tables start there
+  TypeCheckingListener(ErrorReporter& errorReporter, const NodeTable<Scope*>& nodeScopes, TypeTable& types,
+                       Scope* globalScope, size_t firstNodeId = 0);
+
+  // takes over the results of a listener that checked one function
+  void merge(const TypeCheckingListener& functionChecker);
 
   // evaluate the end result of an expression
-  std::shared_ptr<Type> getExpressionType(antlr4::ParserRuleContext* ctx) const;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>> getExpressionTypes() const;
-  std::unordered_set<antlr4::ParserRuleContext*> getExpectingStringConversion() const;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>> getResolvedMethodSymbols() const;
+  Type* getExpressionType(antlr4::ParserRuleContext* ctx) const;
+  // the tables are moved out once checking is done, so each can only be taken once
+  NodeTable<Type*> takeExpressionTypes();
+  NodeSet takeExpectingStringConversion();
+  NodeTable<FunctionSymbol*> takeResolvedMethodSymbols();
 
-  static std::shared_ptr<Type> resolvePrimitiveType(const std::string& typeName);
+  static Type* resolvePrimitiveType(cgullParser::Primitive_typeContext* primitiveCtx);
 
-  std::shared_ptr<Type> getArrayBaseType(const std::shared_ptr<Type>& type);
-  int getArrayDimensions(const std::shared_ptr<Type>& type);
-  bool checkArrayExpressionType(cgullParser::Array_expressionContext* ctx, const std::shared_ptr<Type>& expectedType,
-                                int currentDimension);
+  Type* getArrayBaseType(Type* type);
+  int getArrayDimensions(Type* type);
+  bool checkArrayExpressionType(cgullParser::Array_expressionContext* ctx, Type* expectedType, int currentDimension);
 
 private:
   ErrorReporter& errorReporter;
-  std::shared_ptr<Scope> currentScope;
-  std::shared_ptr<Scope> globalScope;
-  const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& scopes;
+  const NodeTable<Scope*>& nodeScopes;
+  TypeTable& types;
+  Scope* globalScope = nullptr;
+  Scope* currentScope = nullptr;
 
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>> expressionTypes;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>> resolvedMethodSymbols;
-  std::unordered_set<antlr4::ParserRuleContext*> expectingStringConversion;
+  NodeTable<Type*> expressionTypes;
+  NodeTable<FunctionSymbol*> resolvedMethodSymbols;
+  NodeSet expectingStringConversion;
 
   // helper methods
-  std::shared_ptr<Type> resolveType(cgullParser::TypeContext* typeCtx);
-  bool areTypesCompatible(const std::shared_ptr<Type>& sourceType, const std::shared_ptr<Type>& targetType,
-                          antlr4::ParserRuleContext* sourceCtx = nullptr,
+  Type* resolveType(cgullParser::TypeContext* typeCtx);
+  bool areTypesCompatible(Type* sourceType, Type* targetType, antlr4::ParserRuleContext* sourceCtx = nullptr,
                           antlr4::ParserRuleContext* targetCtx = nullptr);
-  std::shared_ptr<Type> getFieldType(const std::shared_ptr<Type>& baseType, const std::string& fieldName);
-  std::shared_ptr<Type> getElementType(const std::shared_ptr<Type>& arrayType);
-  void setExpressionType(antlr4::ParserRuleContext* ctx, std::shared_ptr<Type> type);
+  Type* getFieldType(Type* baseType, Atom fieldName);
+  Type* getElementType(Type* arrayType);
+  void setExpressionType(antlr4::ParserRuleContext* ctx, Type* type);
 
-  bool hasToStringMethod(const std::shared_ptr<Type>& type);
-  bool canConvertToString(const std::shared_ptr<Type>& type);
+  bool hasToStringMethod(Type* type);
+  bool canConvertToString(Type* type);
 
-  std::vector<std::shared_ptr<Type>> currentFunctionReturnTypes;
+  std::vector<Type*> currentFunctionReturnTypes;
 
   // store temporary context for field access
-  std::unordered_map<antlr4::ParserRuleContext*, std::stack<std::shared_ptr<Type>>> fieldAccessContexts;
-  std::unordered_map<antlr4::ParserRuleContext*, bool> isDereferenceContexts;
+  NodeTable<std::stack<Type*>> fieldAccessContexts;
+  NodeTable<bool> isDereferenceContexts;
 
   void enterEveryRule(antlr4::ParserRuleContext* ctx) override;
+  void exitEveryRule(antlr4::ParserRuleContext* ctx) override;
 
   void exitVariable(cgullParser::VariableContext* ctx) override;
   void exitLiteral(cgullParser::LiteralContext* ctx) override;
@@ -93,18 +100,15 @@ private:
   void exitReturn_statement(cgullParser::Return_statementContext* ctx) override;
   ;
 
-  std::shared_ptr<Type> checkAssignmentCompatibility(std::shared_ptr<Type> leftType, std::shared_ptr<Type> rightType,
-                                                     antlr4::ParserRuleContext* ctx);
+  Type* checkAssignmentCompatibility(Type* leftType, Type* rightType, antlr4::ParserRuleContext* ctx);
 
-  std::vector<std::shared_ptr<Type>> collectArgumentTypes(cgullParser::Expression_listContext* exprList);
+  std::vector<Type*> collectArgumentTypes(cgullParser::Expression_listContext* exprList);
 
-  void checkArgumentCompatibility(const std::vector<std::shared_ptr<Type>>& argumentTypes,
-                                  const std::vector<std::shared_ptr<Type>>& parameterTypes,
+  void checkArgumentCompatibility(const std::vector<Type*>& argumentTypes, const std::vector<Type*>& parameterTypes,
                                   cgullParser::Expression_listContext* exprList, const std::string& functionName,
                                   int line, int pos);
 
-  void setFunctionCallReturnType(cgullParser::Function_callContext* ctx,
-                                 const std::vector<std::shared_ptr<Type>>& returnTypes);
+  void setFunctionCallReturnType(cgullParser::Function_callContext* ctx, const std::vector<Type*>& returnTypes);
 };
 
 #endif // TYPE_CHECKING_LISTENER_H
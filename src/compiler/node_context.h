@@ -0,0 +1,18 @@
+#ifndef NODE_CONTEXT_H
+#define NODE_CONTEXT_H
+
+#include <antlr4-runtime.h>
+#include <cstddef>
+
+// base class of every cgullParser context (the grammar's contextSuperClass)
+// nodeId is a dense number given to each node once after parsing, see NodeIndex, so analysis results can live in
+// vectors indexed by it instead of hash maps keyed by the context pointer
+class NodeContext : public antlr4::ParserRuleContext {
+public:
+  using antlr4::ParserRuleContext::ParserRuleContext;
+
+  // 0 until the tree is numbered, 0 is also the id used for "no node" (the global scope's entry)
+  size_t nodeId = 0;
+};
+
+#endif // NODE_CONTEXT_H
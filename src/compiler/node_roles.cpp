@@ -0,0 +1,99 @@
+#include "node_roles.h"
+#include <cgullParser.h>
+
+namespace {
+
+void assign(NodeTable<NodeRole>& roles, uint32_t child, NodeRole::Kind kind, size_t position = 0) {
+  if (child != 0) {
+    NodeRole& role = roles.atId(child);
+    role.kind = kind;
+    role.position = static_cast<uint32_t>(position);
+  }
+}
+
+// gives the children of id of the given rule kind, in order, the role kind with their position among them
+void assignAll(NodeTable<NodeRole>& roles, const FlatAst& ast, size_t id, size_t rule, NodeRole::Kind kind) {
+  size_t position = 0;
+  for (uint32_t child : ast.children(id)) {
+    if (ast.kind(child) == rule) {
+      assign(roles, child, kind, position++);
+    }
+  }
+}
+
+} // namespace
+
+NodeTable<NodeRole> assignNodeRoles(const FlatAst& ast) {
+  using Kind = NodeRole::Kind;
+  NodeTable<NodeRole> roles;
+  for (size_t id = 1; id < ast.size(); id++) {
+    const FlatAst::Node& node = ast.node(id);
+    // the parent assigned the kind already, if the node has one
+    NodeRole& role = roles.atId(id);
+    if (node.parent != 0) {
+      const NodeRole* parentRole = roles.findId(node.parent);
+      role.inAssignment = (parentRole != nullptr && parentRole->inAssignment) ||
+                          ast.kind(node.parent) == cgullParser::RuleAssignment_statement;
+    }
+
+    switch (node.kind) {
+    case cgullParser::RuleIf_statement:
+      assignAll(roles, ast, id, cgullParser::RuleExpression, Kind::IF_CONDITION);
+      assignAll(roles, ast, id, cgullParser::RuleBranch_block, Kind::IF_BRANCH);
+      break;
+    case cgullParser::RuleWhile_statement:
+      assign(roles, ast.childOfKind(id, cgullParser::RuleExpression), Kind::WHILE_CONDITION);
+      assign(roles, ast.childOfKind(id, cgullParser::RuleBranch_block), Kind::WHILE_BODY);
+      break;
+    case cgullParser::RuleUntil_statement:
+      assign(roles, ast.childOfKind(id, cgullParser::RuleExpression), Kind::UNTIL_CONDITION);
+      assign(roles, ast.childOfKind(id, cgullParser::RuleBranch_block), Kind::UNTIL_BODY);
+      break;
+    case cgullParser::RuleFor_statement:
+      assign(roles, ast.childOfKind(id, cgullParser::RuleExpression, 0), Kind::FOR_CONDITION);
+      assign(roles, ast.childOfKind(id, cgullParser::RuleExpression, 1), Kind::FOR_UPDATE);
+      assign(roles, ast.childOfKind(id, cgullParser::RuleBranch_block), Kind::FOR_BODY);
+      break;
+    case cgullParser::RuleInfinite_loop_statement:
+      assign(roles, ast.childOfKind(id, cgullParser::RuleBranch_block), Kind::INFINITE_LOOP_BODY);
+      break;
+    case cgullParser::RuleIf_expression:
+      assignAll(roles, ast, id, cgullParser::RuleBase_expression, Kind::IF_EXPRESSION_PART);
+      break;
+    case cgullParser::RuleBase_expression:
+      // a binary base expression starts with its left operand, so its first token is the operator
+      if (node.firstToken == cgullParser::AND_OP || node.firstToken == cgullParser::OR_OP) {
+        assignAll(roles, ast, id, cgullParser::RuleBase_expression, Kind::LOGICAL_OPERAND);
+      }
+      break;
+    case cgullParser::RuleArray_expression: {
+      uint32_t list = ast.childOfKind(id, cgullParser::RuleExpression_list);
+      if (list != 0) {
+        assignAll(roles, ast, list, cgullParser::RuleExpression, Kind::ARRAY_ELEMENT);
+      }
+      break;
+    }
+    case cgullParser::RuleIndex_expression: {
+      assignAll(roles, ast, id, cgullParser::RuleExpression, Kind::INDEX);
+      uint32_t last = 0;
+      for (uint32_t child : ast.children(id)) {
+        if (ast.kind(child) == cgullParser::RuleExpression) {
+          last = child;
+        }
+      }
+      if (last != 0) {
+        roles.atId(last).kind = Kind::LAST_INDEX;
+      }
+      break;
+    }
+    case cgullParser::RuleAssignment_statement:
+      assign(roles, ast.childOfKind(id, cgullParser::RuleDereference_expression), Kind::ASSIGNMENT_TARGET);
+      assign(roles, ast.childOfKind(id, cgullParser::RuleIndex_expression), Kind::ASSIGNMENT_TARGET);
+      assign(roles, ast.childOfKind(id, cgullParser::RuleVariable), Kind::ASSIGNMENT_TARGET);
+      break;
+    default:
+      break;
+    }
+  }
+  return roles;
+}
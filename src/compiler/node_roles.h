@@ -0,0 +1,53 @@
+#ifndef NODE_ROLES_H
+#define NODE_ROLES_H
+
+#include "flat_ast.h"
+#include "node_table.h"
+#include <cstdint>
+
+// the part a node plays in its parent, for the positions code generation and the analysis passes branch on, so they
+// read it from a table instead of casting the parent to every statement type that could have it
+struct NodeRole {
+  enum class Kind : uint8_t {
+    NONE,
+    // position 0 for the if, i for the i-th elseif
+    IF_CONDITION,
+    // position 0 for the if, i for the i-th elseif, the else comes last
+    IF_BRANCH,
+    WHILE_CONDITION,
+    WHILE_BODY,
+    UNTIL_CONDITION,
+    UNTIL_BODY,
+    FOR_CONDITION,
+    FOR_UPDATE,
+    FOR_BODY,
+    INFINITE_LOOP_BODY,
+    // position 0 for the condition, 1 for the then and 2 for the else expression
+    IF_EXPRESSION_PART,
+    // position 0 for the left and 1 for the right operand of && or ||
+    LOGICAL_OPERAND,
+    // an expression of an array literal's list, position is its index in the array
+    ARRAY_ELEMENT,
+    // one of the [...] of an index expression but the last one, position counts them from 0
+    INDEX,
+    LAST_INDEX,
+    // the variable, index expression or dereference assigned to by an assignment statement
+    ASSIGNMENT_TARGET,
+  };
+
+  Kind kind = Kind::NONE;
+  // somewhere below an assignment statement
+  bool inAssignment = false;
+  uint32_t position = 0;
+
+  bool isLoopBody() const {
+    return kind == Kind::WHILE_BODY || kind == Kind::UNTIL_BODY || kind == Kind::FOR_BODY ||
+           kind == Kind::INFINITE_LOOP_BODY;
+  }
+};
+
+// the role of every node of the lowered tree, in one pass over the ids: each node gives its children their roles, and
+// ids are preorder, so a node's parent is done before it
+NodeTable<NodeRole> assignNodeRoles(const FlatAst& ast);
+
+#endif // NODE_ROLES_H
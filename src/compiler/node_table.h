@@ -0,0 +1,172 @@
+#ifndef NODE_TABLE_H
+#define NODE_TABLE_H
+
+#include "node_context.h"
+#include <vector>
+
+// gives every rule node of a parse tree a dense id, 1 and up in preorder, and maps ids back to nodes
+// id 0 stands for no node, so a null context has a slot of its own in every table
+class NodeIndex {
+public:
+  NodeIndex() = default;
+  explicit NodeIndex(antlr4::ParserRuleContext* root) { number(root); }
+
+  // numbers root and everything below it, replacing any earlier numbering
+  void number(antlr4::ParserRuleContext* root) {
+    nodes.assign(1, nullptr);
+    if (root == nullptr) {
+      return;
+    }
+    // explicit stack, deeply nested expressions would overflow a recursive walk
+    std::vector<antlr4::tree::ParseTree*> pending{root};
+    while (!pending.empty()) {
+      auto* ctx = dynamic_cast<NodeContext*>(pending.back());
+      pending.pop_back();
+      if (ctx == nullptr) {
+        continue;
+      }
+      ctx->nodeId = nodes.size();
+      nodes.push_back(ctx);
+      for (auto child = ctx->children.rbegin(); child != ctx->children.rend(); ++child) {
+        pending.push_back(*child);
+      }
+    }
+  }
+
+  static size_t idOf(const antlr4::ParserRuleContext* ctx) {
+    return ctx == nullptr ? 0 : static_cast<const NodeContext*>(ctx)->nodeId;
+  }
+
+  // one more than the largest id
+  size_t size() const { return nodes.size(); }
+  antlr4::ParserRuleContext* getNode(size_t id) const { return nodes[id]; }
+
+private:
+  std::vector<antlr4::ParserRuleContext*> nodes{nullptr};
+};
+
+// a value per parse tree node, in a vector indexed by node id
+// grows on insertion, so it doesn't need to know the tree size up front
+//
+// a table for one subtree can start at the subtree root's id (ids are preorder, so the subtree's ids follow it), and
+// takes no space for the nodes before it. only nodes of the subtree can be added to such a table
+template <typename T> class NodeTable {
+public:
+  NodeTable() = default;
+  explicit NodeTable(size_t firstId) : firstId(firstId) {}
+
+  T& operator[](const antlr4::ParserRuleContext* ctx) { return atId(NodeIndex::idOf(ctx)); }
+
+  bool contains(const antlr4::ParserRuleContext* ctx) const { return containsId(NodeIndex::idOf(ctx)); }
+
+  // null if there's no value for ctx
+  const T* find(const antlr4::ParserRuleContext* ctx) const { return findId(NodeIndex::idOf(ctx)); }
+  T* find(const antlr4::ParserRuleContext* ctx) { return findId(NodeIndex::idOf(ctx)); }
+
+  // the same by node id, for passes that work on ids without the contexts (like the ones over a FlatAst)
+  T& atId(size_t id) {
+    size_t index = id - firstId;
+    if (index >= slots.size()) {
+      slots.resize(index + 1);
+    }
+    slots[index].present = true;
+    return slots[index].value;
+  }
+  bool containsId(size_t id) const {
+    return id >= firstId && id - firstId < slots.size() && slots[id - firstId].present;
+  }
+  const T* findId(size_t id) const { return containsId(id) ? &slots[id - firstId].value : nullptr; }
+  T* findId(size_t id) { return containsId(id) ? &slots[id - firstId].value : nullptr; }
+  T getId(size_t id) const {
+    const T* value = findId(id);
+    return value == nullptr ? T() : *value;
+  }
+
+  // the value for ctx, or a default one if there is none
+  T get(const antlr4::ParserRuleContext* ctx) const {
+    const T* value = find(ctx);
+    return value == nullptr ? T() : *value;
+  }
+
+  void erase(const antlr4::ParserRuleContext* ctx) {
+    if (contains(ctx)) {
+      slots[NodeIndex::idOf(ctx) - firstId] = Slot();
+    }
+  }
+
+  // calls f(id, value) for every node with a value, in id order
+  template <typename F> void forEach(F f) const {
+    for (size_t index = 0; index < slots.size(); index++) {
+      if (slots[index].present) {
+        f(firstId + index, slots[index].value);
+      }
+    }
+  }
+
+  // copies in every value of other, which replace the ones this table had for the same nodes
+  void merge(const NodeTable& other) {
+    if (other.slots.empty()) {
+      return;
+    }
+    size_t end = other.firstId + other.slots.size() - firstId;
+    if (end > slots.size()) {
+      slots.resize(end);
+    }
+    for (size_t index = 0; index < other.slots.size(); index++) {
+      if (other.slots[index].present) {
+        slots[other.firstId + index - firstId] = other.slots[index];
+      }
+    }
+  }
+
+private:
+  // value and flag side by side, which also keeps NodeTable<bool> away from std::vector<bool>
+  struct Slot {
+    T value = T();
+    bool present = false;
+  };
+  size_t firstId = 0;
+  std::vector<Slot> slots;
+};
+
+// a set of parse tree nodes, one bit per node id, can start at a subtree's first id like NodeTable
+class NodeSet {
+public:
+  NodeSet() = default;
+  explicit NodeSet(size_t firstId) : firstId(firstId) {}
+
+  void insert(const antlr4::ParserRuleContext* ctx) {
+    size_t index = NodeIndex::idOf(ctx) - firstId;
+    if (index >= bits.size()) {
+      bits.resize(index + 1);
+    }
+    bits[index] = true;
+  }
+
+  bool contains(const antlr4::ParserRuleContext* ctx) const {
+    size_t id = NodeIndex::idOf(ctx);
+    return id >= firstId && id - firstId < bits.size() && bits[id - firstId];
+  }
+
+  // adds every node of other
+  void merge(const NodeSet& other) {
+    if (other.bits.empty()) {
+      return;
+    }
+    size_t end = other.firstId + other.bits.size() - firstId;
+    if (end > bits.size()) {
+      bits.resize(end);
+    }
+    for (size_t index = 0; index < other.bits.size(); index++) {
+      if (other.bits[index]) {
+        bits[other.firstId + index - firstId] = true;
+      }
+    }
+  }
+
+private:
+  size_t firstId = 0;
+  std::vector<bool> bits;
+};
+
+#endif // NODE_TABLE_H
@@ -0,0 +1,246 @@
+#include "parallel_parser.h"
+#include "input/native_lexer.h"
+#include <algorithm>
+#include <atomic>
+#include <cgullLexer.h>
+#include <thread>
+
+namespace {
+
+// below this many tokens per chunk, starting the threads and parsers costs more than it saves
+constexpr size_t MIN_CHUNK_TOKENS = 4096;
+// more chunks than threads, so one slow chunk doesn't leave the other threads idle
+constexpr size_t CHUNKS_PER_THREAD = 2;
+
+} // namespace
+
+// a window [begin, end) of an already filled token stream, ending in EOF
+// token indexes stay the ones of the whole stream so the tree's source intervals mean the same thing
+class ParallelParser::TokenRangeStream : public antlr4::TokenStream {
+public:
+  TokenRangeStream(antlr4::TokenStream& source, const std::vector<antlr4::Token*>& tokenList, size_t begin,
+                   size_t end)
+      : source(source), tokenList(tokenList), begin(begin), end(end), position(begin) {
+    antlr4::Token* next = tokenList[end];
+    if (next->getType() == antlr4::Token::EOF) {
+      eof = next;
+      return;
+    }
+    // a stand in EOF where the next chunk starts
+    ownedEof = std::make_unique<antlr4::CommonToken>(
+        std::make_pair(next->getTokenSource(), next->getInputStream()), antlr4::Token::EOF,
+        antlr4::Token::DEFAULT_CHANNEL, next->getStartIndex(), next->getStartIndex() - 1);
+    ownedEof->setLine(next->getLine());
+    ownedEof->setCharPositionInLine(next->getCharPositionInLine());
+    ownedEof->setTokenIndex(end);
+    eof = ownedEof.get();
+  }
+
+  antlr4::Token* get(size_t index) const override { return index >= end ? eof : tokenList[index]; }
+
+  antlr4::Token* LT(ssize_t k) override {
+    if (k == 0) {
+      return nullptr;
+    }
+    if (k < 0) {
+      return static_cast<size_t>(-k) > position - begin ? nullptr : tokenList[position - static_cast<size_t>(-k)];
+    }
+    return get(position + k - 1);
+  }
+
+  size_t LA(ssize_t i) override {
+    antlr4::Token* token = LT(i);
+    return token == nullptr ? antlr4::Token::INVALID_TYPE : token->getType();
+  }
+
+  void consume() override {
+    if (position >= end) {
+      throw antlr4::IllegalStateException("cannot consume EOF");
+    }
+    position++;
+  }
+
+  ssize_t mark() override { return 0; }
+  void release(ssize_t /*marker*/) override {}
+  size_t index() override { return position; }
+  void seek(size_t index) override { position = std::clamp(index, begin, end); }
+  size_t size() override { return end + 1; }
+  std::string getSourceName() const override { return source.getSourceName(); }
+  antlr4::TokenSource* getTokenSource() const override { return source.getTokenSource(); }
+
+  std::string getText(const antlr4::misc::Interval& interval) override {
+    if (interval.a < 0 || interval.b < 0) {
+      return "";
+    }
+    std::string text;
+    size_t stop = std::min(static_cast<size_t>(interval.b), end - 1);
+    for (size_t i = std::max(static_cast<size_t>(interval.a), begin); i <= stop && i < end; i++) {
+      text += tokenList[i]->getText();
+    }
+    return text;
+  }
+
+  std::string getText() override { return getText(antlr4::misc::Interval(begin, end - 1)); }
+  std::string getText(antlr4::RuleContext* ctx) override { return getText(ctx->getSourceInterval()); }
+
+  std::string getText(antlr4::Token* start, antlr4::Token* stop) override {
+    if (start == nullptr || stop == nullptr) {
+      return "";
+    }
+    return getText(antlr4::misc::Interval(start->getTokenIndex(), stop->getTokenIndex()));
+  }
+
+private:
+  antlr4::TokenStream& source;
+  const std::vector<antlr4::Token*>& tokenList;
+  size_t begin;
+  size_t end;
+  size_t position;
+  antlr4::Token* eof = nullptr;
+  std::unique_ptr<antlr4::CommonToken> ownedEof;
+};
+
+struct ParallelParser::Chunk {
+  TokenRangeStream stream;
+  cgullParser parser;
+  cgullParser::ProgramContext* tree = nullptr;
+
+  Chunk(antlr4::TokenStream& source, const std::vector<antlr4::Token*>& tokenList, size_t begin, size_t end)
+      : stream(source, tokenList, begin, end), parser(&stream) {}
+};
+
+ParallelParser::ParallelParser(antlr4::CommonTokenStream& tokens, unsigned threads)
+    : tokens(tokens), tokenList(tokens.getTokens()), threads(threads) {
+  if (this->threads == 0) {
+    this->threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  split();
+}
+
+ParallelParser::~ParallelParser() = default;
+
+void ParallelParser::split() {
+  // every token up to EOF is on the default channel, the grammar has no hidden tokens
+  if (threads < 2 || tokenList.size() <= 2 * MIN_CHUNK_TOKENS) {
+    return;
+  }
+  size_t eofIndex = tokenList.size() - 1;
+  size_t targetTokens = std::max(MIN_CHUNK_TOKENS, eofIndex / (threads * CHUNKS_PER_THREAD));
+
+  static const size_t openBrace = NativeLexer::literalType("'{'");
+  static const size_t closeBrace = NativeLexer::literalType("'}'");
+
+  int depth = 0;
+  size_t statementStart = 0;
+  size_t chunkStart = 0;
+  for (size_t i = 0; i < eofIndex; i++) {
+    size_t type = tokenList[i]->getType();
+    if (type == openBrace) {
+      depth++;
+    } else if (type == closeBrace) {
+      depth--;
+    }
+    if (depth < 0) {
+      // unbalanced, leave it to the serial parse to report
+      chunkEnds.clear();
+      return;
+    }
+    if (depth != 0) {
+      continue;
+    }
+
+    // structs and functions end with their closing brace, globals with a semicolon (and may contain braces)
+    size_t startType = tokenList[statementStart]->getType();
+    bool isBlock = startType == cgullLexer::STRUCT || startType == cgullLexer::FN;
+    size_t statementEnd = isBlock ? closeBrace : static_cast<size_t>(cgullLexer::SEMICOLON);
+    if (type != statementEnd) {
+      continue;
+    }
+    statementStart = i + 1;
+    if (statementStart - chunkStart >= targetTokens && eofIndex - statementStart >= MIN_CHUNK_TOKENS) {
+      chunkEnds.push_back(statementStart);
+      chunkStart = statementStart;
+    }
+  }
+  chunkEnds.push_back(eofIndex);
+}
+
+void ParallelParser::parseChunk(Chunk& chunk) {
+  auto* interpreter = chunk.parser.getInterpreter<antlr4::atn::ParserATNSimulator>();
+  interpreter->setPredictionMode(antlr4::atn::PredictionMode::SLL);
+  chunk.parser.removeErrorListeners();
+  chunk.parser.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+  try {
+    chunk.tree = chunk.parser.program();
+  } catch (const antlr4::ParseCancellationException&) {
+    chunk.tree = nullptr;
+  }
+}
+
+cgullParser::ProgramContext* ParallelParser::parse(PassTimer* timer) {
+  if (!canSplit()) {
+    return nullptr;
+  }
+
+  size_t begin = 0;
+  for (size_t end : chunkEnds) {
+    chunks.push_back(std::make_unique<Chunk>(tokens, tokenList, begin, end));
+    begin = end;
+  }
+
+  // the calling thread takes chunks too, the parsers only share antlr's synchronized DFA cache
+  std::atomic<size_t> nextChunk{0};
+  auto worker = [&]() {
+    for (size_t chunk = nextChunk++; chunk < chunks.size(); chunk = nextChunk++) {
+      parseChunk(*chunks[chunk]);
+    }
+  };
+  std::vector<std::thread> workers;
+  unsigned workerCount = static_cast<unsigned>(std::min<size_t>(threads, chunks.size()));
+  for (unsigned i = 1; i < workerCount; i++) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : workers) {
+    thread.join();
+  }
+
+  if (timer != nullptr) {
+    timer->addCount("parallel parse chunks", chunks.size());
+  }
+  for (const auto& chunk : chunks) {
+    if (chunk->tree == nullptr) {
+      return nullptr;
+    }
+  }
+
+  // move every statement under one root, dropping the stand in EOFs between chunks
+  program = std::make_unique<cgullParser::ProgramContext>(nullptr, antlr4::atn::ATNState::INVALID_STATE_NUMBER);
+  for (const auto& chunk : chunks) {
+    bool isLast = chunk == chunks.back();
+    for (antlr4::tree::ParseTree* child : chunk->tree->children) {
+      auto* terminal = dynamic_cast<antlr4::tree::TerminalNode*>(child);
+      if (!isLast && terminal != nullptr && terminal->getSymbol()->getType() == antlr4::Token::EOF) {
+        continue;
+      }
+      child->parent = program.get();
+      program->children.push_back(child);
+    }
+    chunkChildEnds.push_back(program->children.size());
+  }
+  program->start = chunks.front()->tree->start;
+  program->stop = chunks.back()->tree->stop;
+  return program.get();
+}
+
+void ParallelParser::releaseStatementsThrough(size_t statementIndex) {
+  if (!program) {
+    return;
+  }
+  // a chunk's parser owns all of its contexts, so it goes once its last statement is done
+  for (; releasedChunks < chunks.size() && chunkChildEnds[releasedChunks] <= statementIndex + 1; releasedChunks++) {
+    size_t begin = releasedChunks == 0 ? 0 : chunkChildEnds[releasedChunks - 1];
+    std::fill(program->children.begin() + begin, program->children.begin() + chunkChildEnds[releasedChunks], nullptr);
+    chunks[releasedChunks].reset();
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef PARALLEL_PARSER_H
+#define PARALLEL_PARSER_H
+
+#include "pass_timer.h"
+#include <antlr4-runtime.h>
+#include <cgullParser.h>
+#include <memory>
+#include <vector>
+
+// parses a large program as several independent pieces on worker threads
+//
+// a program is only a list of top level statements, so the filled token stream is split between statements (after a
+// ';' at brace depth 0, or the closing '}' of a struct or function) into roughly equal chunks. every chunk is parsed
+// as a program of its own by its own cgullParser with SLL prediction, then the statements are moved under one
+// ProgramContext. the tokens are shared, so lines and columns are the ones a serial parse would give
+//
+// chunk parsers bail out at the first syntax error, the caller then parses the whole program serially so errors are
+// reported exactly like before, in order and only once
+class ParallelParser {
+public:
+  // tokens must already be filled, and outlive this parser
+  ParallelParser(antlr4::CommonTokenStream& tokens, unsigned threads);
+  ~ParallelParser();
+  ParallelParser(const ParallelParser&) = delete;
+  ParallelParser& operator=(const ParallelParser&) = delete;
+
+  // false for programs too small to be worth splitting
+  bool canSplit() const { return chunkEnds.size() > 1; }
+
+  // the stitched tree, owned by this parser, or null if any chunk failed to parse
+  cgullParser::ProgramContext* parse(PassTimer* timer);
+
+  // frees the subtrees of every chunk whose statements all come at or before the given child of the stitched root,
+  // their entries in the root's children are set to null. for callers that are done with the statements in order
+  // does nothing if the program wasn't parsed in chunks
+  void releaseStatementsThrough(size_t statementIndex);
+
+private:
+  class TokenRangeStream;
+  struct Chunk;
+
+  antlr4::CommonTokenStream& tokens;
+  std::vector<antlr4::Token*> tokenList;
+  unsigned threads;
+  // one past the last token of each chunk, the last one is the index of EOF
+  std::vector<size_t> chunkEnds;
+  // the chunk parsers own the tree nodes, the root is declared after them so it's destroyed first
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  // one past the root child index of each chunk's last statement, and the first chunk not released yet
+  std::vector<size_t> chunkChildEnds;
+  size_t releasedChunks = 0;
+  std::unique_ptr<cgullParser::ProgramContext> program;
+
+  void split();
+  static void parseChunk(Chunk& chunk);
+};
+
+#endif // PARALLEL_PARSER_H
@@ -0,0 +1,113 @@
+#include "pass_timer.h"
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+PassTimer::Pass::Pass(PassTimer* timer, const std::string& name) : timer(timer) {
+  if (timer == nullptr) {
+    return;
+  }
+  // entries are added when the phase starts so the report keeps the order phases ran in
+  index = timer->entries.size();
+  timer->entries.push_back({name, timer->depth, 0, 0, 0});
+  timer->depth++;
+  peakRssStart = peakRssKiB();
+  cpuStart = cpuMilliseconds();
+  wallStart = wallMilliseconds();
+}
+
+PassTimer::Pass::~Pass() { stop(); }
+
+void PassTimer::Pass::stop() {
+  if (timer == nullptr) {
+    return;
+  }
+  Entry& entry = timer->entries[index];
+  entry.wallMilliseconds = wallMilliseconds() - wallStart;
+  entry.cpuMilliseconds = cpuMilliseconds() - cpuStart;
+  entry.peakRssDeltaKiB = peakRssKiB() - peakRssStart;
+  timer->depth--;
+  timer = nullptr;
+}
+
+void PassTimer::addCount(const std::string& name, uint64_t amount) {
+  for (auto& [countName, value] : counts) {
+    if (countName == name) {
+      value += amount;
+      return;
+    }
+  }
+  counts.emplace_back(name, amount);
+}
+
+double PassTimer::wallMilliseconds() {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double PassTimer::cpuMilliseconds() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  timespec time{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return time.tv_sec * 1000.0 + time.tv_nsec / 1e6;
+#else
+  return std::clock() * 1000.0 / CLOCKS_PER_SEC;
+#endif
+}
+
+long PassTimer::peakRssKiB() {
+#ifdef _WIN32
+  return 0;
+#else
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  // bytes on macos, kilobytes everywhere else
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+void PassTimer::printTable(std::ostream& out) const {
+  out << "\n===-------------------------------------------===\n";
+  out << "                 Pass timing report\n";
+  out << "===-------------------------------------------===\n";
+  out << std::right << std::setw(12) << "Wall (ms)" << std::setw(12) << "CPU (ms)" << std::setw(16)
+      << "Peak RSS (KiB)"
+      << "  Pass\n";
+  out << std::fixed << std::setprecision(3);
+  for (const auto& entry : entries) {
+    out << std::setw(12) << entry.wallMilliseconds << std::setw(12) << entry.cpuMilliseconds << std::setw(16)
+        << ("+" + std::to_string(entry.peakRssDeltaKiB)) << "  " << std::string(entry.depth * 2, ' ') << entry.name
+        << "\n";
+  }
+  if (!counts.empty()) {
+    out << "\n" << std::setw(12) << "Count" << "  Event\n";
+  }
+  for (const auto& [name, value] : counts) {
+    out << std::setw(12) << value << "  " << name << "\n";
+  }
+  out << std::defaultfloat << std::flush;
+}
+
+void PassTimer::printJson(std::ostream& out) const {
+  out << "{\"passes\": [";
+  out << std::fixed << std::setprecision(3);
+  for (size_t i = 0; i < entries.size(); i++) {
+    const auto& entry = entries[i];
+    out << (i == 0 ? "" : ", ") << "{\"name\": \"" << entry.name << "\", \"depth\": " << entry.depth
+        << ", \"wallMs\": " << entry.wallMilliseconds << ", \"cpuMs\": " << entry.cpuMilliseconds
+        << ", \"peakRssDeltaKiB\": " << entry.peakRssDeltaKiB << "}";
+  }
+  out << "], \"counts\": {";
+  for (size_t i = 0; i < counts.size(); i++) {
+    out << (i == 0 ? "" : ", ") << "\"" << counts[i].first << "\": " << counts[i].second;
+  }
+  out << "}}" << std::endl;
+  out << std::defaultfloat;
+}
@@ -0,0 +1,61 @@
+#ifndef PASS_TIMER_H
+#define PASS_TIMER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// records wall time, cpu time and peak rss growth of each compiler phase, for --time-passes
+// cpu time is per thread so batch workers don't count each other, peak rss is per process
+class PassTimer {
+public:
+  struct Entry {
+    std::string name;
+    // nesting level, semantic passes sit under the semantic analysis phase
+    int depth = 0;
+    double wallMilliseconds = 0;
+    double cpuMilliseconds = 0;
+    long peakRssDeltaKiB = 0;
+  };
+
+  // starts timing a phase, stops when it goes out of scope or on stop()
+  // a null timer makes it a no-op so callers don't need to check if timing is on
+  class Pass {
+  public:
+    Pass(PassTimer* timer, const std::string& name);
+    ~Pass();
+    Pass(const Pass&) = delete;
+    Pass& operator=(const Pass&) = delete;
+
+    void stop();
+
+  private:
+    PassTimer* timer;
+    size_t index = 0;
+    double wallStart = 0;
+    double cpuStart = 0;
+    long peakRssStart = 0;
+  };
+
+  // events worth reporting next to the timings, like parses falling back to full LL
+  void addCount(const std::string& name, uint64_t amount = 1);
+
+  const std::vector<Entry>& getEntries() const { return entries; }
+  const std::vector<std::pair<std::string, uint64_t>>& getCounts() const { return counts; }
+
+  void printTable(std::ostream& out) const;
+  void printJson(std::ostream& out) const;
+
+private:
+  std::vector<Entry> entries;
+  std::vector<std::pair<std::string, uint64_t>> counts;
+  int depth = 0;
+
+  static double wallMilliseconds();
+  static double cpuMilliseconds();
+  static long peakRssKiB();
+};
+
+#endif // PASS_TIMER_H
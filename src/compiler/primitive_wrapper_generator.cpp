@@ -1,7 +1,9 @@
 #include "primitive_wrapper_generator.h"
+#include "symbols/type_table.h"
 #include <stdexcept>
 
-std::shared_ptr<IRClass> PrimitiveWrapperGenerator::generateWrapperClass(PrimitiveType::PrimitiveKind kind) {
+std::shared_ptr<IRClass> PrimitiveWrapperGenerator::generateWrapperClass(PrimitiveType::PrimitiveKind kind,
+                                                                         ObjectArena& objects) {
   std::string className = getClassName(kind);
   auto irClass = std::make_shared<IRClass>();
   irClass->name = className;
@@ -15,25 +17,25 @@ std::shared_ptr<IRClass> PrimitiveWrapperGenerator::generateWrapperClass(Primiti
                                      : std::string(1, std::toupper(getInstructionPrefix(kind)[0])));
 
   // generate field
-  auto valueType = std::make_shared<PrimitiveType>(kind);
-  auto fieldScope = std::make_shared<Scope>(nullptr);
-  auto valueField = std::make_shared<VariableSymbol>("value", 0, 0, fieldScope);
+  auto valueType = TypeTable::primitive(kind);
+  auto fieldScope = objects.create<Scope>(nullptr);
+  auto valueField = objects.create<VariableSymbol>("value", 0, 0, fieldScope);
   valueField->dataType = valueType;
   valueField->isDefined = true;
 
   // constructor method
-  auto constructorScope = std::make_shared<Scope>(nullptr);
-  auto constructor = std::make_shared<FunctionSymbol>("<init>", 0, 0, constructorScope);
+  auto constructorScope = objects.create<Scope>(nullptr);
+  auto constructor = objects.create<FunctionSymbol>("<init>", 0, 0, constructorScope);
   constructor->isDefined = true;
 
   // constructor parameter
-  auto paramSymbol = std::make_shared<VariableSymbol>("value", 0, 0, constructorScope);
+  auto paramSymbol = objects.create<VariableSymbol>("value", 0, 0, constructorScope);
   paramSymbol->dataType = valueType;
   paramSymbol->isDefined = true;
   constructor->parameters.push_back(paramSymbol);
 
   // constructor return type (void)
-  constructor->returnTypes.push_back(std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+  constructor->returnTypes.push_back(TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
 
   // constructor instructions
   constructor->instructions.push_back(std::make_shared<IRRawInstruction>("aload 0"));
@@ -45,8 +47,8 @@ std::shared_ptr<IRClass> PrimitiveWrapperGenerator::generateWrapperClass(Primiti
   constructor->instructions.push_back(std::make_shared<IRRawInstruction>("return"));
 
   // getter method
-  auto getterScope = std::make_shared<Scope>(nullptr);
-  auto getter = std::make_shared<FunctionSymbol>("getValue", 0, 0, getterScope);
+  auto getterScope = objects.create<Scope>(nullptr);
+  auto getter = objects.create<FunctionSymbol>("getValue", 0, 0, getterScope);
   getter->isDefined = true;
   getter->isStructMethod = true;
   getter->returnTypes.push_back(valueType);
@@ -56,14 +58,14 @@ std::shared_ptr<IRClass> PrimitiveWrapperGenerator::generateWrapperClass(Primiti
   getter->instructions.push_back(std::make_shared<IRRawInstruction>("getfield " + className + ".value " + fieldType));
   getter->instructions.push_back(std::make_shared<IRRawInstruction>(getInstructionPrefix(kind) + "return"));
   // setter method
-  auto setterScope = std::make_shared<Scope>(nullptr);
-  auto setter = std::make_shared<FunctionSymbol>("setValue", 0, 0, setterScope);
+  auto setterScope = objects.create<Scope>(nullptr);
+  auto setter = objects.create<FunctionSymbol>("setValue", 0, 0, setterScope);
   setter->isDefined = true;
   setter->isStructMethod = true;
-  setter->returnTypes.push_back(std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID));
+  setter->returnTypes.push_back(TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID));
 
   // setter parameter
-  auto setterParam = std::make_shared<VariableSymbol>("value", 0, 0, setterScope);
+  auto setterParam = objects.create<VariableSymbol>("value", 0, 0, setterScope);
   setterParam->dataType = valueType;
   setterParam->isDefined = true;
   setter->parameters.push_back(setterParam);
@@ -74,6 +76,10 @@ std::shared_ptr<IRClass> PrimitiveWrapperGenerator::generateWrapperClass(Primiti
   setter->instructions.push_back(std::make_shared<IRRawInstruction>("putfield " + className + ".value " + fieldType));
   setter->instructions.push_back(std::make_shared<IRRawInstruction>("return"));
 
+  constructor->seal();
+  getter->seal();
+  setter->seal();
+
   // add methods to class
   irClass->methods.push_back(constructor);
   irClass->methods.push_back(getter);
@@ -1,11 +1,13 @@
 #pragma once
 
+#include "arena.h"
 #include "instructions/ir_class.h"
 #include "symbols/type.h"
 
 class PrimitiveWrapperGenerator {
 public:
-  static std::shared_ptr<IRClass> generateWrapperClass(PrimitiveType::PrimitiveKind kind);
+  // the wrapper's symbols are created in objects
+  static std::shared_ptr<IRClass> generateWrapperClass(PrimitiveType::PrimitiveKind kind, ObjectArena& objects);
   static std::string getClassName(PrimitiveType::PrimitiveKind kind);
 
 private:
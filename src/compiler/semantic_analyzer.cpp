@@ -1,195 +1,284 @@
 #include "semantic_analyzer.h"
 #include "listeners/default_constructor_listener.h"
+#include "listeners/multi_listener_walker.h"
 #include "listeners/special_methods_listener.h"
 #include "listeners/symbol_collection_listener.h"
 #include "listeners/type_checking_listener.h"
-#include "listeners/use_before_definition_listener.h"
+#include "use_before_definition_check.h"
+#include "work_stealing_pool.h"
 #include <antlr4-runtime.h>
 #include <iostream>
 
-SemanticAnalyzer::SemanticAnalyzer() {
-  globalScope = std::make_shared<Scope>(nullptr);
+SemanticAnalyzer::SemanticAnalyzer(std::shared_ptr<AtomTable> atoms) {
+  globalScope = objects.create<Scope>(nullptr, atoms);
   scopeMap[nullptr] = globalScope;
   addBuiltinFunctions();
 }
 
-void SemanticAnalyzer::analyze(cgullParser::ProgramContext* programCtx) {
+void SemanticAnalyzer::analyze(cgullParser::ProgramContext* programCtx, PassTimer* timer, unsigned checkThreads) {
+  // the five passes share walks where they can: passes in one walk get their own error reporters, appended in pass
+  // order afterwards, so errors come out exactly like with a walk per pass
+  uint64_t nodesVisited = 0;
+
+  // the tree as flat arrays, for the passes that don't need antlr's contexts. it's freed before type checking
+  FlatAst ast;
+  {
+    // every side table from here on is a vector indexed by these ids, they stay on the contexts once the index is gone
+    PassTimer::Pass nodeNumberingPass(timer, "node numbering");
+    NodeIndex nodeIndex(programCtx);
+    nodeNumberingPass.stop();
+
+    PassTimer::Pass loweringPass(timer, "ast lowering");
+    ast = FlatAst::lower(nodeIndex, globalScope->getAtoms());
+  }
+
+  // what each node is to its parent, so the passes and code generation don't have to cast the parent to find out
+  PassTimer::Pass nodeRolesPass(timer, "node roles");
+  result.nodeRoles = assignNodeRoles(ast);
+  nodeRolesPass.stop();
+
   // FIRST PASS: collect symbols, handles declarations errors
-  SymbolCollectionListener symbolCollector(errorReporter, globalScope);
-  antlr4::tree::ParseTreeWalker walker;
-  walker.walk(&symbolCollector, programCtx);
-  scopeMap = symbolCollector.getScopeMapping();
-
-  // SECOND PASS: create default constructors for structs
-  DefaultConstructorListener defaultConstructorListener(errorReporter, scopeMap);
-  walker.walk(&defaultConstructorListener, programCtx);
-  constructorMap = defaultConstructorListener.getConstructorMap();
-
-  // THIRD PASS: ensure special methods are valid
-  SpecialMethodsListener specialMethodsListener(errorReporter, scopeMap);
-  walker.walk(&specialMethodsListener, programCtx);
-
-  // FOURTH PASS: validate types and expressions
-  TypeCheckingListener typeChecker(errorReporter, scopeMap, globalScope);
-  walker.walk(&typeChecker, programCtx);
-  expressionTypes = typeChecker.getExpressionTypes();
-  expectingStringConversion = typeChecker.getExpectingStringConversion();
-  resolvedMethodSymbols = typeChecker.getResolvedMethodSymbols();
-
-  // FIFTH PASS: check for use before definition errors
-  UseBeforeDefinitionListener useBeforeDefListener(errorReporter, scopeMap);
-  walker.walk(&useBeforeDefListener, programCtx);
+  // everything after it resolves names declared anywhere in the program, so it walks alone
+  PassTimer::Pass symbolCollectionPass(timer, "symbol collection");
+  SymbolCollectionListener symbolCollector(errorReporter, ast, objects, typeTable, globalScope);
+  MultiListenerWalker symbolWalker({&symbolCollector});
+  symbolWalker.walk(programCtx);
+  scopeMap = symbolCollector.takeScopeMapping();
+  result.programCtx = programCtx;
+  result.nodeScopes = symbolCollector.takeNodeScopes();
+  nodesVisited += symbolWalker.getNodesVisited();
+  symbolCollectionPass.stop();
+
+  // SECOND AND THIRD PASS: create default constructors and ensure special methods are valid
+  // both only handle struct definitions, which are always program -> top_level_statement -> struct_definition, so
+  // the walk stops there
+  PassTimer::Pass structPass(timer, "default constructors, special methods");
+  ErrorReporter specialMethodsErrors;
+  DefaultConstructorListener defaultConstructorListener(errorReporter, scopeMap, objects);
+  SpecialMethodsListener specialMethodsListener(specialMethodsErrors, scopeMap, objects);
+  MultiListenerWalker structWalker({&defaultConstructorListener, &specialMethodsListener}, 2);
+  structWalker.walk(programCtx);
+  result.constructorMap = defaultConstructorListener.takeConstructorMap();
+  errorReporter.append(specialMethodsErrors);
+  nodesVisited += structWalker.getNodesVisited();
+  structPass.stop();
+
+  // every scope is complete now, so blocks nested deep enough to make walking the parent chain slow get one table
+  PassTimer::Pass flattenPass(timer, "scope flattening");
+  size_t flattenedScopes = 0;
+  scopeMap.forEach([&](size_t, Scope* scope) {
+    if (scope->getDepth() >= FLATTEN_DEPTH) {
+      scope->flatten();
+      flattenedScopes++;
+    }
+  });
+  flattenPass.stop();
+
+  // FOURTH PASS: check for use before definition errors, a scan over the flat arrays rather than a walk
+  // it's the last pass reading them, so the flat tree goes before the type checker builds its tables and is never
+  // alive at the same time as them or the IR. its errors still come after the type checker's
+  PassTimer::Pass useBeforeDefinitionPass(timer, "use before definition");
+  ErrorReporter useBeforeDefinitionErrors;
+  checkUseBeforeDefinition(ast, result.nodeScopes, result.nodeRoles, useBeforeDefinitionErrors);
+  nodesVisited += ast.size() - 1;
+  size_t nodeCount = ast.size();
+  if (timer != nullptr) {
+    timer->addCount("flat ast bytes", ast.getMemoryBytes());
+  }
+  ast = FlatAst();
+  useBeforeDefinitionPass.stop();
+
+  // FIFTH PASS: validate types and expressions
+  // a function body only reads the finished scopes and writes the types of its own nodes, so every function is type
+  // checked by a listener of its own on the pool. the rest of the program is checked first, and the errors it reported
+  // before each function are merged with the function's in program order, so the errors come out like with one walk
+  PassTimer::Pass typeCheckingPass(timer, "type checking");
+  ErrorReporter programErrors;
+  TypeCheckingListener typeChecker(programErrors, result.nodeScopes, typeTable, globalScope);
+  std::vector<cgullParser::Function_definitionContext*> functions;
+  std::vector<size_t> errorsBeforeFunction;
+  MultiListenerWalker programWalker({&typeChecker});
+  programWalker.setSkip([&](antlr4::ParserRuleContext* ctx) {
+    if (ctx->getRuleIndex() != cgullParser::RuleFunction_definition) {
+      return false;
+    }
+    functions.push_back(static_cast<cgullParser::Function_definitionContext*>(ctx));
+    errorsBeforeFunction.push_back(programErrors.getErrorCount());
+    return true;
+  });
+  programWalker.walk(programCtx);
+  nodesVisited += programWalker.getNodesVisited();
+
+  std::vector<ErrorReporter> functionErrors(functions.size());
+  std::vector<std::unique_ptr<TypeCheckingListener>> functionCheckers(functions.size());
+  std::vector<uint64_t> functionNodesVisited(functions.size());
+  WorkStealingPool pool(nodeCount >= PARALLEL_CHECK_NODES ? checkThreads : 1);
+  pool.run(functions.size(), [&](size_t function) {
+    functionCheckers[function] = std::make_unique<TypeCheckingListener>(
+        functionErrors[function], result.nodeScopes, typeTable, globalScope, NodeIndex::idOf(functions[function]));
+    MultiListenerWalker functionWalker({functionCheckers[function].get()});
+    functionWalker.walk(functions[function]);
+    functionNodesVisited[function] = functionWalker.getNodesVisited();
+  });
+
+  size_t programErrorsMerged = 0;
+  for (size_t function = 0; function < functions.size(); function++) {
+    errorReporter.append(programErrors, programErrorsMerged, errorsBeforeFunction[function]);
+    programErrorsMerged = errorsBeforeFunction[function];
+    errorReporter.append(functionErrors[function]);
+    typeChecker.merge(*functionCheckers[function]);
+    functionCheckers[function].reset();
+  }
+  errorReporter.append(programErrors, programErrorsMerged, programErrors.getErrorCount());
+  errorReporter.append(useBeforeDefinitionErrors);
+  result.expressionTypes = typeChecker.takeExpressionTypes();
+  result.expectingStringConversion = typeChecker.takeExpectingStringConversion();
+  result.resolvedMethodSymbols = typeChecker.takeResolvedMethodSymbols();
+  for (uint64_t visited : functionNodesVisited) {
+    nodesVisited += visited;
+  }
+  typeCheckingPass.stop();
+
+  if (timer != nullptr) {
+    timer->addCount("semantic analysis nodes visited", nodesVisited);
+    timer->addCount("flattened scopes", flattenedScopes);
+    timer->addCount("type checked functions", functions.size());
+    timer->addCount("type checking steals", pool.getSteals());
+  }
 }
 
 void SemanticAnalyzer::addBuiltinFunctions() {
-  auto addBuiltinFunction = [this](const std::string& name,
-                                   const std::vector<std::pair<std::string, std::shared_ptr<Type>>>& params,
-                                   const std::vector<std::shared_ptr<Type>>& returnTypes) {
-    auto funcSymbol = std::make_shared<FunctionSymbol>(name, 0, 0, globalScope);
-    funcSymbol->isDefined = true;
-    funcSymbol->isBuiltin = true;
-
-    for (const auto& [paramName, paramType] : params) {
-      auto paramSymbol = std::make_shared<VariableSymbol>(paramName, 0, 0, globalScope);
-      paramSymbol->type = SymbolType::PARAMETER;
-      paramSymbol->dataType = paramType;
-      paramSymbol->isDefined = true;
-      funcSymbol->parameters.push_back(paramSymbol);
-    }
-    funcSymbol->returnTypes = returnTypes;
+  // copies, so one program can't leak changes to a builtin into the next (batch workers, compile server)
+  for (const auto& builtin : getBuiltinFunctions()) {
+    auto funcSymbol = objects.create<FunctionSymbol>(*builtin);
+    funcSymbol->scope = globalScope;
     globalScope->add(funcSymbol);
-  };
-
-  auto intType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::INT);
-  auto floatType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::FLOAT);
-  auto boolType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::BOOLEAN);
-  auto stringType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::STRING);
-  auto voidType = std::make_shared<PrimitiveType>(PrimitiveType::PrimitiveKind::VOID);
-
-  addBuiltinFunction("println", {{"value", stringType}}, {voidType});
-  addBuiltinFunction("print", {{"value", stringType}}, {voidType});
-  addBuiltinFunction("readline", {}, {stringType});
-  addBuiltinFunction("read", {}, {stringType});
-
-  // math functions, eventually will be moved to a math library
-  addBuiltinFunction("sqrt", {{"value", floatType}}, {floatType});
+  }
 }
 
-void SemanticAnalyzer::printSymbolsAsJson(std::ostream& out) const {
-  out << "{\n";
-  printScopeAsJson(globalScope, out, 2);
-  out << "\n}\n";
+// built once per process and shared read-only between analyzers, in an arena of their own
+const std::vector<FunctionSymbol*>& SemanticAnalyzer::getBuiltinFunctions() {
+  static ObjectArena builtinObjects(4 * 1024);
+  static const std::vector<FunctionSymbol*> builtins = []() {
+    std::vector<FunctionSymbol*> functions;
+    auto builtinScope = builtinObjects.create<Scope>(nullptr);
+    auto addBuiltinFunction = [&](const std::string& name, const std::vector<std::pair<std::string, Type*>>& params,
+                                  const std::vector<Type*>& returnTypes) {
+      auto funcSymbol = builtinObjects.create<FunctionSymbol>(name, 0, 0, builtinScope);
+      funcSymbol->isDefined = true;
+      funcSymbol->isBuiltin = true;
+
+      for (const auto& [paramName, paramType] : params) {
+        auto paramSymbol = builtinObjects.create<VariableSymbol>(paramName, 0, 0, builtinScope);
+        paramSymbol->type = SymbolType::PARAMETER;
+        paramSymbol->dataType = paramType;
+        paramSymbol->isDefined = true;
+        funcSymbol->parameters.push_back(paramSymbol);
+      }
+      funcSymbol->returnTypes = returnTypes;
+      // the copies added to each program share this signature
+      funcSymbol->seal();
+      functions.push_back(funcSymbol);
+    };
+
+    auto floatType = TypeTable::primitive(PrimitiveType::PrimitiveKind::FLOAT);
+    auto stringType = TypeTable::primitive(PrimitiveType::PrimitiveKind::STRING);
+    auto voidType = TypeTable::primitive(PrimitiveType::PrimitiveKind::VOID);
+
+    addBuiltinFunction("println", {{"value", stringType}}, {voidType});
+    addBuiltinFunction("print", {{"value", stringType}}, {voidType});
+    addBuiltinFunction("readline", {}, {stringType});
+    addBuiltinFunction("read", {}, {stringType});
+
+    // math functions, eventually will be moved to a math library
+    addBuiltinFunction("sqrt", {{"value", floatType}}, {floatType});
+    return functions;
+  }();
+  return builtins;
 }
 
-void SemanticAnalyzer::printScopeAsJson(std::shared_ptr<Scope> scope, std::ostream& out, int indentLevel) const {
-  std::string indent(indentLevel, ' ');
-  std::string childIndent(indentLevel + 2, ' ');
-  std::string symbolIndent(indentLevel + 4, ' ');
-
-  // basic scope information
-  std::string scopeName = getScopeName(scope);
-  out << indent << "\"scopeName\": \"" << scopeName << "\",\n";
-  out << indent << "\"scopeId\": \"" << scope.get() << "\"";
+void SemanticAnalyzer::printSymbolsAsJson(std::ostream& out, bool compact) const {
+  JsonWriter json(out, compact);
+  json.beginObject();
+  printScopeAsJson(globalScope, json);
+  json.endObject();
+}
 
-  // add parent reference if exists
+void SemanticAnalyzer::printScopeAsJson(Scope* scope, JsonWriter& json) const {
+  json.key("scopeName");
+  json.value(getScopeName(scope));
+  json.key("scopeId");
+  json.value(static_cast<const void*>(scope));
   if (scope->parent) {
-    out << ",\n" << indent << "\"parentId\": \"" << scope->parent.get() << "\"";
+    json.key("parentId");
+    json.value(static_cast<const void*>(scope->parent));
   }
 
-  // write scope symbols
-  out << ",\n" << indent << "\"symbols\": {";
-
-  bool firstSymbol = true;
-  for (const auto& [name, symbol] : scope->symbols) {
-    if (!firstSymbol) {
-      out << ",";
-    }
-    out << "\n";
-    firstSymbol = false;
-
-    out << childIndent << "\"" << name << "\": {\n";
+  json.key("symbols");
+  json.beginObject();
+  for (const auto& [atom, symbol] : scope->symbols) {
+    json.key(scope->getName(atom));
+    json.beginObject();
 
     // common attributes for all symbols
-    out << symbolIndent << "\"name\": \"" << symbol->name << "\",\n";
-    out << symbolIndent << "\"type\": \"" << symbolTypeToString(symbol->type) << "\",\n";
-    out << symbolIndent << "\"defined\": " << (symbol->isDefined ? "true" : "false") << ",\n";
-    out << symbolIndent << "\"private\": " << (symbol->isPrivate ? "true" : "false") << ",\n";
-    out << symbolIndent << "\"line\": " << symbol->definedAtLine << ",\n";
-    out << symbolIndent << "\"column\": " << symbol->definedAtColumn;
+    json.key("name");
+    json.value(symbol->name);
+    json.key("type");
+    json.value(symbolTypeToString(symbol->type));
+    json.key("defined");
+    json.value(symbol->isDefined);
+    json.key("private");
+    json.value(symbol->isPrivate);
+    json.key("line");
+    json.value(symbol->definedAtLine);
+    json.key("column");
+    json.value(symbol->definedAtColumn);
 
     // type-specific attributes
-    if (symbol->type == SymbolType::VARIABLE) {
-      auto varSymbol = std::dynamic_pointer_cast<VariableSymbol>(symbol);
-      out << ",\n" << symbolIndent << "\"isConst\": " << (varSymbol->isConstant ? "true" : "false") << ",\n";
-      out << symbolIndent << "\"dataType\": \"" << (varSymbol->dataType ? varSymbol->dataType->toString() : "unknown")
-          << "\"";
+    if (symbol->type == SymbolType::VARIABLE || symbol->type == SymbolType::PARAMETER) {
+      auto varSymbol = dynamic_cast<VariableSymbol*>(symbol);
+      json.key("isConst");
+      json.value(varSymbol->isConstant);
+      json.key("dataType");
+      json.value(varSymbol->dataType ? varSymbol->dataType->toString() : "unknown");
     } else if (symbol->type == SymbolType::FUNCTION) {
-      auto funcSymbol = std::dynamic_pointer_cast<FunctionSymbol>(symbol);
-
-      // return types
-      out << ",\n" << symbolIndent << "\"returnTypes\": [";
-      for (size_t i = 0; i < funcSymbol->returnTypes.size(); ++i) {
-        if (i > 0)
-          out << ", ";
-        out << "\"" << (funcSymbol->returnTypes[i] ? funcSymbol->returnTypes[i]->toString() : "unknown") << "\"";
+      auto funcSymbol = dynamic_cast<FunctionSymbol*>(symbol);
+      json.key("returnTypes");
+      json.beginArray();
+      for (Type* returnType : funcSymbol->returnTypes) {
+        json.value(returnType ? returnType->toString() : "unknown");
       }
-      out << "],\n";
-
-      // parameters
-      out << symbolIndent << "\"parameters\": [";
-      for (size_t i = 0; i < funcSymbol->parameters.size(); ++i) {
-        if (i > 0)
-          out << ", ";
-        out << "\"" << funcSymbol->parameters[i]->name << " ("
-            << (funcSymbol->parameters[i]->dataType ? funcSymbol->parameters[i]->dataType->toString() : "unknown")
-            << ")\"";
+      json.endArray();
+      json.key("parameters");
+      json.beginArray();
+      for (auto* parameter : funcSymbol->parameters) {
+        json.value(parameter->name + " (" + (parameter->dataType ? parameter->dataType->toString() : "unknown") +
+                   ")");
       }
-      out << "]";
+      json.endArray();
     } else if (symbol->type == SymbolType::STRUCT) {
-      auto typeSymbol = std::dynamic_pointer_cast<TypeSymbol>(symbol);
-      out << ",\n" << symbolIndent << "\"memberScopeId\": \"" << typeSymbol->memberScope.get() << "\"";
-    } else if (symbol->type == SymbolType::PARAMETER) {
-      auto paramSymbol = std::dynamic_pointer_cast<VariableSymbol>(symbol);
-      out << ",\n" << symbolIndent << "\"isConst\": " << (paramSymbol->isConstant ? "true" : "false") << ",\n";
-      out << symbolIndent << "\"dataType\": \""
-          << (paramSymbol->dataType ? paramSymbol->dataType->toString() : "unknown") << "\"";
+      auto typeSymbol = dynamic_cast<TypeSymbol*>(symbol);
+      json.key("memberScopeId");
+      json.value(static_cast<const void*>(typeSymbol->memberScope));
     } else if (symbol->type == SymbolType::TYPE) {
-      auto typeSymbol = std::dynamic_pointer_cast<TypeSymbol>(symbol);
-      out << ",\n"
-          << symbolIndent << "\"typeRepresentation\": \""
-          << (typeSymbol->typeRepresentation ? typeSymbol->typeRepresentation->toString() : "unknown") << "\"";
+      auto typeSymbol = dynamic_cast<TypeSymbol*>(symbol);
+      json.key("typeRepresentation");
+      json.value(typeSymbol->typeRepresentation ? typeSymbol->typeRepresentation->toString() : "unknown");
     }
-
-    out << "\n" << childIndent << "}";
-  }
-
-  out << (scope->symbols.empty() ? "}" : "\n" + indent + "}");
-
-  // child scopes
-  std::vector<std::shared_ptr<Scope>> childScopes = findChildScopes(scope);
-  if (!childScopes.empty()) {
-    out << ",\n" << indent << "\"childScopes\": [";
-
-    for (size_t i = 0; i < childScopes.size(); ++i) {
-      if (i > 0)
-        out << ",";
-      out << "\n" << childIndent << "{\n";
-      printScopeAsJson(childScopes[i], out, indentLevel + 4);
-      out << "\n" << childIndent << "}";
-    }
-
-    out << "\n" << indent << "]";
+    json.endObject();
   }
-}
-
-std::vector<std::shared_ptr<Scope>> SemanticAnalyzer::findChildScopes(std::shared_ptr<Scope> parent) const {
-  std::vector<std::shared_ptr<Scope>> children;
-  for (const auto& [ctx, scope] : scopeMap) {
-    if (scope->parent == parent && scope != parent) {
-      children.push_back(scope);
+  json.endObject();
+
+  if (!scope->children.empty()) {
+    json.key("childScopes");
+    json.beginArray();
+    for (Scope* child : scope->children) {
+      json.beginObject();
+      printScopeAsJson(child, json);
+      json.endObject();
     }
+    json.endArray();
   }
-  return children;
 }
 
 std::string SemanticAnalyzer::symbolTypeToString(SymbolType type) const {
@@ -209,19 +298,12 @@ std::string SemanticAnalyzer::symbolTypeToString(SymbolType type) const {
   }
 }
 
-std::string SemanticAnalyzer::getScopeName(std::shared_ptr<Scope> scope) const {
+std::string SemanticAnalyzer::getScopeName(Scope* scope) const {
   if (!scope->parent) {
     return "Global Scope";
   }
 
-  antlr4::ParserRuleContext* ctx = nullptr;
-  for (const auto& [context, mappedScope] : scopeMap) {
-    if (mappedScope == scope) {
-      ctx = context;
-      break;
-    }
-  }
-
+  antlr4::ParserRuleContext* ctx = scope->definingContext;
   if (!ctx) {
     return "Unknown Scope";
   }
@@ -250,23 +332,9 @@ std::string SemanticAnalyzer::getScopeName(std::shared_ptr<Scope> scope) const {
   return "Block at Line " + std::to_string(ctx->getStart()->getLine());
 }
 
-const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& SemanticAnalyzer::getScopes() {
-  return scopeMap;
-}
-
-const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>>& SemanticAnalyzer::getExpressionTypes() {
-  return expressionTypes;
-}
-
-const std::unordered_set<antlr4::ParserRuleContext*>& SemanticAnalyzer::getExpectingStringConversion() const {
-  return expectingStringConversion;
-}
+void SemanticAnalyzer::releaseFrontEndTables() { scopeMap = NodeTable<Scope*>(); }
 
-const std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>>& SemanticAnalyzer::getConstructorMap() {
-  return constructorMap;
+const NodeTable<Scope*>& SemanticAnalyzer::getScopes() {
+  return scopeMap;
 }
 
-const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>>&
-SemanticAnalyzer::getResolvedMethodSymbols() const {
-  return resolvedMethodSymbols;
-}
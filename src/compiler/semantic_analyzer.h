@@ -1,41 +1,58 @@
 #ifndef SEMANTIC_ANALYZER_H
 #define SEMANTIC_ANALYZER_H
 
+#include "analysis_result.h"
 #include "errors/error_reporter.h"
+#include "json_writer.h"
+#include "node_table.h"
+#include "pass_timer.h"
 #include "symbols/symbol.h"
+#include "symbols/type_table.h"
 #include <cgullParser.h>
 #include <memory>
 
 class SemanticAnalyzer {
 public:
-  SemanticAnalyzer();
+  // atoms is the table the program's identifiers were interned into, a new one if null
+  explicit SemanticAnalyzer(std::shared_ptr<AtomTable> atoms = nullptr);
 
-  void analyze(cgullParser::ProgramContext* programCtx);
+  // each of the passes is recorded separately when a timer is given
+  // function bodies are type checked on checkThreads threads (0 for one per core) in programs big enough for it
+  void analyze(cgullParser::ProgramContext* programCtx, PassTimer* timer = nullptr, unsigned checkThreads = 1);
   ErrorReporter& getErrorReporter() { return errorReporter; }
 
-  void printSymbolsAsJson(std::ostream& out = std::cout) const;
-  const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>>& getScopes();
-  const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>>& getExpressionTypes();
-  const std::unordered_set<antlr4::ParserRuleContext*>& getExpectingStringConversion() const;
-  const std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>>& getConstructorMap();
-  const std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>>&
-  getResolvedMethodSymbols() const;
+  // the scope tree with every symbol, on one line when compact
+  void printSymbolsAsJson(std::ostream& out = std::cout, bool compact = false) const;
+  // the scopes opened by nodes, indexed by the node ids given to the analyzed tree
+  const NodeTable<Scope*>& getScopes();
+  // what code generation needs, complete once analyze returns
+  const AnalysisResult& getResult() const { return result; }
+  // frees what only the JSON output reads (the scope map), getResult and the objects stay valid
+  void releaseFrontEndTables();
+
+  // owns every scope, symbol and type of the program, the pointers above stay valid while the analyzer lives
+  const ObjectArena& getObjects() const { return objects; }
 
 private:
+  // declared first, so it outlives every table pointing into it
+  ObjectArena objects;
   ErrorReporter errorReporter;
-  std::shared_ptr<Scope> globalScope;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Scope>> scopeMap;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<Type>> expressionTypes;
-  std::unordered_set<antlr4::ParserRuleContext*> expectingStringConversion;
-  std::unordered_map<std::string, std::shared_ptr<FunctionSymbol>> constructorMap;
-  std::unordered_map<antlr4::ParserRuleContext*, std::shared_ptr<FunctionSymbol>> resolvedMethodSymbols;
+  Scope* globalScope = nullptr;
+  // array, pointer and struct types of this program
+  TypeTable typeTable{objects};
+  NodeTable<Scope*> scopeMap;
+  AnalysisResult result;
+  // scopes at least this deep (global is 0, a function 1) are flattened before type checking
+  static constexpr int FLATTEN_DEPTH = 4;
+  // below this many parse tree nodes, starting threads costs more than type checking on them saves
+  static constexpr size_t PARALLEL_CHECK_NODES = 20000;
   void addBuiltinFunctions();
+  static const std::vector<FunctionSymbol*>& getBuiltinFunctions();
 
   // JSON generation
-  void printScopeAsJson(std::shared_ptr<Scope> scope, std::ostream& out, int indentLevel) const;
-  std::vector<std::shared_ptr<Scope>> findChildScopes(std::shared_ptr<Scope> parent) const;
+  void printScopeAsJson(Scope* scope, JsonWriter& json) const;
   std::string symbolTypeToString(SymbolType type) const;
-  std::string getScopeName(std::shared_ptr<Scope> scope) const;
+  std::string getScopeName(Scope* scope) const;
 };
 
 #endif // SEMANTIC_ANALYZER_H
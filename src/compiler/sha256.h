@@ -0,0 +1,27 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// incremental sha-256, for cache keys where a collision would mean restoring another program's class files
+class Sha256 {
+public:
+  Sha256();
+
+  void update(std::string_view data);
+  // the digest as 64 lowercase hex characters, the hash can't be updated after
+  std::string hexDigest();
+
+private:
+  std::array<uint32_t, 8> state;
+  std::array<unsigned char, 64> block{};
+  size_t blockSize = 0;
+  uint64_t totalBytes = 0;
+
+  void compress(const unsigned char* chunk);
+};
+
+#endif // SHA256_H
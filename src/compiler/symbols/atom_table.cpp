@@ -0,0 +1,68 @@
+#include "atom_table.h"
+#include <cstring>
+
+AtomTable::AtomTable() : names(1), slots(256, NO_ATOM) {}
+
+uint64_t AtomTable::hash(std::string_view name) {
+  // fnv-1a, names are short
+  uint64_t result = 14695981039346656037ull;
+  for (char c : name) {
+    result = (result ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+  }
+  return result;
+}
+
+Atom AtomTable::find(std::string_view name) const {
+  size_t mask = slots.size() - 1;
+  for (size_t slot = hash(name) & mask;; slot = (slot + 1) & mask) {
+    Atom atom = slots[slot];
+    if (atom == NO_ATOM || names[atom] == name) {
+      return atom;
+    }
+  }
+}
+
+Atom AtomTable::intern(std::string_view name) {
+  size_t mask = slots.size() - 1;
+  size_t slot = hash(name) & mask;
+  for (; slots[slot] != NO_ATOM; slot = (slot + 1) & mask) {
+    if (names[slots[slot]] == name) {
+      return slots[slot];
+    }
+  }
+
+  char* copy = static_cast<char*>(storage.allocate(name.size() + 1, 1));
+  std::memcpy(copy, name.data(), name.size());
+  copy[name.size()] = '\0';
+  Atom atom = static_cast<Atom>(names.size());
+  names.emplace_back(copy, name.size());
+  slots[slot] = atom;
+
+  // keep the load under one half
+  if (names.size() * 2 > slots.size()) {
+    grow();
+  }
+
+  // calls to special functions find them by the atom of the token after the '$', without building the name
+  if (name.size() > 1 && name[0] == '$') {
+    Atom plain = intern(name.substr(1));
+    if (specials.size() <= plain) {
+      specials.resize(plain + 1, NO_ATOM);
+    }
+    specials[plain] = atom;
+  }
+  return atom;
+}
+
+void AtomTable::grow() {
+  std::vector<Atom> grown(slots.size() * 2, NO_ATOM);
+  size_t mask = grown.size() - 1;
+  for (Atom atom = 1; atom < names.size(); atom++) {
+    size_t slot = hash(names[atom]) & mask;
+    while (grown[slot] != NO_ATOM) {
+      slot = (slot + 1) & mask;
+    }
+    grown[slot] = atom;
+  }
+  slots = std::move(grown);
+}
@@ -0,0 +1,140 @@
+#ifndef ATOM_TABLE_H
+#define ATOM_TABLE_H
+
+#include "../arena.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// an interned name, equal atoms are equal names
+using Atom = uint32_t;
+constexpr Atom NO_ATOM = 0;
+
+// interns names to small integers, one table per compilation
+// identifiers are interned once by the token factory while lexing, so the semantic passes look names up by atom and
+// never build or hash the string again. the characters are copied into the table, names outlive the source
+class AtomTable {
+public:
+  AtomTable();
+  AtomTable(const AtomTable&) = delete;
+  AtomTable& operator=(const AtomTable&) = delete;
+
+  Atom intern(std::string_view name);
+  // NO_ATOM if the name was never interned, so nothing can be declared under it either
+  Atom find(std::string_view name) const;
+  std::string_view getName(Atom atom) const { return names[atom]; }
+  // the atom of "$" + the name of the given atom (a special function like $toString), NO_ATOM if that was never
+  // interned. special names get their entry when they are interned, which symbol collection does once per definition
+  Atom special(Atom name) const { return name < specials.size() ? specials[name] : NO_ATOM; }
+  // number of atoms, including NO_ATOM
+  size_t size() const { return names.size(); }
+
+private:
+  Arena storage{16 * 1024};
+  // indexed by atom, names[NO_ATOM] is empty
+  std::vector<std::string_view> names;
+  // open addressing with linear probing, NO_ATOM marks an empty slot, the size is a power of two
+  std::vector<Atom> slots;
+  // indexed by the atom of the unprefixed name
+  std::vector<Atom> specials;
+
+  static uint64_t hash(std::string_view name);
+  void grow();
+};
+
+// small map from atoms to values: the entries stay in insertion order, with an open addressing index over them
+// scopes hold a few symbols each, so probing a short array beats hashing strings in an unordered_map
+template <typename V> class AtomMap {
+public:
+  using Entry = std::pair<Atom, V>;
+
+  V* find(Atom atom) {
+    int32_t entry = lookup(atom);
+    return entry < 0 ? nullptr : &entries[entry].second;
+  }
+  const V* find(Atom atom) const {
+    int32_t entry = lookup(atom);
+    return entry < 0 ? nullptr : &entries[entry].second;
+  }
+  bool contains(Atom atom) const { return lookup(atom) >= 0; }
+
+  // false if the atom already has a value, which is left alone
+  bool insert(Atom atom, V value) {
+    if (contains(atom)) {
+      return false;
+    }
+    add(atom, std::move(value));
+    return true;
+  }
+
+  V& operator[](Atom atom) {
+    int32_t entry = lookup(atom);
+    if (entry >= 0) {
+      return entries[entry].second;
+    }
+    return add(atom, V());
+  }
+
+  bool empty() const { return entries.empty(); }
+  size_t size() const { return entries.size(); }
+  typename std::vector<Entry>::const_iterator begin() const { return entries.begin(); }
+  typename std::vector<Entry>::const_iterator end() const { return entries.end(); }
+
+private:
+  std::vector<Entry> entries;
+  // entry index per slot, -1 for empty, only built once there are enough entries for a scan to be slower
+  std::vector<int32_t> index;
+  static constexpr size_t SCAN_LIMIT = 8;
+
+  int32_t lookup(Atom atom) const {
+    if (index.empty()) {
+      for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].first == atom) {
+          return static_cast<int32_t>(i);
+        }
+      }
+      return -1;
+    }
+    size_t mask = index.size() - 1;
+    for (size_t slot = atom & mask;; slot = (slot + 1) & mask) {
+      int32_t entry = index[slot];
+      if (entry < 0 || entries[entry].first == atom) {
+        return entry;
+      }
+    }
+  }
+
+  V& add(Atom atom, V value) {
+    entries.emplace_back(atom, std::move(value));
+    if (entries.size() > SCAN_LIMIT && entries.size() * 2 > index.size()) {
+      rebuildIndex();
+    } else if (!index.empty()) {
+      place(entries.size() - 1);
+    }
+    return entries.back().second;
+  }
+
+  void rebuildIndex() {
+    size_t capacity = 16;
+    while (capacity < entries.size() * 4) {
+      capacity *= 2;
+    }
+    index.assign(capacity, -1);
+    for (size_t i = 0; i < entries.size(); i++) {
+      place(i);
+    }
+  }
+
+  void place(size_t entry) {
+    size_t mask = index.size() - 1;
+    size_t slot = entries[entry].first & mask;
+    while (index[slot] >= 0) {
+      slot = (slot + 1) & mask;
+    }
+    index[slot] = static_cast<int32_t>(entry);
+  }
+};
+
+#endif // ATOM_TABLE_H
@@ -0,0 +1,83 @@
+#include "function_signature.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+std::string mangle(const std::string& name, const std::vector<Type*>& parameterTypes) {
+  std::string mangledName = name;
+  mangledName += "_";
+  for (auto type : parameterTypes) {
+    mangledName += type ? type->toString() : "unknown";
+    mangledName += "_";
+  }
+  // replace all [] with __, JVM doesn't like [] in method names
+  std::replace(mangledName.begin(), mangledName.end(), '[', '_');
+  std::replace(mangledName.begin(), mangledName.end(), ']', '_');
+  return mangledName;
+}
+
+} // namespace
+
+FunctionSignature::FunctionSignature(const std::string& name, std::vector<Type*> parameterTypes, Type* returnType)
+    : parameterTypes(std::move(parameterTypes)), hash(hashTypes(this->parameterTypes)),
+      mangledName(mangle(name, this->parameterTypes)) {
+  if (name == "main") {
+    jvmParameterTypes.push_back("[java/lang/String");
+  } else {
+    for (auto type : this->parameterTypes) {
+      jvmParameterTypes.push_back(jvmType(type));
+    }
+  }
+  jvmReturnType = returnType && name != "<init>" ? jvmType(returnType) : "V";
+
+  descriptor = "(";
+  for (size_t i = 0; i < jvmParameterTypes.size(); i++) {
+    if (i > 0) {
+      descriptor += ", ";
+    }
+    descriptor += jvmParameterTypes[i];
+  }
+  descriptor += ")" + jvmReturnType;
+}
+
+bool FunctionSignature::matches(const std::vector<Type*>& argTypes) const {
+  if (argTypes != parameterTypes) {
+    return false;
+  }
+  return std::find(argTypes.begin(), argTypes.end(), nullptr) == argTypes.end();
+}
+
+size_t FunctionSignature::hashTypes(const std::vector<Type*>& types) {
+  size_t hash = types.size();
+  for (auto type : types) {
+    hash = hash * 31 + std::hash<Type*>()(type);
+  }
+  return hash;
+}
+
+std::string FunctionSignature::jvmType(Type* type) {
+  switch (type->getKind()) {
+  case Type::TypeKind::PRIMITIVE:
+    switch (static_cast<PrimitiveType*>(type)->getPrimitiveKind()) {
+    case PrimitiveType::PrimitiveKind::INT:
+      return "I";
+    case PrimitiveType::PrimitiveKind::FLOAT:
+      return "F";
+    case PrimitiveType::PrimitiveKind::STRING:
+      return "java/lang/String";
+    case PrimitiveType::PrimitiveKind::BOOLEAN:
+      return "Z";
+    case PrimitiveType::PrimitiveKind::VOID:
+      return "V";
+    default:
+      throw std::runtime_error("Unsupported right now");
+    }
+  case Type::TypeKind::ARRAY:
+    return "[" + jvmType(static_cast<ArrayType*>(type)->getElementType());
+  default:
+    // pointers and structs are named like in the source
+    return type->toString();
+  }
+}
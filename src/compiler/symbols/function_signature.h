@@ -0,0 +1,40 @@
+#ifndef FUNCTION_SIGNATURE_H
+#define FUNCTION_SIGNATURE_H
+
+#include "type.h"
+#include <string>
+#include <vector>
+
+// everything derived from a function's parameter and return types, built once when the function is registered and
+// never changed after. types are canonical (see TypeTable), so the hash is over the type pointers
+class FunctionSignature {
+public:
+  FunctionSignature(const std::string& name, std::vector<Type*> parameterTypes, Type* returnType);
+
+  const std::vector<Type*>& getParameterTypes() const { return parameterTypes; }
+  size_t getArity() const { return parameterTypes.size(); }
+  size_t getHash() const { return hash; }
+  // name plus parameter types, unique among a scope's functions
+  const std::string& getMangledName() const { return mangledName; }
+  // jasm style types, main takes a String[] and constructors return void
+  const std::vector<std::string>& getJVMParameterTypes() const { return jvmParameterTypes; }
+  const std::string& getJVMReturnType() const { return jvmReturnType; }
+  // (I, java/lang/String)V
+  const std::string& getDescriptor() const { return descriptor; }
+
+  // exactly these types, an unknown (null) type matches nothing
+  bool matches(const std::vector<Type*>& argTypes) const;
+
+  static size_t hashTypes(const std::vector<Type*>& types);
+  static std::string jvmType(Type* type);
+
+private:
+  const std::vector<Type*> parameterTypes;
+  const size_t hash;
+  const std::string mangledName;
+  std::vector<std::string> jvmParameterTypes;
+  std::string jvmReturnType;
+  std::string descriptor;
+};
+
+#endif // FUNCTION_SIGNATURE_H
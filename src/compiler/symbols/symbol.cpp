@@ -1,36 +1,34 @@
 #include "symbol.h"
-#include <algorithm>
+#include <stdexcept>
 
-Symbol::Symbol(const std::string& name, SymbolType type, int line, int column, std::shared_ptr<Scope> scope)
+Symbol::Symbol(const std::string& name, SymbolType type, int line, int column, Scope* scope)
     : name(name), type(type), definedAtLine(line), definedAtColumn(column), isDefined(false), scope(scope) {}
 
-VariableSymbol::VariableSymbol(const std::string& name, int line, int column, std::shared_ptr<Scope> scope,
-                               bool isConst, bool isStructMember)
+VariableSymbol::VariableSymbol(const std::string& name, int line, int column, Scope* scope, bool isConst,
+                               bool isStructMember)
     : Symbol(name, SymbolType::VARIABLE, line, column, scope), isConstant(isConst), isStructMember(isStructMember) {}
 
-TypeSymbol::TypeSymbol(const std::string& name, int line, int column, std::shared_ptr<Scope> scope)
+TypeSymbol::TypeSymbol(const std::string& name, int line, int column, Scope* scope)
     : Symbol(name, SymbolType::TYPE, line, column, scope) {}
 
-FunctionSymbol::FunctionSymbol(const std::string& name, int line, int column, std::shared_ptr<Scope> scope)
+FunctionSymbol::FunctionSymbol(const std::string& name, int line, int column, Scope* scope)
     : Symbol(name, SymbolType::FUNCTION, line, column, scope) {}
 
-std::string FunctionSymbol::getMangledName() const {
-  std::string mangledName = name;
-  mangledName += "_";
-
+void FunctionSymbol::seal() {
+  std::vector<Type*> parameterTypes;
+  parameterTypes.reserve(parameters.size());
   for (const auto& param : parameters) {
-    if (param->dataType) {
-      mangledName += param->dataType->toString();
-    } else {
-      mangledName += "unknown";
-    }
-    mangledName += "_";
+    parameterTypes.push_back(param->dataType);
   }
-  // replace all [] with __, JVM doesn't like [] in method names
-  std::replace(mangledName.begin(), mangledName.end(), '[', '_');
-  std::replace(mangledName.begin(), mangledName.end(), ']', '_');
+  Type* returnType = returnTypes.empty() ? nullptr : returnTypes[0];
+  signature = std::make_shared<const FunctionSignature>(name, std::move(parameterTypes), returnType);
+}
 
-  return mangledName;
+const FunctionSignature& FunctionSymbol::getSignature() const {
+  if (!signature) {
+    throw std::runtime_error("signature of function " + name + " used before it was sealed");
+  }
+  return *signature;
 }
 
 bool FunctionSymbol::canOverloadWith(const FunctionSymbol& other) const {
@@ -46,7 +44,7 @@ bool FunctionSymbol::canOverloadWith(const FunctionSymbol& other) const {
       return false;
     }
 
-    if (thisType->toString() != otherType->toString()) {
+    if (thisType != otherType) {
       return true;
     }
   }
@@ -54,117 +52,139 @@ bool FunctionSymbol::canOverloadWith(const FunctionSymbol& other) const {
   return false;
 }
 
-Scope::Scope(std::shared_ptr<Scope> parent) : parent(parent) {}
+Scope::Scope(Scope* parent, std::shared_ptr<AtomTable> atoms) : parent(parent), atoms(atoms) {
+  if (parent != nullptr) {
+    this->atoms = parent->atoms;
+    depth = parent->depth + 1;
+    parent->children.push_back(this);
+  } else if (this->atoms == nullptr) {
+    this->atoms = std::make_shared<AtomTable>();
+  }
+}
 
-std::shared_ptr<Symbol> Scope::resolve(const std::string& name) {
-  auto it = symbols.find(name);
-  if (it != symbols.end()) {
-    return it->second;
+Symbol* Scope::resolveHere(Atom name) const {
+  if (const auto* symbol = symbols.find(name)) {
+    return *symbol;
   }
 
-  auto overloadIt = functionOverloads.find(name);
-  if (overloadIt != functionOverloads.end() && !overloadIt->second.empty()) {
-    return overloadIt->second.front();
+  const auto* overloads = functionOverloads.find(name);
+  if (overloads != nullptr && !overloads->empty()) {
+    return overloads->front();
   }
+  return nullptr;
+}
 
-  if (parent != nullptr) {
-    return parent->resolve(name);
+Symbol* Scope::resolve(Atom name) {
+  if (name == NO_ATOM) {
+    return nullptr;
   }
 
+  Scope* scope = this;
+  if (flattened) {
+    if (const auto* symbol = visible.find(name)) {
+      return *symbol;
+    }
+    // everything below the global scope was in visible
+    while (scope->parent != nullptr) {
+      scope = scope->parent;
+    }
+  }
+  for (; scope != nullptr; scope = scope->parent) {
+    if (auto symbol = scope->resolveHere(name)) {
+      return symbol;
+    }
+  }
   return nullptr;
 }
 
-bool Scope::add(std::shared_ptr<Symbol> symbol) {
-  if (symbol->type == SymbolType::FUNCTION) {
-    return addFunction(std::dynamic_pointer_cast<FunctionSymbol>(symbol));
+Symbol* Scope::resolve(std::string_view name) { return resolve(atoms->find(name)); }
+
+void Scope::flatten() {
+  visible = AtomMap<Symbol*>();
+  // nearest scope first, so insert keeps the symbol resolve would have found
+  for (Scope* scope = this; scope->parent != nullptr; scope = scope->parent) {
+    for (const auto& [name, symbol] : scope->symbols) {
+      visible.insert(name, symbol);
+    }
+    for (const auto& [name, overloads] : scope->functionOverloads) {
+      if (!overloads.empty()) {
+        visible.insert(name, overloads.front());
+      }
+    }
   }
-  if (symbols.find(symbol->name) != symbols.end()) {
-    return false;
+  flattened = true;
+}
+
+bool Scope::add(Symbol* symbol) {
+  if (symbol->type == SymbolType::FUNCTION) {
+    return addFunction(dynamic_cast<FunctionSymbol*>(symbol));
   }
-  symbols[symbol->name] = symbol;
-  return true;
+  return symbols.insert(atoms->intern(symbol->name), symbol);
 }
 
-bool Scope::addFunction(std::shared_ptr<FunctionSymbol> functionSymbol) {
+bool Scope::addFunction(FunctionSymbol* functionSymbol) {
+  if (!functionSymbol->isSealed()) {
+    functionSymbol->seal();
+  }
+  const auto& signature = functionSymbol->getSignature();
   // always use the mangled name for storing functions
-  std::string mangledName = functionSymbol->getMangledName();
-
-  if (symbols.find(mangledName) != symbols.end()) {
+  if (!symbols.insert(atoms->intern(signature.getMangledName()), functionSymbol)) {
     return false;
   }
-  symbols[mangledName] = functionSymbol;
-  functionOverloads[functionSymbol->name].push_back(functionSymbol);
+  Atom name = atoms->intern(functionSymbol->name);
+  functionOverloads[name].push_back(functionSymbol);
+  overloadIndex.emplace(OverloadKey{name, signature.getArity(), signature.getHash()}, functionSymbol);
+  firstOverloadOfArity.emplace(OverloadKey{name, signature.getArity(), 0}, functionSymbol);
 
   return true;
 }
 
-std::shared_ptr<FunctionSymbol> Scope::resolveFunctionCall(const std::string& name,
-                                                           const std::vector<std::shared_ptr<Type>>& argTypes) {
-  // get all function overloads for this name
-  auto overloadIt = functionOverloads.find(name);
-  if (overloadIt == functionOverloads.end()) {
+FunctionSymbol* Scope::resolveFunctionCall(std::string_view name, const std::vector<Type*>& argTypes) {
+  return resolveFunctionCall(atoms->find(name), argTypes);
+}
+
+FunctionSymbol* Scope::resolveFunctionCall(Atom name, const std::vector<Type*>& argTypes) {
+  const auto* overloadList = functionOverloads.find(name);
+  if (overloadList == nullptr) {
     if (parent) {
       return parent->resolveFunctionCall(name, argTypes);
     }
     return nullptr;
   }
 
-  const auto& overloads = overloadIt->second;
-  std::shared_ptr<FunctionSymbol> bestMatch = nullptr;
-
-  for (const auto& func : overloads) {
-    if (func->parameters.size() != argTypes.size()) {
-      continue;
+  auto exact = overloadIndex.find(OverloadKey{name, argTypes.size(), FunctionSignature::hashTypes(argTypes)});
+  if (exact != overloadIndex.end()) {
+    if (exact->second->getSignature().matches(argTypes)) {
+      return exact->second;
     }
-
-    bool isMatch = true;
-    for (size_t i = 0; i < argTypes.size(); i++) {
-      if (!argTypes[i] || !func->parameters[i]->dataType) {
-        isMatch = false;
-        break;
-      }
-
-      if (argTypes[i]->toString() != func->parameters[i]->dataType->toString()) {
-        isMatch = false;
-        break;
-      }
-    }
-
-    if (isMatch) {
-      bestMatch = func;
-      break;
-    }
-  }
-
-  if (!bestMatch) {
-    for (const auto& func : overloads) {
-      // Still require parameter count to match
-      if (func->parameters.size() != argTypes.size()) {
-        continue;
+    // two signatures with the same hash, only the first is indexed
+    for (const auto& func : *overloadList) {
+      if (func->getSignature().matches(argTypes)) {
+        return func;
       }
-
-      bestMatch = func;
-      break;
     }
   }
 
-  return bestMatch;
+  // no exact match, still require the parameter count to match
+  auto sameArity = firstOverloadOfArity.find(OverloadKey{name, argTypes.size(), 0});
+  return sameArity != firstOverloadOfArity.end() ? sameArity->second : nullptr;
 }
 
-bool Scope::isTypeCompatible(const std::shared_ptr<Type>& sourceType, const std::shared_ptr<Type>& targetType) {
-  if (sourceType->toString() == targetType->toString()) {
+bool Scope::isTypeCompatible(Type* sourceType, Type* targetType) {
+  // types are canonical, see TypeTable
+  if (sourceType == targetType) {
     return true;
   }
 
   // check for pointer compatibility
-  auto sourcePointer = std::dynamic_pointer_cast<PointerType>(sourceType);
-  auto targetPointer = std::dynamic_pointer_cast<PointerType>(targetType);
+  auto sourcePointer = typeCast<PointerType>(sourceType);
+  auto targetPointer = typeCast<PointerType>(targetType);
   if (sourcePointer && targetPointer) {
     // allow void* assignable to any pointer
     auto targetPointedType = targetPointer->getPointedType();
     auto sourcePointedType = sourcePointer->getPointedType();
 
-    auto sourcePrim = std::dynamic_pointer_cast<PrimitiveType>(sourcePointedType);
+    auto sourcePrim = typeCast<PrimitiveType>(sourcePointedType);
     if (sourcePrim && sourcePrim->getPrimitiveKind() == PrimitiveType::PrimitiveKind::VOID) {
       return true;
     }
@@ -174,8 +194,8 @@ bool Scope::isTypeCompatible(const std::shared_ptr<Type>& sourceType, const std:
   }
 
   // check for numeric compatibility
-  auto sourcePrim = std::dynamic_pointer_cast<PrimitiveType>(sourceType);
-  auto targetPrim = std::dynamic_pointer_cast<PrimitiveType>(targetType);
+  auto sourcePrim = typeCast<PrimitiveType>(sourceType);
+  auto targetPrim = typeCast<PrimitiveType>(targetType);
   if (sourcePrim && targetPrim) {
     // allow conversion between numeric types
     return sourcePrim->isNumeric() && targetPrim->isNumeric();
@@ -2,9 +2,12 @@
 #define SYMBOL_H
 
 #include "../instructions/ir_instruction.h"
+#include "atom_table.h"
+#include "function_signature.h"
 #include "type.h"
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -12,9 +15,16 @@ enum class SymbolType { VARIABLE, FUNCTION, STRUCT, PARAMETER, TYPE };
 
 class Scope;
 
+namespace antlr4 {
+class ParserRuleContext;
+}
+
+// scopes, symbols and types are owned by the ObjectArena of the compilation that created them, and every pointer
+// between them (a symbol's scope, a scope's parent and children, a struct's member scope and type) is non-owning, so
+// cycles in the graph cost nothing and all of it goes away with the arena
 class Symbol {
 public:
-  Symbol(const std::string& name, SymbolType type, int line, int column, std::shared_ptr<Scope> scope);
+  Symbol(const std::string& name, SymbolType type, int line, int column, Scope* scope);
   virtual ~Symbol() = default;
 
   std::string name;
@@ -24,15 +34,15 @@ public:
   bool isDefined = false;
   bool isPrivate = false;
   bool isBuiltin = false;
-  std::shared_ptr<Scope> scope;
+  Scope* scope = nullptr;
 };
 
 class VariableSymbol : public Symbol {
 public:
-  VariableSymbol(const std::string& name, int line, int column, std::shared_ptr<Scope> scope, bool isConst = false,
+  VariableSymbol(const std::string& name, int line, int column, Scope* scope, bool isConst = false,
                  bool isStructMember = false);
-  std::shared_ptr<Type> dataType;
-  std::shared_ptr<TypeSymbol> parentStructType;
+  Type* dataType = nullptr;
+  TypeSymbol* parentStructType = nullptr;
   bool isConstant;
   bool isStructMember;
   bool hasDefaultValue = false;
@@ -41,42 +51,95 @@ public:
 
 class TypeSymbol : public Symbol {
 public:
-  TypeSymbol(const std::string& name, int line, int column, std::shared_ptr<Scope> scope);
+  TypeSymbol(const std::string& name, int line, int column, Scope* scope);
 
-  std::shared_ptr<Scope> memberScope;
-  std::shared_ptr<Type> typeRepresentation;
+  Scope* memberScope = nullptr;
+  Type* typeRepresentation = nullptr;
 };
 
 class FunctionSymbol : public Symbol {
 public:
-  FunctionSymbol(const std::string& name, int line, int column, std::shared_ptr<Scope> scope);
+  FunctionSymbol(const std::string& name, int line, int column, Scope* scope);
   bool isStructMethod = false;
-  std::vector<std::shared_ptr<VariableSymbol>> parameters;
-  std::vector<std::shared_ptr<Type>> returnTypes;
+  std::vector<VariableSymbol*> parameters;
+  std::vector<Type*> returnTypes;
   std::vector<std::shared_ptr<IRInstruction>> instructions;
 
+  // builds the signature from parameters and returnTypes, which must not change after. done when the function is
+  // added to a scope, copies of a sealed function share its signature
+  void seal();
+  bool isSealed() const { return signature != nullptr; }
+  const FunctionSignature& getSignature() const;
   // includes parameter types to avoid name collisions
-  std::string getMangledName() const;
+  const std::string& getMangledName() const { return getSignature().getMangledName(); }
   bool canOverloadWith(const FunctionSymbol& other) const;
+
+private:
+  std::shared_ptr<const FunctionSignature> signature;
 };
 
 class Scope {
 public:
-  Scope(std::shared_ptr<Scope> parent);
+  // a scope shares the atoms of its parent, a root scope uses the given table or makes its own
+  Scope(Scope* parent, std::shared_ptr<AtomTable> atoms = nullptr);
   ~Scope() = default;
+  // registered with its parent on construction, a copy wouldn't be
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+  Symbol* resolve(Atom name);
+  // for names that don't come from an identifier token, looks the atom up without copying the name
+  Symbol* resolve(std::string_view name);
+  bool add(Symbol* symbol);
+  bool addFunction(FunctionSymbol* functionSymbol);
+  FunctionSymbol* resolveFunctionCall(Atom name, const std::vector<Type*>& argTypes);
+  FunctionSymbol* resolveFunctionCall(std::string_view name, const std::vector<Type*>& argTypes);
+
+  bool isTypeCompatible(Type* sourceType, Type* targetType);
+
+  // copies everything visible from the scopes between this one and the global scope into one table, so a lookup
+  // from a deeply nested block is one probe plus the global scope's. only valid once those scopes are complete
+  void flatten();
+  int getDepth() const { return depth; }
+
+  AtomTable& getAtoms() const { return *atoms; }
+  std::string_view getName(Atom atom) const { return atoms->getName(atom); }
+
+  Scope* parent = nullptr;
+  // the scopes opened inside this one, in the order they were created (source order for the program's scopes)
+  std::vector<Scope*> children;
+  // the node that opened this scope, null for the global scope and the ones made up by the compiler
+  antlr4::ParserRuleContext* definingContext = nullptr;
+  std::shared_ptr<AtomTable> atoms;
+  // functions are stored under their mangled name, and by name in functionOverloads
+  AtomMap<Symbol*> symbols;
+  AtomMap<std::vector<FunctionSymbol*>> functionOverloads;
+  std::unordered_map<std::string, Symbol*> unresolved;
 
-  std::shared_ptr<Symbol> resolve(const std::string& name);
-  bool add(std::shared_ptr<Symbol> symbol);
-  bool addFunction(std::shared_ptr<FunctionSymbol> functionSymbol);
-  std::shared_ptr<FunctionSymbol> resolveFunctionCall(const std::string& name,
-                                                      const std::vector<std::shared_ptr<Type>>& argTypes);
+private:
+  struct OverloadKey {
+    Atom name;
+    size_t arity;
+    size_t hash;
+    bool operator==(const OverloadKey& other) const {
+      return name == other.name && arity == other.arity && hash == other.hash;
+    }
+  };
+  struct OverloadKeyHash {
+    size_t operator()(const OverloadKey& key) const { return (key.hash * 31 + key.arity) * 31 + key.name; }
+  };
+  // functions by (name, arity, parameter type hash), and the first one declared per (name, arity) with hash 0, which
+  // a call falls back to when no overload matches its argument types exactly
+  std::unordered_map<OverloadKey, FunctionSymbol*, OverloadKeyHash> overloadIndex;
+  std::unordered_map<OverloadKey, FunctionSymbol*, OverloadKeyHash> firstOverloadOfArity;
 
-  bool isTypeCompatible(const std::shared_ptr<Type>& sourceType, const std::shared_ptr<Type>& targetType);
+  int depth = 0;
+  bool flattened = false;
+  // with flattened set, the first symbol of every name from here up to the global scope (excluded)
+  AtomMap<Symbol*> visible;
 
-  std::shared_ptr<Scope> parent;
-  std::unordered_map<std::string, std::shared_ptr<Symbol>> symbols;
-  std::unordered_map<std::string, std::vector<std::shared_ptr<FunctionSymbol>>> functionOverloads;
-  std::unordered_map<std::string, std::shared_ptr<Symbol>> unresolved;
+  // this scope alone
+  Symbol* resolveHere(Atom name) const;
 };
 
 #endif // SYMBOL_H
@@ -46,68 +46,32 @@ std::string PrimitiveType::toString() const {
   }
 }
 
-bool PrimitiveType::equals(const std::shared_ptr<Type>& other) const {
-  if (other->getKind() != TypeKind::PRIMITIVE) {
-    return false;
-  }
-
-  auto otherPrimitive = std::dynamic_pointer_cast<PrimitiveType>(other);
-  return primitiveKind == otherPrimitive->primitiveKind;
-}
-
-UserDefinedType::UserDefinedType(std::shared_ptr<TypeSymbol> typeSymbol)
+UserDefinedType::UserDefinedType(TypeSymbol* typeSymbol)
     : Type(TypeKind::USER_DEFINED), typeSymbol(typeSymbol) {}
 
-std::shared_ptr<TypeSymbol> UserDefinedType::getTypeSymbol() const { return typeSymbol; }
-
-bool UserDefinedType::equals(const std::shared_ptr<Type>& other) const {
-  if (other->getKind() != TypeKind::USER_DEFINED) {
-    return false;
-  }
-
-  auto otherUserDefined = std::dynamic_pointer_cast<UserDefinedType>(other);
-  return typeSymbol == otherUserDefined->typeSymbol;
-}
+TypeSymbol* UserDefinedType::getTypeSymbol() const { return typeSymbol; }
 
 std::string UserDefinedType::toString() const { return typeSymbol ? typeSymbol->name : "unknown"; }
 
-ArrayType::ArrayType(std::shared_ptr<Type> elementType) : Type(TypeKind::ARRAY), elementType(elementType) {}
+ArrayType::ArrayType(Type* elementType) : Type(TypeKind::ARRAY), elementType(elementType) {}
 
-std::shared_ptr<Type> ArrayType::getElementType() const { return elementType; }
-
-bool ArrayType::equals(const std::shared_ptr<Type>& other) const {
-  if (other->getKind() != TypeKind::ARRAY) {
-    return false;
-  }
-
-  auto otherArray = std::dynamic_pointer_cast<ArrayType>(other);
-  return elementType->equals(otherArray->elementType);
-}
+Type* ArrayType::getElementType() const { return elementType; }
 
 int ArrayType::getDimensions() const {
   if (elementType->getKind() == TypeKind::ARRAY) {
-    return 1 + std::dynamic_pointer_cast<ArrayType>(elementType)->getDimensions();
+    return 1 + typeCast<ArrayType>(elementType)->getDimensions();
   }
   return 1;
 }
 
 std::string ArrayType::toString() const { return elementType->toString() + "[]"; }
 
-PointerType::PointerType(std::shared_ptr<Type> pointeeType) : Type(TypeKind::POINTER), pointeeType(pointeeType) {}
+PointerType::PointerType(Type* pointeeType) : Type(TypeKind::POINTER), pointeeType(pointeeType) {}
 
-std::shared_ptr<Type> PointerType::getPointedType() const { return pointeeType; }
-
-bool PointerType::equals(const std::shared_ptr<Type>& other) const {
-  if (other->getKind() != TypeKind::POINTER) {
-    return false;
-  }
-
-  auto otherPointer = std::dynamic_pointer_cast<PointerType>(other);
-  return pointeeType->equals(otherPointer->pointeeType);
-}
+Type* PointerType::getPointedType() const { return pointeeType; }
 
 std::string PointerType::toString() const {
-  auto primitiveType = std::dynamic_pointer_cast<PrimitiveType>(pointeeType);
+  auto primitiveType = typeCast<PrimitiveType>(pointeeType);
   if (!primitiveType) {
     throw std::runtime_error("Unknown primitive kind");
   }
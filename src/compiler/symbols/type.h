@@ -17,7 +17,8 @@ public:
   virtual ~Type() = default;
   TypeKind getKind() const;
   virtual std::string toString() const = 0;
-  virtual bool equals(const std::shared_ptr<Type>& other) const { return kind == other->getKind(); }
+  // types come from a TypeTable, which has exactly one object per type
+  bool equals(const Type* other) const { return this == other; }
 
 private:
   TypeKind kind;
@@ -25,6 +26,8 @@ private:
 
 class PrimitiveType : public Type {
 public:
+  static constexpr TypeKind KIND = TypeKind::PRIMITIVE;
+
   enum class PrimitiveKind {
     INT,
     FLOAT,
@@ -38,7 +41,6 @@ public:
   bool isNumeric() const;
   bool isInteger() const;
   std::string toString() const override;
-  bool equals(const std::shared_ptr<Type>& other) const override;
 
 private:
   PrimitiveKind primitiveKind;
@@ -47,40 +49,45 @@ private:
 
 class UserDefinedType : public Type {
 public:
-  UserDefinedType(std::shared_ptr<TypeSymbol> typeSymbol);
-  std::shared_ptr<TypeSymbol> getTypeSymbol() const;
+  static constexpr TypeKind KIND = TypeKind::USER_DEFINED;
+
+  UserDefinedType(TypeSymbol* typeSymbol);
+  TypeSymbol* getTypeSymbol() const;
   std::string toString() const override;
-  bool equals(const std::shared_ptr<Type>& other) const override;
 
 private:
-  std::shared_ptr<TypeSymbol> typeSymbol;
+  TypeSymbol* typeSymbol = nullptr;
 };
 
 class ArrayType : public Type {
 public:
-  ArrayType(std::shared_ptr<Type> elementType);
-  std::shared_ptr<Type> getElementType() const;
+  static constexpr TypeKind KIND = TypeKind::ARRAY;
+
+  ArrayType(Type* elementType);
+  Type* getElementType() const;
   std::string toString() const override;
-  bool equals(const std::shared_ptr<Type>& other) const override;
   int getDimensions() const;
 
 private:
-  std::shared_ptr<Type> elementType;
+  Type* elementType = nullptr;
 };
 
 class PointerType : public Type {
 public:
-  PointerType(std::shared_ptr<Type> pointeeType);
-  std::shared_ptr<Type> getPointedType() const;
-  bool equals(const std::shared_ptr<Type>& other) const override;
+  static constexpr TypeKind KIND = TypeKind::POINTER;
+
+  PointerType(Type* pointeeType);
+  Type* getPointedType() const;
   std::string toString() const override;
 
 private:
-  std::shared_ptr<Type> pointeeType;
+  Type* pointeeType = nullptr;
 };
 
 class UnresolvedType : public Type {
 public:
+  static constexpr TypeKind KIND = TypeKind::UNRESOLVED;
+
   UnresolvedType(const std::string& name);
   std::string getName() const;
   std::string toString() const override;
@@ -89,4 +96,13 @@ private:
   std::string name;
 };
 
+// checked downcast from the kind tag instead of an RTTI walk, null if type is null or isn't a T (like dynamic_cast)
+template <typename T> T* typeCast(Type* type) {
+  return type != nullptr && type->getKind() == T::KIND ? static_cast<T*>(type) : nullptr;
+}
+
+template <typename T> const T* typeCast(const Type* type) {
+  return type != nullptr && type->getKind() == T::KIND ? static_cast<const T*>(type) : nullptr;
+}
+
 #endif // TYPE_H
@@ -0,0 +1,40 @@
+#include "type_table.h"
+
+PrimitiveType* TypeTable::primitive(PrimitiveType::PrimitiveKind kind) {
+  // indexed by PrimitiveKind
+  static PrimitiveType primitives[] = {
+      PrimitiveType(PrimitiveType::PrimitiveKind::INT),
+      PrimitiveType(PrimitiveType::PrimitiveKind::FLOAT),
+      PrimitiveType(PrimitiveType::PrimitiveKind::BOOLEAN),
+      PrimitiveType(PrimitiveType::PrimitiveKind::STRING),
+      PrimitiveType(PrimitiveType::PrimitiveKind::VOID),
+  };
+  return &primitives[static_cast<size_t>(kind)];
+}
+
+ArrayType* TypeTable::arrayOf(Type* elementType) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& arrayType = arrayTypes[elementType];
+  if (!arrayType) {
+    arrayType = objects.create<ArrayType>(elementType);
+  }
+  return arrayType;
+}
+
+PointerType* TypeTable::pointerTo(Type* pointeeType) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& pointerType = pointerTypes[pointeeType];
+  if (!pointerType) {
+    pointerType = objects.create<PointerType>(pointeeType);
+  }
+  return pointerType;
+}
+
+UserDefinedType* TypeTable::userDefined(TypeSymbol* typeSymbol) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& userDefinedType = userDefinedTypes[typeSymbol];
+  if (!userDefinedType) {
+    userDefinedType = objects.create<UserDefinedType>(typeSymbol);
+  }
+  return userDefinedType;
+}
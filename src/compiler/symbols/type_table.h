@@ -0,0 +1,36 @@
+#ifndef TYPE_TABLE_H
+#define TYPE_TABLE_H
+
+#include "../arena.h"
+#include "type.h"
+#include <mutex>
+#include <unordered_map>
+
+// hands out one canonical Type object per distinct type, so two types are the same exactly when they are the same
+// object and comparing them is a pointer compare
+//
+// primitives are shared by the whole process (they never change, so batch workers can share them too), array,
+// pointer and struct types belong to one compilation's table and live in its arena. composite types are keyed by
+// their (already canonical) element type, so looking one up never builds a string
+//
+// type checking runs function bodies on several threads, so handing out a composite type takes a lock
+class TypeTable {
+public:
+  explicit TypeTable(ObjectArena& objects) : objects(objects) {}
+
+  static PrimitiveType* primitive(PrimitiveType::PrimitiveKind kind);
+
+  ArrayType* arrayOf(Type* elementType);
+  PointerType* pointerTo(Type* pointeeType);
+  // a struct's type, one per struct symbol
+  UserDefinedType* userDefined(TypeSymbol* typeSymbol);
+
+private:
+  ObjectArena& objects;
+  std::mutex mutex;
+  std::unordered_map<const Type*, ArrayType*> arrayTypes;
+  std::unordered_map<const Type*, PointerType*> pointerTypes;
+  std::unordered_map<const TypeSymbol*, UserDefinedType*> userDefinedTypes;
+};
+
+#endif // TYPE_TABLE_H
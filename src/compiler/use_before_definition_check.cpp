@@ -0,0 +1,97 @@
+#include "use_before_definition_check.h"
+#include <cgullParser.h>
+#include <string>
+
+namespace {
+
+Symbol* resolveIdentifier(Scope* scope, Atom identifier) {
+  return scope != nullptr && identifier != NO_ATOM ? scope->resolve(identifier) : nullptr;
+}
+
+void reportIfUndefined(const FlatAst& ast, size_t id, Scope* scope, const char* what, ErrorReporter& errorReporter) {
+  Atom identifier = ast.node(id).identifier;
+  auto symbol = resolveIdentifier(scope, identifier);
+  if (symbol && !symbol->isDefined) {
+    const SourcePosition& position = ast.position(id);
+    errorReporter.reportError(ErrorType::USE_BEFORE_DEFINITION, static_cast<int>(position.line),
+                              static_cast<int>(position.column),
+                              std::string(what) + " '" + std::string(scope->getName(identifier)) +
+                                  "' before its definition");
+  }
+}
+
+// an assignment to a plain variable defines it (not one to an index or dereference)
+void defineAssignedVariable(const FlatAst& ast, size_t assignment, Scope* scope) {
+  uint32_t variable = ast.childOfKind(assignment, cgullParser::RuleVariable);
+  if (variable == 0) {
+    return;
+  }
+  auto symbol = resolveIdentifier(scope, ast.node(variable).identifier);
+  if (symbol) {
+    // the variable is just its identifier, so they start at the same place
+    symbol->isDefined = true;
+    symbol->definedAtLine = static_cast<int>(ast.position(variable).line);
+    symbol->definedAtColumn = static_cast<int>(ast.position(variable).column);
+  }
+}
+
+} // namespace
+
+void checkUseBeforeDefinition(const FlatAst& ast, const NodeTable<Scope*>& nodeScopes,
+                              const NodeTable<NodeRole>& nodeRoles, ErrorReporter& errorReporter) {
+  // an assignment defines its variable after everything inside it was checked, before the first node after it
+  std::vector<uint32_t> openAssignments;
+  auto closeAssignments = [&](size_t next) {
+    while (!openAssignments.empty() && ast.node(openAssignments.back()).subtreeEnd <= next) {
+      defineAssignedVariable(ast, openAssignments.back(), nodeScopes.getId(openAssignments.back()));
+      openAssignments.pop_back();
+    }
+  };
+
+  for (size_t id = 1; id < ast.size(); id++) {
+    closeAssignments(id);
+    const FlatAst::Node& node = ast.node(id);
+    Scope* scope = nodeScopes.getId(id);
+    switch (node.kind) {
+    case cgullParser::RuleVariable:
+      // declarations name their variable with a plain identifier, so only assignments have a variable as the target
+      if (nodeRoles.getId(id).kind != NodeRole::Kind::ASSIGNMENT_TARGET) {
+        reportIfUndefined(ast, id, scope, "use of", errorReporter);
+      }
+      break;
+    case cgullParser::RuleFunction_call:
+      reportIfUndefined(ast, id, scope, "call to function", errorReporter);
+      break;
+    case cgullParser::RuleCast_expression:
+      // the type is a primitive, so only the identifier is checked
+      reportIfUndefined(ast, id, scope, "use of", errorReporter);
+      break;
+    case cgullParser::RuleStruct_definition: {
+      // the struct and function scopes are their own, the names are declared in the enclosing one
+      auto symbol = scope != nullptr ? resolveIdentifier(scope->parent, node.identifier) : nullptr;
+      if (symbol) {
+        symbol->isDefined = true;
+      }
+      break;
+    }
+    case cgullParser::RuleFunction_definition: {
+      if (scope == nullptr || scope->parent == nullptr || node.identifier == NO_ATOM) {
+        break;
+      }
+      Atom name =
+          node.flags & FlatAst::Node::SPECIAL_NAME ? scope->getAtoms().special(node.identifier) : node.identifier;
+      auto symbol = resolveIdentifier(scope->parent, name);
+      if (symbol) {
+        symbol->isDefined = true;
+      }
+      break;
+    }
+    case cgullParser::RuleAssignment_statement:
+      openAssignments.push_back(static_cast<uint32_t>(id));
+      break;
+    default:
+      break;
+    }
+  }
+  closeAssignments(ast.size());
+}
@@ -0,0 +1,15 @@
+#ifndef USE_BEFORE_DEFINITION_CHECK_H
+#define USE_BEFORE_DEFINITION_CHECK_H
+
+#include "errors/error_reporter.h"
+#include "flat_ast.h"
+#include "node_roles.h"
+#include "symbols/symbol.h"
+
+// reports variables, functions and casts used before their definition, in one pass over the ids of the lowered tree
+// a struct or function counts as defined from its definition on, a variable once something is assigned to it
+// nodeScopes has the innermost scope of every node, see SymbolCollectionListener::takeNodeScopes
+void checkUseBeforeDefinition(const FlatAst& ast, const NodeTable<Scope*>& nodeScopes,
+                              const NodeTable<NodeRole>& nodeRoles, ErrorReporter& errorReporter);
+
+#endif // USE_BEFORE_DEFINITION_CHECK_H
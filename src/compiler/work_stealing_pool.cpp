@@ -0,0 +1,95 @@
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(unsigned threads) : threads(threads) {
+  if (this->threads == 0) {
+    this->threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+void WorkStealingPool::run(size_t taskCount, const std::function<void(size_t)>& task) {
+  steals = 0;
+  size_t workerCount = std::max<size_t>(1, std::min<size_t>(threads, taskCount));
+  workers.clear();
+  for (size_t i = 0; i < workerCount; i++) {
+    auto worker = std::make_unique<Worker>();
+    worker->next = taskCount * i / workerCount;
+    worker->end = taskCount * (i + 1) / workerCount;
+    workers.push_back(std::move(worker));
+  }
+
+  std::atomic<uint64_t> stolen{0};
+  std::mutex errorMutex;
+  std::exception_ptr error;
+  auto work = [&](size_t self) {
+    size_t index = 0;
+    while (true) {
+      while (takeTask(self, index)) {
+        try {
+          task(index);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(errorMutex);
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+      }
+      // tasks never add tasks, so once nothing is left to steal everything is taken
+      if (!steal(self)) {
+        return;
+      }
+      stolen++;
+    }
+  };
+
+  std::vector<std::thread> threadsRunning;
+  for (size_t i = 1; i < workerCount; i++) {
+    threadsRunning.emplace_back(work, i);
+  }
+  work(0);
+  for (auto& thread : threadsRunning) {
+    thread.join();
+  }
+  steals = stolen;
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+bool WorkStealingPool::takeTask(size_t self, size_t& task) {
+  Worker& worker = *workers[self];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.next >= worker.end) {
+    return false;
+  }
+  task = worker.next++;
+  return true;
+}
+
+bool WorkStealingPool::steal(size_t self) {
+  for (size_t offset = 1; offset < workers.size(); offset++) {
+    Worker& victim = *workers[(self + offset) % workers.size()];
+    size_t begin = 0;
+    size_t end = 0;
+    {
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      size_t remaining = victim.end - victim.next;
+      if (remaining == 0) {
+        continue;
+      }
+      // the back half, rounded up so a single task can be taken too
+      begin = victim.end - (remaining + 1) / 2;
+      end = victim.end;
+      victim.end = begin;
+    }
+    Worker& worker = *workers[self];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.next = begin;
+    worker.end = end;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,41 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// runs numbered tasks on several threads, the calling thread included
+//
+// every thread starts with an equal run of consecutive tasks and takes them from the front. a thread that runs out
+// steals the back half of another thread's remaining run, so a few large tasks don't leave the other threads idle.
+// tasks must not depend on each other, an exception thrown by one is rethrown by run after every thread stopped
+class WorkStealingPool {
+public:
+  // 0 for one thread per core
+  explicit WorkStealingPool(unsigned threads);
+
+  void run(size_t taskCount, const std::function<void(size_t)>& task);
+
+  unsigned getThreads() const { return threads; }
+  // runs taken from another thread during the last run
+  uint64_t getSteals() const { return steals; }
+
+private:
+  struct Worker {
+    std::mutex mutex;
+    size_t next = 0;
+    size_t end = 0;
+  };
+
+  unsigned threads;
+  uint64_t steals = 0;
+  std::vector<std::unique_ptr<Worker>> workers;
+
+  bool takeTask(size_t self, size_t& task);
+  bool steal(size_t self);
+};
+
+#endif // WORK_STEALING_POOL_H
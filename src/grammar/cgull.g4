@@ -1,5 +1,12 @@
 grammar cgull;
 
+// every parser context carries a dense node id, see compiler/node_context.h
+options { contextSuperClass = NodeContext; }
+
+@parser::postinclude {
+#include "compiler/node_context.h"
+}
+
 program: top_level_statement+ EOF ;
 
 /* ----- expressions ----- */
@@ -0,0 +1,12 @@
+#! /bin/bash
+# compiles every example 1000 times in one process, like a long running batch worker or compile server, and checks
+# the resident memory stays flat once warmed up: everything a compilation allocates has to be freed with it
+make
+cmake -S . -B build -DCGULL_BUILD_BENCHMARKS=ON >/dev/null && cmake --build build --target compile_leak_check || exit 1
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+if ! ./build/compile_leak_check --rounds 1000 --out-dir "$tmp" ../examples/*.cgl; then
+  echo "Memory grows from one compilation to the next"
+  exit 1
+fi
+echo "All tests completed."
@@ -0,0 +1,32 @@
+#! /bin/bash
+# checks the hand written lexer against the generated one: same tokens and errors, same class files
+make
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+for file in ../examples/* ../examples/invalid/*; do
+  if [[ -f "$file" ]]; then
+    echo "Comparing $file"
+    ./build/cgull "$file" --lexer >"$tmp/native.txt" 2>&1
+    ./build/cgull "$file" --lexer --antlr-lexer >"$tmp/antlr.txt" 2>&1
+    if ! diff "$tmp/antlr.txt" "$tmp/native.txt"; then
+      echo "Tokens differ for $file"
+      exit 1
+    fi
+    # the output directories differ, so they're replaced before comparing (piped, sed -i isn't portable)
+    ./build/cgull "$file" --out-dir "$tmp/native" 2>&1 | grep -v "^Bytecode written to" |
+      sed "s|$tmp/native|OUT|g" >"$tmp/native.txt"
+    ./build/cgull "$file" --out-dir "$tmp/antlr" --antlr-lexer 2>&1 | grep -v "^Bytecode written to" |
+      sed "s|$tmp/antlr|OUT|g" >"$tmp/antlr.txt"
+    if ! diff "$tmp/antlr.txt" "$tmp/native.txt"; then
+      echo "Compiler output differs for $file"
+      exit 1
+    fi
+    # invalid programs don't get an output directory at all
+    if [[ -d "$tmp/antlr" || -d "$tmp/native" ]] && ! diff -r "$tmp/antlr" "$tmp/native"; then
+      echo "Class files differ for $file"
+      exit 1
+    fi
+    rm -rf "$tmp/native" "$tmp/antlr"
+  fi
+done
+echo "All tests completed."
@@ -1,160 +1,122 @@
-#include "compiler/bytecode_compiler.h"
-#include "compiler/errors/error_reporter.h"
-#include "compiler/listeners/collecting_error_listener.h"
-#include "compiler/semantic_analyzer.h"
-#include <antlr4-runtime.h>
-#include <cgullBaseListener.h>
-#include <cgullBaseVisitor.h>
-#include <cgullLexer.h>
-#include <cgullListener.h>
-#include <cgullParser.h>
-#include <cgullVisitor.h>
-#include <fstream>
+#include "compiler/batch_compiler.h"
+#include "compiler/compile_driver.h"
+#include "compiler/compile_server.h"
+#include "compiler/input/mapped_file.h"
 #include <iostream>
-#include <sstream>
+#include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
-enum StopStage {
-  NONE,
-  LEXING,
-  PARSING,
-  SEMANTIC_ANALYSIS,
-};
-
-void printTokens(const cgullLexer& lexer, antlr4::CommonTokenStream& tokens) {
-  for (size_t i = 0; i < tokens.size(); ++i) {
-    auto token = tokens.get(i);
-    std::string tokenName = std::string(lexer.getVocabulary().getSymbolicName(token->getType()));
-    std::cout << "Token: " << tokenName << ", Text: '" << token->getText() << "'"
-              << ", Start: " << token->getStartIndex() << ", End: " << token->getStopIndex()
-              << ", Line: " << token->getLine() << std::endl;
-  }
-}
-
-void printErrors(const std::string& label, const CollectingErrorListener& listener) {
-  if (!listener.errors.empty()) {
-    std::cerr << "\n" << label << " errors:\n";
-    for (const auto& err : listener.errors) {
-      std::cerr << err << std::endl;
-    }
-    std::cerr << label << " failed with " << listener.errors.size() << " errors." << std::endl;
-  }
-}
-
-bool hasAnyErrors(const CollectingErrorListener& lexerListener, const CollectingErrorListener& parserListener) {
-  return !lexerListener.errors.empty() || !parserListener.errors.empty();
+void printUsage(const char* program) {
+  std::cerr << "Usage: " << program << " <input-file> [--lexer | --parser | --semantic] [--jasm]" << std::endl;
+  std::cerr << "       " << program
+            << " --batch [--jobs N] [--out-dir DIR] [--lexer | --parser | --semantic] [--jasm] <input-file | @manifest>..."
+            << std::endl;
+  std::cerr << "       " << program << " --serve <socket-path> [--out-dir DIR] [--lexer | --parser | --semantic] [--jasm]"
+            << std::endl;
+  std::cerr << "       " << program << " --cache-stats --cache-dir DIR" << std::endl;
+  std::cerr << "Any mode can add --cache-dir DIR [--cache-size MB] to reuse the class files of unchanged programs"
+            << std::endl;
+  std::cerr << "and --time-passes[=json] to report the time and memory used by each compiler phase" << std::endl;
+  std::cerr << "--antlr-lexer lexes with the generated antlr lexer instead of the hand written one" << std::endl;
+  std::cerr << "--parse-jobs N parses large programs in chunks on N threads (0 for one per core, 1 for serial)"
+            << std::endl;
+  std::cerr << "--check-jobs N type checks the functions of large programs on N threads (0 for one per core, 1 for "
+               "serial)"
+            << std::endl;
+  std::cerr << "--semantic=compact prints the symbol table JSON on one line" << std::endl;
+  std::cerr << "--pipeline writes each class and frees its IR as soon as it is generated" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
-  StopStage stopStage = NONE;
-  // TODO: better argument parsing
-  if (argc < 2) {
-    std::cerr << "Usage: " << argv[0] << " <input-file> [--lexer | --parser | --semantic]" << std::endl;
-    return 1;
-  }
-  if (argc == 3) {
-    stopStage = ((std::string)argv[2] == "--lexer")      ? LEXING
-                : ((std::string)argv[2] == "--parser")   ? PARSING
-                : ((std::string)argv[2] == "--semantic") ? SEMANTIC_ANALYSIS
-                                                         : NONE;
-  }
-
-  std::ifstream inputFile(argv[1]);
-  if (!inputFile.is_open()) {
-    std::cerr << "Failed to open input file: " << argv[1] << std::endl;
-    return 1;
-  }
-
-  std::stringstream inputBuffer;
-  inputBuffer << inputFile.rdbuf();
-  inputFile.close();
-
-  antlr4::ANTLRInputStream input(inputBuffer.str());
-  cgullLexer lexer(&input);
+  CompileOptions options;
+  bool batch = false;
+  unsigned jobs = 0;
+  std::string socketPath;
+  std::string cacheDir;
+  uintmax_t cacheMegabytes = 256;
+  bool cacheStats = false;
+  std::vector<std::string> inputs;
+  std::vector<std::string> args(argv + 1, argv + argc);
 
-  CollectingErrorListener lexerErrorListener;
-  lexer.removeErrorListeners();
-  lexer.addErrorListener(&lexerErrorListener);
-
-  antlr4::CommonTokenStream tokens(&lexer);
-  tokens.fill();
-
-  if (stopStage == LEXING) {
-    printTokens(lexer, tokens);
-    printErrors("Lexer", lexerErrorListener);
-    if (!lexerErrorListener.errors.empty()) {
+  // TODO: better argument parsing
+  for (size_t i = 0; i < args.size(); i++) {
+    const std::string& arg = args[i];
+    std::string flagError;
+    uint64_t count = 0;
+    if (applyCompileFlag(args, i, options, flagError)) {
+      continue;
+    } else if (!flagError.empty()) {
+      std::cerr << flagError << std::endl;
+      printUsage(argv[0]);
       return 1;
+    } else if (arg == "--batch") {
+      batch = true;
+    } else if (arg == "--jobs" && i + 1 < args.size()) {
+      if (!parseCountFlag(args[++i], count) || count > std::numeric_limits<unsigned>::max()) {
+        std::cerr << "Invalid value for --jobs: " << args[i] << std::endl;
+        printUsage(argv[0]);
+        return 1;
+      }
+      jobs = static_cast<unsigned>(count);
+    } else if (arg == "--serve" && i + 1 < args.size()) {
+      socketPath = args[++i];
+    } else if (arg == "--cache-dir" && i + 1 < args.size()) {
+      cacheDir = args[++i];
+    } else if (arg == "--cache-size" && i + 1 < args.size()) {
+      if (!parseCountFlag(args[++i], count)) {
+        std::cerr << "Invalid value for --cache-size: " << args[i] << std::endl;
+        printUsage(argv[0]);
+        return 1;
+      }
+      cacheMegabytes = count;
+    } else if (arg == "--cache-stats") {
+      cacheStats = true;
+    } else if (arg.rfind("--", 0) != 0) {
+      inputs.push_back(arg);
     }
-    std::cout << "Lexing completed successfully!" << std::endl;
-    return 0;
   }
 
-  cgullParser parser(&tokens);
-
-  CollectingErrorListener parserErrorListener;
-  parser.removeErrorListeners();
-  parser.addErrorListener(&parserErrorListener);
-
-  cgullParser::ProgramContext* tree = parser.program();
+  std::unique_ptr<CompileCache> cache;
+  if (!cacheDir.empty()) {
+    cache = std::make_unique<CompileCache>(cacheDir, cacheMegabytes * 1024 * 1024);
+    options.cache = cache.get();
+  }
 
-  if (stopStage == PARSING) {
-    std::cout << "Parse tree: \n" << tree->toStringTree(&parser, true) << std::endl;
-    printErrors("Lexer", lexerErrorListener);
-    printErrors("Parser", parserErrorListener);
-    if (hasAnyErrors(lexerErrorListener, parserErrorListener)) {
-      std::cerr << "Lexing and/or parsing failed with errors." << std::endl;
+  if (cacheStats) {
+    if (!cache) {
+      printUsage(argv[0]);
       return 1;
     }
-    std::cout << "Parsing completed successfully!" << std::endl;
+    CompileCache::Stats stats = cache->getTotalStats();
+    std::cout << "Compile cache " << cacheDir << ": " << cache->getEntryCount() << " entries, "
+              << cache->getSizeBytes() / 1024 << " KiB of " << cacheMegabytes << " MiB" << std::endl;
+    std::cout << "Hits: " << stats.hits << ", misses: " << stats.misses << ", stores: " << stats.stores
+              << ", evictions: " << stats.evictions << std::endl;
     return 0;
   }
 
-  printErrors("Lexer", lexerErrorListener);
-  printErrors("Parser", parserErrorListener);
-
-  if (hasAnyErrors(lexerErrorListener, parserErrorListener)) {
-    std::cerr << "Lexing and/or parsing failed with errors. Semantic analysis will not be performed." << std::endl;
-    return 1;
+  if (!socketPath.empty()) {
+    CompileServer server(socketPath, options);
+    return server.run(std::cout);
   }
 
-  SemanticAnalyzer semanticAnalyzer;
-  semanticAnalyzer.analyze(tree);
-
-  if (stopStage == SEMANTIC_ANALYSIS) {
-    semanticAnalyzer.printSymbolsAsJson(std::cout);
-    if (semanticAnalyzer.getErrorReporter().hasErrors()) {
-      std::cerr << "Semantic analysis failed with errors." << std::endl;
-      semanticAnalyzer.getErrorReporter().displayErrors();
-      return 1;
-    }
-    std::cout << "Semantic analysis completed successfully!" << std::endl;
-    return 0;
+  if (batch) {
+    BatchCompiler batchCompiler(options, jobs);
+    return batchCompiler.run(inputs, std::cout, std::cerr);
   }
 
-  semanticAnalyzer.getErrorReporter().displayErrors();
-
-  // dont continue if there are any errors
-  if (semanticAnalyzer.getErrorReporter().hasErrors()) {
-    std::cerr << "Semantic analysis failed with errors. Bytecode generation will not be performed." << std::endl;
+  if (inputs.size() != 1) {
+    printUsage(argv[0]);
     return 1;
   }
 
-  BytecodeCompiler compiler(tree, semanticAnalyzer.getScopes(), semanticAnalyzer.getExpressionTypes(),
-                            semanticAnalyzer.getExpectingStringConversion(), semanticAnalyzer.getConstructorMap(),
-                            semanticAnalyzer.getResolvedMethodSymbols());
-  compiler.compile();
-
-  if (compiler.getErrorReporter().hasErrors()) {
-    std::cerr << "Bytecode generation failed with errors." << std::endl;
-    compiler.getErrorReporter().displayErrors();
+  MappedFile source;
+  if (!source.open(inputs[0])) {
+    std::cerr << "Failed to open input file: " << inputs[0] << std::endl;
     return 1;
   }
-  std::cout << "Bytecode generation completed successfully!" << std::endl;
-
-  compiler.generateBytecode("out");
-  std::cout << "Bytecode written to out directory" << std::endl;
-  std::cout << "Compilation completed successfully!" << std::endl;
 
-  return 0;
+  return compileSource(source.contents(), options, std::cout, std::cerr).exitCode;
 }
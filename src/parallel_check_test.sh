@@ -0,0 +1,29 @@
+#! /bin/bash
+# type checks large programs made of the examples repeated many times, with the functions on several threads and
+# serially, and checks the errors and symbol tables are the same
+make
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+for i in $(seq 20); do
+  cat ../examples/*.cgl >>"$tmp/valid.cgl"
+done
+for file in ../examples/invalid/*.cgl; do
+  # only the files that parse, semantic analysis doesn't run otherwise
+  if ./build/cgull "$file" --parser >/dev/null 2>&1; then
+    for i in $(seq 20); do
+      cat "$file" >>"$tmp/invalid.cgl"
+    done
+  fi
+done
+for file in "$tmp/valid.cgl" "$tmp/invalid.cgl"; do
+  echo "Comparing $(basename "$file")"
+  # scope ids are addresses, which differ from run to run
+  ./build/cgull "$file" --semantic --check-jobs 1 2>&1 | sed -E 's/0x[0-9a-f]+/ID/g' >"$tmp/serial.txt"
+  ./build/cgull "$file" --semantic --check-jobs 4 2>&1 | sed -E 's/0x[0-9a-f]+/ID/g' >"$tmp/parallel.txt"
+  if ! cmp -s "$tmp/serial.txt" "$tmp/parallel.txt"; then
+    echo "Parallel type checking differs for $(basename "$file")"
+    diff "$tmp/serial.txt" "$tmp/parallel.txt" | head -20
+    exit 1
+  fi
+done
+echo "All tests completed."
@@ -0,0 +1,21 @@
+#! /bin/bash
+# parses large programs made of the examples repeated many times, in chunks on several threads and serially,
+# and checks the parse trees and errors are the same
+make
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+for i in $(seq 20); do
+  cat ../examples/*.cgl >>"$tmp/valid.cgl"
+  cat ../examples/invalid/*.cgl >>"$tmp/invalid.cgl"
+done
+for file in "$tmp/valid.cgl" "$tmp/invalid.cgl"; do
+  echo "Comparing $(basename "$file")"
+  ./build/cgull "$file" --parser --parse-jobs 1 >"$tmp/serial.txt" 2>&1
+  ./build/cgull "$file" --parser --parse-jobs 4 >"$tmp/parallel.txt" 2>&1
+  if ! cmp -s "$tmp/serial.txt" "$tmp/parallel.txt"; then
+    echo "Parallel parse differs for $(basename "$file")"
+    diff "$tmp/serial.txt" "$tmp/parallel.txt" | head -20
+    exit 1
+  fi
+done
+echo "All tests completed."
@@ -0,0 +1,54 @@
+#! /bin/bash
+# compiles every example with and without --pipeline and checks both write the same class files
+# both start from the output of an earlier compile, which a failed compile has to leave alone
+make
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+if ! ./build/cgull ../examples/ex3_functions.cgl --out-dir "$tmp/previous" >/dev/null 2>&1; then
+  echo "Failed to compile the previous output"
+  exit 1
+fi
+for file in ../examples/* ../examples/invalid/*; do
+  if [[ -f "$file" ]]; then
+    echo "Comparing $file"
+    cp -r "$tmp/previous" "$tmp/whole"
+    cp -r "$tmp/previous" "$tmp/pipeline"
+    ./build/cgull "$file" --out-dir "$tmp/whole" >/dev/null 2>&1
+    wholeStatus=$?
+    ./build/cgull "$file" --out-dir "$tmp/pipeline" --pipeline >/dev/null 2>&1
+    pipelineStatus=$?
+    if [[ $wholeStatus -ne $pipelineStatus ]]; then
+      echo "Exit status differs for $file: $wholeStatus without --pipeline, $pipelineStatus with it"
+      exit 1
+    fi
+    if ! diff -r "$tmp/whole" "$tmp/pipeline"; then
+      echo "Class files differ for $file"
+      exit 1
+    fi
+    if [[ $pipelineStatus -ne 0 ]] && ! diff -r "$tmp/previous" "$tmp/pipeline"; then
+      echo "--pipeline changed the previous output for $file"
+      exit 1
+    fi
+    rm -rf "$tmp/whole" "$tmp/pipeline"
+  fi
+done
+# a program big enough to be parsed in chunks, whose subtrees --pipeline frees as it goes
+echo "Comparing a chunk parsed program"
+for i in $(seq 1500); do
+  echo "struct Pair$i { int x; int y; }"
+  echo "fn sum$i(int a, int b) -> int { Pair$i p = Pair$i(a, b); return p.x + p.y + $i; }"
+done >"$tmp/large.cgl"
+echo 'fn main() { println("" + sum1500(1, 2)); }' >>"$tmp/large.cgl"
+./build/cgull "$tmp/large.cgl" --out-dir "$tmp/whole" --parse-jobs 4 >/dev/null 2>&1
+wholeStatus=$?
+./build/cgull "$tmp/large.cgl" --out-dir "$tmp/pipeline" --parse-jobs 4 --pipeline >/dev/null 2>&1
+pipelineStatus=$?
+if [[ $wholeStatus -ne 0 || $pipelineStatus -ne 0 ]]; then
+  echo "Failed to compile the chunk parsed program: $wholeStatus without --pipeline, $pipelineStatus with it"
+  exit 1
+fi
+if ! diff -r "$tmp/whole" "$tmp/pipeline"; then
+  echo "Class files differ for the chunk parsed program"
+  exit 1
+fi
+echo "All tests completed."
@@ -1,11 +1,26 @@
 #! /bin/sh
 make
 ./build/cgull "$@"
-# only run assembler if there's no arguments besides the file name and no error
 RESULT=$?
-if [ $# -eq 1 ] && [ $RESULT -eq 0 ]; then
-  # for each .jasm file in out, run jasm on it
+# only run the program for a single compile with no stage requested, the classes went to out and there's no error
+RUN_PROGRAM=1
+PREVIOUS=
+for arg in "$@"; do
+  case "$arg" in
+  --lexer | --parser | --semantic* | --batch | --serve) RUN_PROGRAM=0 ;;
+  esac
+  if [ "$PREVIOUS" = "--out-dir" ]; then
+    case "$arg" in
+    out | out/ | ./out | ./out/) ;;
+    *) RUN_PROGRAM=0 ;;
+    esac
+  fi
+  PREVIOUS=$arg
+done
+if [ $RUN_PROGRAM -eq 1 ] && [ $RESULT -eq 0 ]; then
+  # .class files are written directly, .jasm files only show up with --jasm and still need assembling
   for file in out/*.jasm; do
+    [ -e "$file" ] || continue
     ./thirdparty/jasm/bin/jasm -i out -o out $(basename $file)
     if [ $? -ne 0 ]; then
       echo "\nError: jasm failed on $file"